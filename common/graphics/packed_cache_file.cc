@@ -0,0 +1,350 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/common/graphics/packed_cache_file.h"
+
+#include <cstring>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint32_t kFileSignature = 0x4B435046;  // "FPCK"
+constexpr uint32_t kFileVersion1 = 1;
+constexpr uint32_t kRecordSignature = 0x44524352;  // "RCRD"
+
+// Compact the file once at least this many bytes, and at least half of the
+// file, are unused.
+constexpr size_t kMinCompactionSize = 256 * 1024;
+
+struct FileHeader {
+  uint32_t signature;
+  uint32_t version;
+};
+
+struct RecordHeader {
+  uint32_t signature;
+  uint32_t key_size;
+  uint32_t value_size;
+};
+
+std::string ToKeyString(const SkData& key) {
+  return std::string(static_cast<const char*>(key.data()), key.size());
+}
+
+}  // namespace
+
+PackedCacheFile::PackedCacheFile(std::shared_ptr<fml::UniqueFD> directory,
+                                 std::string file_name,
+                                 bool read_only)
+    : directory_(std::move(directory)),
+      file_name_(std::move(file_name)),
+      read_only_(read_only) {
+  std::scoped_lock lock(mutex_);
+  Open();
+}
+
+PackedCacheFile::~PackedCacheFile() = default;
+
+size_t PackedCacheFile::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return keys_.size();
+}
+
+size_t PackedCacheFile::GetFileSize() const {
+  std::scoped_lock lock(mutex_);
+  return valid_size_;
+}
+
+sk_sp<SkData> PackedCacheFile::Load(const SkData& key) const {
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(ToKeyString(key));
+  if (found == index_.end()) {
+    return nullptr;
+  }
+  const Location& location = found->second;
+  return SkData::MakeWithCopy(mapping_->GetMapping() + location.value_offset,
+                              location.value_size);
+}
+
+std::vector<PackedCacheFile::Entry> PackedCacheFile::LoadAll() const {
+  TRACE_EVENT0("flutter", "PackedCacheFile::LoadAll");
+  std::scoped_lock lock(mutex_);
+  std::vector<Entry> entries;
+  entries.reserve(keys_.size());
+  for (const auto& key : keys_) {
+    const auto& location = index_.at(key);
+    entries.push_back({
+        .key = SkData::MakeWithCopy(key.data(), key.size()),
+        .value = SkData::MakeWithCopy(
+            mapping_->GetMapping() + location.value_offset,
+            location.value_size),
+    });
+  }
+  return entries;
+}
+
+bool PackedCacheFile::Store(const std::vector<Entry>& entries) {
+  std::scoped_lock write_lock(write_mutex_);
+  if (read_only_ || !directory_->is_valid()) {
+    return false;
+  }
+
+  // Skia may store the same value again, which would only waste space.
+  std::vector<Entry> changed_entries;
+  for (const auto& entry : entries) {
+    auto found = index_.find(ToKeyString(*entry.key));
+    if (found != index_.end() &&
+        found->second.value_size == entry.value->size() &&
+        memcmp(mapping_->GetMapping() + found->second.value_offset,
+               entry.value->data(), entry.value->size()) == 0) {
+      continue;
+    }
+    changed_entries.push_back(entry);
+  }
+  if (changed_entries.empty()) {
+    return true;
+  }
+
+  if (!Append(changed_entries)) {
+    FML_LOG(WARNING) << "Could not append to the cache file " << file_name_;
+    return false;
+  }
+
+  if (unused_size_ >= kMinCompactionSize && unused_size_ * 2 >= valid_size_) {
+    CompactLocked();
+  }
+  return true;
+}
+
+bool PackedCacheFile::Compact() {
+  std::scoped_lock write_lock(write_mutex_);
+  return CompactLocked();
+}
+
+void PackedCacheFile::Remove() {
+  std::scoped_lock lock(write_mutex_, mutex_);
+  mapping_ = nullptr;
+  valid_size_ = 0;
+  unused_size_ = 0;
+  index_.clear();
+  keys_.clear();
+  if (!read_only_ && directory_->is_valid() &&
+      fml::FileExists(*directory_, file_name_.c_str())) {
+    fml::UnlinkFile(*directory_, file_name_.c_str());
+  }
+}
+
+void PackedCacheFile::Open() {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Open");
+  mapping_ = nullptr;
+  valid_size_ = 0;
+  unused_size_ = 0;
+  index_.clear();
+  keys_.clear();
+
+  if (!directory_->is_valid()) {
+    return;
+  }
+  auto mapping = fml::FileMapping::CreateReadOnly(*directory_, file_name_);
+  if (!mapping || mapping->GetSize() < sizeof(FileHeader)) {
+    return;
+  }
+  const uint8_t* bytes = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+
+  FileHeader header;
+  memcpy(&header, bytes, sizeof(FileHeader));
+  if (header.signature != kFileSignature || header.version != kFileVersion1) {
+    FML_LOG(INFO) << "Cache file has an unknown format: " << file_name_;
+    return;
+  }
+
+  size_t offset = sizeof(FileHeader);
+  while (size - offset >= sizeof(RecordHeader)) {
+    RecordHeader record;
+    memcpy(&record, bytes + offset, sizeof(RecordHeader));
+    const uint64_t record_size = sizeof(RecordHeader) +
+                                 static_cast<uint64_t>(record.key_size) +
+                                 record.value_size;
+    // The rest of the file was not written completely.
+    if (record.signature != kRecordSignature || record_size > size - offset) {
+      break;
+    }
+    const size_t key_offset = offset + sizeof(RecordHeader);
+    AddToIndex(std::string(reinterpret_cast<const char*>(bytes + key_offset),
+                           record.key_size),
+               {
+                   .record_offset = offset,
+                   .record_size = static_cast<size_t>(record_size),
+                   .value_offset = key_offset + record.key_size,
+                   .value_size = record.value_size,
+               });
+    offset += record_size;
+  }
+
+  valid_size_ = offset;
+  mapping_ = std::move(mapping);
+}
+
+void PackedCacheFile::AddToIndex(std::string key, Location location) {
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    // The key keeps its place in |keys_|.
+    unused_size_ += found->second.record_size;
+    found->second = location;
+    return;
+  }
+  index_.emplace(key, location);
+  keys_.push_back(std::move(key));
+}
+
+bool PackedCacheFile::Append(const std::vector<Entry>& entries) {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Append");
+  const size_t start = valid_size_ == 0 ? sizeof(FileHeader) : valid_size_;
+  size_t end = start;
+  for (const auto& entry : entries) {
+    end += sizeof(RecordHeader) + entry.key->size() + entry.value->size();
+  }
+
+  // Loads keep reading the records that are already in the file from the old
+  // mapping while the file is resized and written. Windows cannot resize a
+  // file while it is mapped though, so there they wait for the new mapping.
+  std::unique_lock lock(mutex_, std::defer_lock);
+#if OS_WIN
+  lock.lock();
+  mapping_ = nullptr;
+#endif  // OS_WIN
+
+  auto file = fml::OpenFile(*directory_, file_name_.c_str(), true,
+                            fml::FilePermission::kReadWrite);
+  // Any bytes past the valid records are overwritten.
+  std::unique_ptr<fml::FileMapping> mapping;
+  if (file.is_valid() && fml::TruncateFile(file, end)) {
+    mapping = std::make_unique<fml::FileMapping>(
+        file, std::initializer_list<fml::FileMapping::Protection>{
+                  fml::FileMapping::Protection::kRead,
+                  fml::FileMapping::Protection::kWrite});
+  }
+  if (!mapping || !mapping->IsValid() || mapping->GetSize() != end) {
+    // Reopen the file as it is.
+    if (!lock.owns_lock()) {
+      lock.lock();
+    }
+    Open();
+    return false;
+  }
+  uint8_t* bytes = mapping->GetMutableMapping();
+
+  if (valid_size_ == 0) {
+    const FileHeader header = {
+        .signature = kFileSignature,
+        .version = kFileVersion1,
+    };
+    memcpy(bytes, &header, sizeof(FileHeader));
+  }
+
+  std::vector<Location> locations;
+  locations.reserve(entries.size());
+  size_t offset = start;
+  for (const auto& entry : entries) {
+    const RecordHeader record = {
+        .signature = kRecordSignature,
+        .key_size = static_cast<uint32_t>(entry.key->size()),
+        .value_size = static_cast<uint32_t>(entry.value->size()),
+    };
+    const size_t key_offset = offset + sizeof(RecordHeader);
+    const size_t value_offset = key_offset + record.key_size;
+    memcpy(bytes + key_offset, entry.key->data(), record.key_size);
+    memcpy(bytes + value_offset, entry.value->data(), record.value_size);
+    // Written last, so that a record that was cut short by the process dying
+    // is not read back.
+    memcpy(bytes + offset, &record, sizeof(RecordHeader));
+
+    const size_t record_size =
+        sizeof(RecordHeader) + record.key_size + record.value_size;
+    locations.push_back({
+        .record_offset = offset,
+        .record_size = record_size,
+        .value_offset = value_offset,
+        .value_size = record.value_size,
+    });
+    offset += record_size;
+  }
+
+  if (!lock.owns_lock()) {
+    lock.lock();
+  }
+  for (size_t i = 0; i < entries.size(); i++) {
+    AddToIndex(ToKeyString(*entries[i].key), locations[i]);
+  }
+  valid_size_ = end;
+  mapping_ = std::move(mapping);
+  return true;
+}
+
+bool PackedCacheFile::CompactLocked() {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Compact");
+  if (read_only_ || !mapping_) {
+    return false;
+  }
+
+  std::vector<uint8_t> bytes(sizeof(FileHeader));
+  bytes.reserve(valid_size_ - unused_size_);
+  const FileHeader header = {
+      .signature = kFileSignature,
+      .version = kFileVersion1,
+  };
+  memcpy(bytes.data(), &header, sizeof(FileHeader));
+  std::vector<Location> locations;
+  locations.reserve(keys_.size());
+  for (const auto& key : keys_) {
+    const auto& location = index_.at(key);
+    const uint8_t* record = mapping_->GetMapping() + location.record_offset;
+    locations.push_back({
+        .record_offset = bytes.size(),
+        .record_size = location.record_size,
+        .value_offset = bytes.size() + location.value_offset -
+                        location.record_offset,
+        .value_size = location.value_size,
+    });
+    bytes.insert(bytes.end(), record, record + location.record_size);
+  }
+
+  // Loads read the compacted bytes while the file is rewritten, because
+  // Windows cannot replace a file while it is mapped.
+  {
+    std::scoped_lock lock(mutex_);
+    for (size_t i = 0; i < keys_.size(); i++) {
+      index_[keys_[i]] = locations[i];
+    }
+    valid_size_ = bytes.size();
+    unused_size_ = 0;
+    mapping_ = std::make_unique<fml::DataMapping>(std::move(bytes));
+  }
+
+  if (!fml::WriteAtomically(*directory_, file_name_.c_str(), *mapping_)) {
+    FML_LOG(WARNING) << "Could not compact the cache file " << file_name_;
+    // The entries no longer match the file, which was left as it was.
+    std::scoped_lock lock(mutex_);
+    Open();
+    return false;
+  }
+
+  // The file has the same bytes, so only the mapping changes. Until then, the
+  // compacted bytes stay in memory.
+  auto mapping = fml::FileMapping::CreateReadOnly(*directory_, file_name_);
+  if (mapping && mapping->GetSize() == valid_size_) {
+    std::scoped_lock lock(mutex_);
+    mapping_ = std::move(mapping);
+  }
+  return true;
+}
+
+}  // namespace flutter
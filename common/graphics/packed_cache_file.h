@@ -0,0 +1,131 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_FILE_H_
+#define FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_FILE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      A key value store in a single memory mapped file.
+///
+///             The file starts with a small header, followed by one record per
+///             stored value. Each record starts with the sizes of its key and
+///             its value. Opening the file walks the records in the mapping to
+///             build an index of the keys, instead of opening a file per key.
+///
+///             New values are appended to the file. Storing a key again leaves
+///             the old record in place, but unused. Once enough of the file is
+///             unused, the file is compacted by rewriting it with only the
+///             latest record of each key.
+///
+///             The entries keep the order in which their keys were first
+///             stored, including across compactions.
+///
+///             All methods are thread-safe.
+///
+class PackedCacheFile {
+ public:
+  struct Entry {
+    sk_sp<SkData> key;
+    sk_sp<SkData> value;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Opens the file named `file_name` in `directory`. The file is
+  ///             created when the first entry is stored.
+  ///
+  /// @param[in]  directory  The directory containing the file.
+  /// @param[in]  file_name  The name of the file.
+  /// @param[in]  read_only  Whether entries may be stored in the file.
+  ///
+  PackedCacheFile(std::shared_ptr<fml::UniqueFD> directory,
+                  std::string file_name,
+                  bool read_only);
+
+  ~PackedCacheFile();
+
+  size_t GetEntryCount() const;
+
+  /// The number of bytes in the file, including unused records.
+  size_t GetFileSize() const;
+
+  /// The value of `key`, or null if `key` has not been stored.
+  sk_sp<SkData> Load(const SkData& key) const;
+
+  /// All of the entries, in the order in which their keys were first stored.
+  std::vector<Entry> LoadAll() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Appends `entries` to the file, replacing the values of keys
+  ///             that were stored before. Compacts the file if enough of it
+  ///             is unused afterwards.
+  ///
+  /// @return     Whether the entries were written to the file.
+  ///
+  bool Store(const std::vector<Entry>& entries);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Rewrites the file with only the latest record of each key.
+  ///
+  /// @return     Whether the file was rewritten.
+  ///
+  bool Compact();
+
+  /// Forgets all of the entries and deletes the file.
+  void Remove();
+
+ private:
+  struct Location {
+    size_t record_offset;
+    size_t record_size;
+    size_t value_offset;
+    size_t value_size;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const std::string file_name_;
+  const bool read_only_;
+
+  // Serializes the methods that change the file. They only hold |mutex_|
+  // while they change the members below, which loads read under |mutex_|.
+  // Holding |write_mutex_| is enough to read the members.
+  std::mutex write_mutex_;
+  mutable std::mutex mutex_;
+  // The file, or a copy of it in memory while it is being rewritten.
+  std::unique_ptr<fml::Mapping> mapping_;
+  // The size of the header and of all complete records. Anything past it is
+  // overwritten by the next append.
+  size_t valid_size_ = 0;
+  // The bytes of records that have been replaced by later ones.
+  size_t unused_size_ = 0;
+  std::unordered_map<std::string, Location> index_;
+  std::vector<std::string> keys_;
+
+  void Open();
+
+  void AddToIndex(std::string key, Location location);
+
+  // Both require |write_mutex_|.
+  bool Append(const std::vector<Entry>& entries);
+
+  bool CompactLocked();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedCacheFile);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_FILE_H_
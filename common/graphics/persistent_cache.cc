@@ -49,6 +49,7 @@ bool PersistentCache::gIsReadOnly = false;
 
 std::atomic<bool> PersistentCache::cache_sksl_ = false;
 std::atomic<bool> PersistentCache::strategy_set_ = false;
+std::atomic<bool> PersistentCache::precompile_in_background_ = false;
 
 void PersistentCache::SetCacheSkSL(bool value) {
   if (strategy_set_ && value != cache_sksl_) {
@@ -85,7 +86,11 @@ bool PersistentCache::Purge() {
 
   std::promise<bool> removed;
   GetWorkerTaskRunner()->PostTask([&removed,
-                                   cache_directory = cache_directory_]() {
+                                   cache_directory = cache_directory_,
+                                   cache_file = cache_file_,
+                                   sksl_cache_file = sksl_cache_file_]() {
+    cache_file->Remove();
+    sksl_cache_file->Remove();
     if (cache_directory->is_valid()) {
       // Only remove files but not directories.
       FML_LOG(INFO) << "Purge persistent cache.";
@@ -214,30 +219,118 @@ size_t PersistentCache::PrecompileKnownSkSLs(GrDirectContext* context) const {
   return precompiled_count;
 }
 
-std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() const {
-  TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
-  std::vector<PersistentCache::SkSLCache> result;
-  fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
-                                       const std::string& filename) {
-    SkSLCache cache = LoadFile(directory, filename, true);
-    if (cache.key != nullptr && cache.value != nullptr) {
-      result.push_back(cache);
-    } else {
-      FML_LOG(ERROR) << "Failed to load: " << filename;
+namespace {
+
+struct BackgroundPrecompile {
+  fml::RefPtr<fml::TaskRunner> task_runner;
+  PersistentCache::ContextScope scope;
+  std::vector<PersistentCache::SkSLCache> sksls;
+  size_t next = 0;
+  size_t precompiled_count = 0;
+};
+
+void PrecompileNextSkSL(std::shared_ptr<BackgroundPrecompile> precompile) {
+  bool done = precompile->next == precompile->sksls.size();
+  if (!done) {
+    const auto& sksl = precompile->sksls[precompile->next++];
+    const bool compiled = precompile->scope(
+        [&precompile, &sksl, &done](GrDirectContext* context) {
+          if (context->abandoned()) {
+            done = true;
+            return;
+          }
+          TRACE_EVENT0("flutter", "PrecompilingSkSL");
+          if (context->precompileShader(*sksl.key, *sksl.value)) {
+            precompile->precompiled_count++;
+          }
+        });
+    if (!compiled) {
+      return;
     }
-    return true;
+  }
+  if (done) {
+    FML_TRACE_COUNTER("flutter", "PersistentCache::PrecompiledSkSLs",
+                      reinterpret_cast<int64_t>(precompile.get()),
+                      "Successful", precompile->precompiled_count);
+    return;
+  }
+  // Post each shader separately so that frames do not wait for all of them.
+  auto task_runner = precompile->task_runner;
+  task_runner->PostTask([precompile = std::move(precompile)]() mutable {
+    PrecompileNextSkSL(std::move(precompile));
+  });
+}
+
+}  // namespace
+
+void PersistentCache::PrecompileKnownSkSLsInBackground(
+    const GrDirectContext* context,
+    fml::RefPtr<fml::TaskRunner> task_runner,
+    ContextScope scope) {
+  if (!context || !task_runner || !scope) {
+    return;
+  }
+  auto precompile = std::make_shared<BackgroundPrecompile>();
+  {
+    std::scoped_lock lock(background_precompile_mutex_);
+    if (background_precompile_context_ == context &&
+        !background_precompile_.expired()) {
+      return;
+    }
+    background_precompile_context_ = context;
+    background_precompile_ = precompile;
+  }
+
+  precompile->task_runner = std::move(task_runner);
+  precompile->scope = std::move(scope);
+
+  // Reading and decoding the SkSLs does not need the context. No frame waits
+  // on them, so they are read at background priority rather than on the
+  // Skia executor, whose tasks frames are waiting on.
+  auto load = [precompile]() mutable {
+    precompile->sksls = GetCacheForProcess()->LoadSkSLs();
+    // A trace must be present even if no precompilations have been completed.
+    FML_TRACE_EVENT("flutter",
+                    "PersistentCache::PrecompileKnownSkSLsInBackground",
+                    "count", precompile->sksls.size());
+    auto task_runner = precompile->task_runner;
+    task_runner->PostTask([precompile = std::move(precompile)]() mutable {
+      PrecompileNextSkSL(std::move(precompile));
+    });
   };
+  std::shared_ptr<fml::ConcurrentTaskRunner> background_task_runner;
+  {
+    std::scoped_lock lock(worker_task_runners_mutex_);
+    background_task_runner = background_task_runner_;
+  }
+  if (background_task_runner) {
+    background_task_runner->PostTask(std::move(load),
+                                     fml::ConcurrentTaskPriority::kBackground);
+  } else {
+    precompile->task_runner->PostTask(std::move(load));
+  }
+}
 
+std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() const {
+  TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
+  std::vector<PersistentCache::SkSLCache> result;
   // Only visit sksl_cache_directory_ if this persistent cache is valid.
   // However, we'd like to continue visit the asset dir even if this persistent
   // cache is invalid.
   if (IsValid()) {
+    for (auto& entry : sksl_cache_file_->LoadAll()) {
+      result.push_back({std::move(entry.key), std::move(entry.value)});
+    }
+    // Writable caches move files with an entry each into the cache file once
+    // they have a worker, but read-only caches leave them in place.
     // In case `rewinddir` doesn't work reliably, load SkSLs from a freshly
     // opened directory (https://github.com/flutter/flutter/issues/65258).
     fml::UniqueFD fresh_dir =
         fml::OpenDirectoryReadOnly(*cache_directory_, kSkSLSubdirName);
     if (fresh_dir.is_valid()) {
-      fml::VisitFiles(fresh_dir, visitor);
+      for (auto& file : LoadCacheObjectFiles(fresh_dir, true)) {
+        result.push_back(std::move(file.second));
+      }
     }
   }
 
@@ -275,7 +368,13 @@ PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
       cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, true)),
+      cache_file_(std::make_shared<PackedCacheFile>(cache_directory_,
+                                                    kPackedCacheFileName,
+                                                    read_only)),
+      sksl_cache_file_(std::make_shared<PackedCacheFile>(sksl_cache_directory_,
+                                                         kPackedCacheFileName,
+                                                         read_only)) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -322,24 +421,152 @@ PersistentCache::SkSLCache PersistentCache::LoadFile(
   return result;
 }
 
+std::vector<std::pair<std::string, PersistentCache::SkSLCache>>
+PersistentCache::LoadCacheObjectFiles(const fml::UniqueFD& dir,
+                                      bool log_failures) {
+  std::vector<std::pair<std::string, SkSLCache>> result;
+  fml::FileVisitor visitor = [&result, log_failures](
+                                 const fml::UniqueFD& directory,
+                                 const std::string& filename) {
+    if (filename == kPackedCacheFileName ||
+        fml::IsDirectory(directory, filename.c_str())) {
+      return true;
+    }
+    SkSLCache cache = LoadFile(directory, filename, true);
+    if (cache.key != nullptr && cache.value != nullptr) {
+      result.push_back({filename, cache});
+    } else if (log_failures) {
+      FML_LOG(ERROR) << "Failed to load: " << filename;
+    }
+    return true;
+  };
+  fml::VisitFiles(dir, visitor);
+  return result;
+}
+
+void PersistentCache::MigrateCacheObjectFiles(const fml::UniqueFD& dir,
+                                              PackedCacheFile& cache_file) {
+  auto files = LoadCacheObjectFiles(dir, false);
+  if (files.empty()) {
+    return;
+  }
+  TRACE_EVENT0("flutter", "PersistentCache::MigrateCacheObjectFiles");
+  std::vector<PackedCacheFile::Entry> entries;
+  entries.reserve(files.size());
+  for (const auto& file : files) {
+    entries.push_back({file.second.key, file.second.value});
+  }
+  if (!cache_file.Store(entries)) {
+    FML_LOG(WARNING) << "Could not move the persistent cache into one file.";
+    return;
+  }
+  for (const auto& file : files) {
+    fml::UnlinkFile(dir, file.first.c_str());
+  }
+  FML_LOG(INFO) << "Moved " << files.size()
+                << " persistent cache files into one file.";
+}
+
 // |GrContextOptions::PersistentCache|
 sk_sp<SkData> PersistentCache::load(const SkData& key) {
   TRACE_EVENT0("flutter", "PersistentCacheLoad");
-  if (!IsValid()) {
+  if (key.size() == 0) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
-    return nullptr;
+  sk_sp<SkData> result;
+  if (IsValid()) {
+    result = cache_file_->Load(key);
+    // Read-only caches cannot move files with an entry each into the cache
+    // file, and writable caches only do so once they have a worker.
+    if (result == nullptr) {
+      result = LoadFile(*cache_directory_, SkKeyToFilePath(key), false).value;
+    }
   }
-  auto result =
-      PersistentCache::LoadFile(*cache_directory_, file_name, false).value;
   if (result != nullptr) {
     TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
   }
+  RecordShaderLoad(key, result != nullptr);
   return result;
 }
 
+void PersistentCache::SetFrameNumber(uint64_t frame_number) {
+  std::scoped_lock lock(shader_usage_mutex_);
+  frame_number_ = frame_number;
+  if (shader_usage_.miss_count > miss_count_at_frame_start_) {
+    shader_usage_.frames_with_misses++;
+  } else if (shader_usage_.hit_count == traced_hit_count_) {
+    return;
+  }
+  miss_count_at_frame_start_ = shader_usage_.miss_count;
+  traced_hit_count_ = shader_usage_.hit_count;
+  FML_TRACE_COUNTER("flutter", "PersistentCache::ShaderUsage",
+                    reinterpret_cast<int64_t>(this),  // Trace Counter ID
+                    "Hits", shader_usage_.hit_count, "Misses",
+                    shader_usage_.miss_count, "FramesWithMisses",
+                    shader_usage_.frames_with_misses, "CompileTimeMicros",
+                    shader_usage_.compile_time.ToMicroseconds());
+}
+
+PersistentCache::ShaderUsageStats PersistentCache::GetShaderUsageStats()
+    const {
+  std::scoped_lock lock(shader_usage_mutex_);
+  return shader_usage_;
+}
+
+PersistentCache::ShaderUsage& PersistentCache::GetShaderUsageLocked(
+    std::string key) {
+  auto found = shader_usage_indices_.find(key);
+  if (found != shader_usage_indices_.end()) {
+    return shader_usage_.shaders[found->second];
+  }
+  shader_usage_indices_.emplace(key, shader_usage_.shaders.size());
+  return shader_usage_.shaders.emplace_back(ShaderUsage{
+      .key = std::move(key),
+      .first_use_frame_number = frame_number_,
+  });
+}
+
+void PersistentCache::RecordShaderLoad(const SkData& key, bool hit) {
+  std::string key_string(static_cast<const char*>(key.data()), key.size());
+  std::scoped_lock lock(shader_usage_mutex_);
+  if (hit) {
+    shader_usage_.hit_count++;
+    GetShaderUsageLocked(std::move(key_string)).hit_count++;
+  } else {
+    shader_usage_.miss_count++;
+    shader_miss_times_[key_string] = fml::TimePoint::Now();
+    GetShaderUsageLocked(std::move(key_string)).miss_count++;
+  }
+}
+
+void PersistentCache::RecordShaderStore(const SkData& key) {
+  std::string key_string(static_cast<const char*>(key.data()), key.size());
+  std::scoped_lock lock(shader_usage_mutex_);
+  // Skia compiles a shader between its miss and storing it.
+  auto miss_time = shader_miss_times_.find(key_string);
+  if (miss_time == shader_miss_times_.end()) {
+    return;
+  }
+  const fml::TimeDelta compile_time = fml::TimePoint::Now() - miss_time->second;
+  shader_miss_times_.erase(miss_time);
+  shader_usage_.compile_time = shader_usage_.compile_time + compile_time;
+  ShaderUsage& usage = GetShaderUsageLocked(std::move(key_string));
+  usage.compile_time = usage.compile_time + compile_time;
+}
+
+static void RunOnWorker(fml::RefPtr<fml::TaskRunner> worker,
+                        fml::closure task) {
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    task();
+  } else {
+    worker->PostTask(std::move(task));
+  }
+}
+
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
                                  std::shared_ptr<fml::UniqueFD> cache_directory,
                                  std::string key,
@@ -356,16 +583,7 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
       FML_LOG(WARNING) << "Could not write cache contents to persistent store.";
     }
   });
-
-  if (!worker) {
-    FML_LOG(WARNING)
-        << "The persistent cache has no available workers. Performing the task "
-           "on the current thread. This slow operation is going to occur on a "
-           "frame workload.";
-    task();
-  } else {
-    worker->PostTask(std::move(task));
-  }
+  RunOnWorker(std::move(worker), std::move(task));
 }
 
 std::unique_ptr<fml::MallocMapping> PersistentCache::BuildCacheObject(
@@ -391,6 +609,7 @@ std::unique_ptr<fml::MallocMapping> PersistentCache::BuildCacheObject(
 // |GrContextOptions::PersistentCache|
 void PersistentCache::store(const SkData& key, const SkData& data) {
   stored_new_shaders_ = true;
+  RecordShaderStore(key);
 
   if (is_read_only_) {
     return;
@@ -400,20 +619,22 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
-
-  if (file_name.size() == 0) {
-    return;
-  }
-
-  std::unique_ptr<fml::MallocMapping> mapping = BuildCacheObject(key, data);
-  if (!mapping) {
+  if (key.size() == 0) {
     return;
   }
 
-  PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
+  PackedCacheFile::Entry entry = {
+      .key = SkData::MakeWithCopy(key.data(), key.size()),
+      .value = SkData::MakeWithCopy(data.data(), data.size()),
+  };
+  auto task = [cache_file = cache_sksl_ ? sksl_cache_file_ : cache_file_,
+               entry = std::move(entry)]() {
+    TRACE_EVENT0("flutter", "PersistentCacheStore");
+    if (!cache_file->Store({entry})) {
+      FML_LOG(WARNING) << "Could not write cache contents to persistent store.";
+    }
+  };
+  RunOnWorker(GetWorkerTaskRunner(), std::move(task));
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
@@ -434,10 +655,48 @@ void PersistentCache::DumpSkp(const SkData& data) {
                        std::move(file_name), std::move(mapping));
 }
 
+std::unique_ptr<fml::Mapping> PersistentCache::LoadDataFile(
+    const std::string& file_name) {
+  if (!IsValid()) {
+    return nullptr;
+  }
+  auto file = fml::FileMapping::CreateReadOnly(*cache_directory_, file_name);
+  if (!file) {
+    return nullptr;
+  }
+  // The contents are copied, so that StoreDataFile can replace the file while
+  // they are in use. Windows cannot replace a file that is still mapped.
+  return std::make_unique<fml::DataMapping>(std::vector<uint8_t>{
+      file->GetMapping(), file->GetMapping() + file->GetSize()});
+}
+
+void PersistentCache::StoreDataFile(std::string file_name,
+                                    std::unique_ptr<fml::Mapping> data) {
+  if (is_read_only_ || !IsValid() || !data) {
+    return;
+  }
+  PersistentCacheStore(GetWorkerTaskRunner(), cache_directory_,
+                       std::move(file_name), std::move(data));
+}
+
 void PersistentCache::AddWorkerTaskRunner(
     fml::RefPtr<fml::TaskRunner> task_runner) {
   std::scoped_lock lock(worker_task_runners_mutex_);
   worker_task_runners_.insert(task_runner);
+  // Moving the files with an entry each into the cache files reads all of
+  // them, so it is left to the first worker instead of the constructor.
+  if (!migration_posted_ && !is_read_only_ && IsValid()) {
+    migration_posted_ = true;
+    task_runner->PostTask([cache_directory = cache_directory_,
+                           cache_file = cache_file_,
+                           sksl_cache_directory = sksl_cache_directory_,
+                           sksl_cache_file = sksl_cache_file_]() {
+      MigrateCacheObjectFiles(*cache_directory, *cache_file);
+      if (sksl_cache_directory->is_valid()) {
+        MigrateCacheObjectFiles(*sksl_cache_directory, *sksl_cache_file);
+      }
+    });
+  }
 }
 
 void PersistentCache::RemoveWorkerTaskRunner(
@@ -449,6 +708,12 @@ void PersistentCache::RemoveWorkerTaskRunner(
   }
 }
 
+void PersistentCache::SetBackgroundTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  std::scoped_lock lock(worker_task_runners_mutex_);
+  background_task_runner_ = std::move(task_runner);
+}
+
 fml::RefPtr<fml::TaskRunner> PersistentCache::GetWorkerTaskRunner() const {
   fml::RefPtr<fml::TaskRunner> worker;
 
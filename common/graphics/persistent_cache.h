@@ -5,13 +5,22 @@
 #ifndef FLUTTER_COMMON_GRAPHICS_PERSISTENT_CACHE_H_
 #define FLUTTER_COMMON_GRAPHICS_PERSISTENT_CACHE_H_
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "flutter/assets/asset_manager.h"
+#include "flutter/common/graphics/packed_cache_file.h"
+#include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/unique_fd.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
 
@@ -25,6 +34,10 @@ class ShellTest;
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
 /// thread-safe for reading and writing from multiple threads.
+///
+/// The entries are packed into a single |PackedCacheFile| per directory.
+/// Caches written by older engines, with a file per entry, are moved into it
+/// when a writable cache is opened.
 class PersistentCache : public GrContextOptions::PersistentCache {
  public:
   // Mutable static switch that can be set before GetCacheForProcess. If true,
@@ -48,7 +61,7 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   static std::string SkKeyToFilePath(const SkData& key);
 
   // Allocate a MallocMapping containing the given key and value in the file
-  // format used by the cache.
+  // format used by caches with a file per entry.
   static std::unique_ptr<fml::MallocMapping> BuildCacheObject(
       const SkData& key,
       const SkData& data);
@@ -68,15 +81,56 @@ class PersistentCache : public GrContextOptions::PersistentCache {
 
   ~PersistentCache() override;
 
+  /// Adds a task runner for file system work. The files with an entry each
+  /// that older engines wrote are moved into the cache files on the first one.
   void AddWorkerTaskRunner(fml::RefPtr<fml::TaskRunner> task_runner);
 
   void RemoveWorkerTaskRunner(fml::RefPtr<fml::TaskRunner> task_runner);
 
+  /// Sets the task runner that reads the SkSLs to precompile in the
+  /// background. They are read on the thread they are compiled on if it is
+  /// null.
+  void SetBackgroundTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   // Whether Skia tries to store any shader into this persistent cache after
   // |ResetStoredNewShaders| is called. This flag is usually reset before each
   // frame so we can know if Skia tries to compile new shaders in that frame.
   bool StoredNewShaders() const { return stored_new_shaders_; }
   void ResetStoredNewShaders() { stored_new_shaders_ = false; }
+
+  /// How a shader was used since this cache was created.
+  struct ShaderUsage {
+    /// The key of the shader, as given by Skia.
+    std::string key;
+    /// The number of the frame in which the shader was first loaded.
+    uint64_t first_use_frame_number = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+    /// The time from the misses until Skia stored the compiled shader.
+    fml::TimeDelta compile_time;
+  };
+
+  struct ShaderUsageStats {
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+    /// The number of frames in which a shader missed the cache.
+    uint64_t frames_with_misses = 0;
+    fml::TimeDelta compile_time;
+    /// The shaders in the order in which they were first used.
+    std::vector<ShaderUsage> shaders;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Attributes the shaders loaded from now on to the given frame.
+  ///
+  ///             Emits the totals of |GetShaderUsageStats| as trace counters if
+  ///             they changed during the previous frame.
+  ///
+  void SetFrameNumber(uint64_t frame_number);
+
+  ShaderUsageStats GetShaderUsageStats() const;
+
   void DumpSkp(const SkData& data);
   bool IsDumpingSkp() const { return is_dumping_skp_; }
   void SetIsDumpingSkp(bool value) { is_dumping_skp_ = value; }
@@ -93,7 +147,9 @@ class PersistentCache : public GrContextOptions::PersistentCache {
     sk_sp<SkData> value;
   };
 
-  /// Load all the SkSL shader caches in the right directory.
+  /// Load all the SkSL shader caches in the right directory. Those stored
+  /// during previous runs come first, in the order in which they were first
+  /// stored, followed by those packaged with the application.
   std::vector<SkSLCache> LoadSkSLs() const;
 
   //----------------------------------------------------------------------------
@@ -111,6 +167,60 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   ///
   size_t PrecompileKnownSkSLs(GrDirectContext* context) const;
 
+  //----------------------------------------------------------------------------
+  /// Runs the given closure with the rendering context current, passing it the
+  /// context. Returns false, without running the closure, if the context is
+  /// gone or can no longer be used.
+  ///
+  using ContextScope =
+      std::function<bool(const std::function<void(GrDirectContext*)>&)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Like |PrecompileKnownSkSLs|, but does not block the calling
+  ///             thread until all of the SkSLs are compiled.
+  ///
+  ///             The SkSLs are loaded on the workers of Skia's executor. Each
+  ///             of them is then compiled in a task of its own on
+  ///             `task_runner`, in the order returned by |LoadSkSLs|. The tasks
+  ///             are posted one after another, so frames are rasterized in
+  ///             between them. A frame that needs a shader that has not been
+  ///             precompiled yet has Skia compile just that shader.
+  ///
+  ///             Does nothing if the SkSLs are still being precompiled in
+  ///             `context`.
+  ///
+  /// @param      context      The rendering context to precompile shaders in.
+  ///                          It is only compared with the contexts of
+  ///                          earlier calls. The precompilation does not keep
+  ///                          it alive, so that it is only ever released on
+  ///                          its own thread.
+  /// @param      task_runner  The task runner of the thread that `context` is
+  ///                          used on.
+  /// @param      scope        Provides `context`, made current, for each
+  ///                          compilation.
+  ///
+  void PrecompileKnownSkSLsInBackground(
+      const GrDirectContext* context,
+      fml::RefPtr<fml::TaskRunner> task_runner,
+      ContextScope scope);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Reads the file named `file_name` in the cache directory, for
+  ///             data other than shaders that is worth keeping across runs.
+  ///             The file is not kept open, so it can be stored again while
+  ///             the returned contents are in use.
+  ///
+  /// @return     The contents of the file, or null if there is no such file.
+  ///
+  std::unique_ptr<fml::Mapping> LoadDataFile(const std::string& file_name);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Replaces the file named `file_name` in the cache directory
+  ///             with `data`. The file is written on a worker thread. Does
+  ///             nothing if the cache is read-only.
+  ///
+  void StoreDataFile(std::string file_name, std::unique_ptr<fml::Mapping> data);
+
   // Return mappings for all skp's accessible through the AssetManager
   std::vector<std::unique_ptr<fml::Mapping>> GetSkpsFromAssetManager() const;
 
@@ -125,9 +235,16 @@ class PersistentCache : public GrContextOptions::PersistentCache {
 
   static void SetCacheSkSL(bool value);
 
+  static bool precompile_in_background() { return precompile_in_background_; }
+
+  static void SetPrecompileInBackground(bool value) {
+    precompile_in_background_ = value;
+  }
+
   static void MarkStrategySet() { strategy_set_ = true; }
 
   static constexpr char kSkSLSubdirName[] = "sksl";
+  static constexpr char kPackedCacheFileName[] = "cache.pack";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
 
  private:
@@ -148,11 +265,35 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // strategy_set_ becomes true.
   static std::atomic<bool> strategy_set_;
 
+  static std::atomic<bool> precompile_in_background_;
+
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  const std::shared_ptr<PackedCacheFile> cache_file_;
+  const std::shared_ptr<PackedCacheFile> sksl_cache_file_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
+  // Whether a worker was asked to move the files with an entry each into the
+  // cache files.
+  bool migration_posted_ = false;
+  std::shared_ptr<fml::ConcurrentTaskRunner> background_task_runner_;
+
+  std::mutex background_precompile_mutex_;
+  // The context that SkSLs are being precompiled in, and the state of the
+  // precompilation, which expires once it is done.
+  const GrDirectContext* background_precompile_context_ = nullptr;
+  std::weak_ptr<void> background_precompile_;
+
+  mutable std::mutex shader_usage_mutex_;
+  uint64_t frame_number_ = 0;
+  uint64_t miss_count_at_frame_start_ = 0;
+  uint64_t traced_hit_count_ = 0;
+  ShaderUsageStats shader_usage_;
+  // The index of each key in |shader_usage_.shaders|.
+  std::unordered_map<std::string, size_t> shader_usage_indices_;
+  // The time of the last miss of each shader that Skia is compiling.
+  std::unordered_map<std::string, fml::TimePoint> shader_miss_times_;
 
   bool stored_new_shaders_ = false;
   bool is_dumping_skp_ = false;
@@ -161,8 +302,23 @@ class PersistentCache : public GrContextOptions::PersistentCache {
                             const std::string& file_name,
                             bool need_key);
 
+  // Loads the files with an entry each in `dir`.
+  static std::vector<std::pair<std::string, SkSLCache>> LoadCacheObjectFiles(
+      const fml::UniqueFD& dir,
+      bool log_failures);
+
+  // Moves the files with an entry each in `dir` into `cache_file`.
+  static void MigrateCacheObjectFiles(const fml::UniqueFD& dir,
+                                      PackedCacheFile& cache_file);
+
   bool IsValid() const;
 
+  ShaderUsage& GetShaderUsageLocked(std::string key);
+
+  void RecordShaderLoad(const SkData& key, bool hit);
+
+  void RecordShaderStore(const SkData& key);
+
   explicit PersistentCache(bool read_only = false);
 
   // |GrContextOptions::PersistentCache|
@@ -41,6 +41,8 @@ std::string Settings::ToString() const {
   stream << "dump_skp_on_shader_compilation: " << dump_skp_on_shader_compilation
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
+  stream << "precompile_sksls_in_background: "
+         << precompile_sksls_in_background << std::endl;
   stream << "purge_persistent_cache: " << purge_persistent_cache << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
@@ -62,6 +64,10 @@ std::string Settings::ToString() const {
   stream << "frame_rasterized_callback set: " << !!frame_rasterized_callback
          << std::endl;
   stream << "old_gen_heap_size: " << old_gen_heap_size << std::endl;
+  stream << "decoded_image_cache_max_bytes: " << decoded_image_cache_max_bytes
+         << std::endl;
+  stream << "text_layout_cache_max_bytes: " << text_layout_cache_max_bytes
+         << std::endl;
   return stream.str();
 }
 
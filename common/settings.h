@@ -136,6 +136,9 @@ struct Settings {
   bool trace_systrace = false;
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
+  // Whether the known SkSLs are precompiled between frames instead of before
+  // the first one.
+  bool precompile_sksls_in_background = false;
   bool purge_persistent_cache = false;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
@@ -283,6 +286,18 @@ struct Settings {
   /// https://github.com/dart-lang/sdk/blob/ca64509108b3e7219c50d6c52877c85ab6a35ff2/runtime/vm/flag_list.h#L150
   int64_t old_gen_heap_size = -1;
 
+  /// The maximum number of bytes of decoded images and their source data the
+  /// image decoder keeps around so that decoding the same bytes at the same
+  /// size again is free. Cached images stay resident on the GPU, so the cache
+  /// is disabled by default.
+  size_t decoded_image_cache_max_bytes = 0;
+
+  /// The maximum number of bytes of shaped words, and of the text they were
+  /// shaped in, that the text layout engine caches. The cache is shared by all
+  /// engines in the process, so the last engine to start sets its size. Zero
+  /// disables the cache.
+  size_t text_layout_cache_max_bytes = 4 * 1024 * 1024;
+
   /// A timestamp representing when the engine started. The value is based
   /// on the clock used by the Dart timeline APIs. This timestamp is used
   /// to log a timeline event that tracks the latency of engine startup.
@@ -5,14 +5,193 @@
 #ifndef FLUTTER_FML_CLOSURE_H_
 #define FLUTTER_FML_CLOSURE_H_
 
+#include <cstddef>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "flutter/fml/logging.h"
 #include "flutter/fml/macros.h"
 
 namespace fml {
 
 using closure = std::function<void()>;
 
+//------------------------------------------------------------------------------
+/// @brief      A move-only, type-erased `void()` callable used to represent
+///             tasks posted to task runners.
+///
+///             Unlike `fml::closure`, callables of up to `kInlineCapacity`
+///             bytes are stored inline. This covers the typical task that
+///             captures a weak pointer and a few values, and avoids a heap
+///             allocation per posted task. Larger callables are stored on the
+///             heap. Since it is move-only, callables that capture move-only
+///             types don't need to be wrapped with `fml::MakeCopyable`.
+///
+///             Any `fml::closure` implicitly converts to a `UniqueClosure`,
+///             so existing call sites that post `fml::closure`s keep working.
+///             An empty `fml::closure` converts to an empty `UniqueClosure`.
+///
+class UniqueClosure {
+ public:
+  static constexpr size_t kInlineCapacity = 8 * sizeof(void*);
+
+  UniqueClosure() = default;
+
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  UniqueClosure(std::nullptr_t) {}
+
+  template <typename Callable,
+            typename Decayed = std::decay_t<Callable>,
+            typename = std::enable_if_t<
+                !std::is_same_v<Decayed, UniqueClosure> &&
+                std::is_invocable_r_v<void, Decayed&>>>
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  UniqueClosure(Callable&& callable) {
+    if constexpr (std::is_constructible_v<bool, const Decayed&>) {
+      // Function pointers and std::functions may be null.
+      if (!static_cast<bool>(callable)) {
+        return;
+      }
+    }
+    if constexpr (IsInlineable<Decayed>()) {
+      new (&storage_) Decayed(std::forward<Callable>(callable));
+      ops_ = &kInlineOps<Decayed>;
+    } else {
+      new (&storage_) Decayed*(new Decayed(std::forward<Callable>(callable)));
+      ops_ = &kHeapOps<Decayed>;
+    }
+  }
+
+  UniqueClosure(UniqueClosure&& other) noexcept { MoveFrom(other); }
+
+  UniqueClosure& operator=(UniqueClosure&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  UniqueClosure& operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  ~UniqueClosure() { Reset(); }
+
+  void operator()() const {
+    FML_DCHECK(ops_) << "Invoked an empty UniqueClosure.";
+    ops_->invoke(const_cast<Storage*>(&storage_));
+  }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  friend bool operator==(const UniqueClosure& closure, std::nullptr_t) {
+    return !closure;
+  }
+
+  friend bool operator!=(const UniqueClosure& closure, std::nullptr_t) {
+    return static_cast<bool>(closure);
+  }
+
+ private:
+  struct Storage {
+    alignas(std::max_align_t) unsigned char bytes[kInlineCapacity];
+  };
+
+  struct Ops {
+    void (*invoke)(Storage* storage);
+    // Move constructs the callable into |to| and destroys the one in |from|.
+    void (*relocate)(Storage* to, Storage* from);
+    void (*destroy)(Storage* storage);
+  };
+
+  template <typename T>
+  static constexpr bool IsInlineable() {
+    return sizeof(T) <= sizeof(Storage) && alignof(T) <= alignof(Storage) &&
+           std::is_nothrow_move_constructible_v<T>;
+  }
+
+  template <typename T>
+  static T* InlineCallable(Storage* storage) {
+    return std::launder(reinterpret_cast<T*>(storage));
+  }
+
+  template <typename T>
+  static T*& HeapCallable(Storage* storage) {
+    return *std::launder(reinterpret_cast<T**>(storage));
+  }
+
+  template <typename T>
+  static void InvokeInline(Storage* storage) {
+    (*InlineCallable<T>(storage))();
+  }
+
+  template <typename T>
+  static void RelocateInline(Storage* to, Storage* from) {
+    T* callable = InlineCallable<T>(from);
+    new (to) T(std::move(*callable));
+    callable->~T();
+  }
+
+  template <typename T>
+  static void DestroyInline(Storage* storage) {
+    InlineCallable<T>(storage)->~T();
+  }
+
+  template <typename T>
+  static void InvokeHeap(Storage* storage) {
+    (*HeapCallable<T>(storage))();
+  }
+
+  template <typename T>
+  static void RelocateHeap(Storage* to, Storage* from) {
+    new (to) T*(HeapCallable<T>(from));
+  }
+
+  template <typename T>
+  static void DestroyHeap(Storage* storage) {
+    delete HeapCallable<T>(storage);
+  }
+
+  template <typename T>
+  static inline constexpr Ops kInlineOps = {
+      .invoke = &InvokeInline<T>,
+      .relocate = &RelocateInline<T>,
+      .destroy = &DestroyInline<T>,
+  };
+
+  template <typename T>
+  static inline constexpr Ops kHeapOps = {
+      .invoke = &InvokeHeap<T>,
+      .relocate = &RelocateHeap<T>,
+      .destroy = &DestroyHeap<T>,
+  };
+
+  Storage storage_;
+  const Ops* ops_ = nullptr;
+
+  void MoveFrom(UniqueClosure& other) {
+    if (other.ops_) {
+      other.ops_->relocate(&storage_, &other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset() {
+    if (ops_) {
+      const Ops* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(&storage_);
+    }
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(UniqueClosure);
+};
+
 //------------------------------------------------------------------------------
 /// @brief      Wraps a closure that is invoked in the destructor unless
 ///             released by the caller.
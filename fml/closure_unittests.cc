@@ -0,0 +1,128 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/closure.h"
+
+#include <array>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+namespace {
+
+// Counts the number of live instances of itself so that tests can verify that
+// the callables owned by |UniqueClosure|s are destroyed exactly once.
+template <size_t kPaddingSize>
+class CountedCallable {
+ public:
+  explicit CountedCallable(int* live_count, int* invoke_count)
+      : live_count_(live_count), invoke_count_(invoke_count) {
+    (*live_count_)++;
+  }
+
+  CountedCallable(const CountedCallable& other)
+      : live_count_(other.live_count_), invoke_count_(other.invoke_count_) {
+    (*live_count_)++;
+  }
+
+  CountedCallable(CountedCallable&& other) noexcept
+      : live_count_(other.live_count_), invoke_count_(other.invoke_count_) {
+    (*live_count_)++;
+  }
+
+  ~CountedCallable() { (*live_count_)--; }
+
+  void operator()() { (*invoke_count_)++; }
+
+ private:
+  int* live_count_;
+  int* invoke_count_;
+  std::array<char, kPaddingSize> padding_ = {};
+};
+
+using SmallCallable = CountedCallable<8>;
+using LargeCallable = CountedCallable<UniqueClosure::kInlineCapacity * 2>;
+
+}  // namespace
+
+TEST(UniqueClosureTest, DefaultIsEmpty) {
+  UniqueClosure closure;
+  ASSERT_FALSE(closure);
+  ASSERT_TRUE(closure == nullptr);
+  UniqueClosure null_closure = nullptr;
+  ASSERT_FALSE(null_closure);
+}
+
+TEST(UniqueClosureTest, EmptyStdFunctionIsEmpty) {
+  fml::closure empty;
+  UniqueClosure closure = empty;
+  ASSERT_FALSE(closure);
+}
+
+TEST(UniqueClosureTest, InvokesStdFunction) {
+  int count = 0;
+  fml::closure function = [&count]() { count++; };
+  UniqueClosure closure = function;
+  ASSERT_TRUE(closure);
+  closure();
+  closure();
+  ASSERT_EQ(count, 2);
+}
+
+TEST(UniqueClosureTest, AcceptsMoveOnlyCaptures) {
+  auto value = std::make_unique<int>(42);
+  int result = 0;
+  UniqueClosure closure = [value = std::move(value), &result]() {
+    result = *value;
+  };
+  closure();
+  ASSERT_EQ(result, 42);
+}
+
+TEST(UniqueClosureTest, MovesAndDestroysInlineCallables) {
+  int live_count = 0;
+  int invoke_count = 0;
+  {
+    UniqueClosure closure = SmallCallable(&live_count, &invoke_count);
+    ASSERT_EQ(live_count, 1);
+    UniqueClosure moved = std::move(closure);
+    ASSERT_FALSE(closure);  // NOLINT(bugprone-use-after-move)
+    ASSERT_EQ(live_count, 1);
+    moved();
+    ASSERT_EQ(invoke_count, 1);
+  }
+  ASSERT_EQ(live_count, 0);
+}
+
+TEST(UniqueClosureTest, MovesAndDestroysHeapCallables) {
+  int live_count = 0;
+  int invoke_count = 0;
+  {
+    UniqueClosure closure = LargeCallable(&live_count, &invoke_count);
+    ASSERT_EQ(live_count, 1);
+    UniqueClosure moved;
+    moved = std::move(closure);
+    ASSERT_FALSE(closure);  // NOLINT(bugprone-use-after-move)
+    ASSERT_EQ(live_count, 1);
+    moved();
+    ASSERT_EQ(invoke_count, 1);
+  }
+  ASSERT_EQ(live_count, 0);
+}
+
+TEST(UniqueClosureTest, AssigningNullDestroysCallable) {
+  int live_count = 0;
+  int invoke_count = 0;
+  UniqueClosure closure = SmallCallable(&live_count, &invoke_count);
+  ASSERT_EQ(live_count, 1);
+  closure = nullptr;
+  ASSERT_FALSE(closure);
+  ASSERT_EQ(live_count, 0);
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -47,7 +47,8 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(fml::UniqueClosure task,
+                                     ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
@@ -64,7 +65,10 @@ void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
     return;
   }
 
-  tasks_.push(task);
+  tasks_[static_cast<size_t>(priority)].push({
+      .task = std::move(task),
+      .post_time = fml::TimePoint::Now(),
+  });
 
   // Unlock the mutex before notifying the condition variable because that mutex
   // has to be acquired on the other thread anyway. Waiting in this scope till
@@ -78,17 +82,19 @@ void ConcurrentMessageLoop::WorkerMain() {
   while (true) {
     std::unique_lock lock(tasks_mutex_);
     tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
+      return HasTasksLocked() || shutdown_ || HasThreadTasksLocked();
     });
 
     // Shutdown cannot be read with the task mutex unlocked.
     bool shutdown_now = shutdown_;
-    fml::closure task;
+    fml::UniqueClosure task;
     std::vector<fml::closure> thread_tasks;
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+    if (HasTasksLocked()) {
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kDefault;
+      auto pending = PopTaskLocked(&priority);
+      TraceQueueWait(priority, fml::TimePoint::Now() - pending.post_time);
+      task = std::move(pending.task);
     }
 
     if (HasThreadTasksLocked()) {
@@ -135,6 +141,69 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
   tasks_condition_.notify_all();
 }
 
+bool ConcurrentMessageLoop::HasTasksLocked() const {
+  return std::any_of(tasks_.begin(), tasks_.end(),
+                     [](const auto& queue) { return !queue.empty(); });
+}
+
+ConcurrentMessageLoop::PendingTask ConcurrentMessageLoop::PopTaskLocked(
+    ConcurrentTaskPriority* priority) {
+  FML_DCHECK(HasTasksLocked());
+
+  // Prefer the most important non-empty priority class unless a less important
+  // one has been passed over too many times in a row.
+  size_t selected = kPriorityCount;
+  for (size_t i = 0; i < kPriorityCount; ++i) {
+    if (tasks_[i].empty()) {
+      continue;
+    }
+    if (selected == kPriorityCount) {
+      selected = i;
+    } else if (starved_dequeues_[i] >= kMaxStarvedDequeues) {
+      selected = i;
+      break;
+    }
+  }
+  FML_DCHECK(selected < kPriorityCount);
+
+  for (size_t i = 0; i < kPriorityCount; ++i) {
+    if (i == selected || tasks_[i].empty()) {
+      starved_dequeues_[i] = 0;
+    } else {
+      starved_dequeues_[i]++;
+    }
+  }
+
+  PendingTask pending = std::move(tasks_[selected].front());
+  tasks_[selected].pop();
+  *priority = static_cast<ConcurrentTaskPriority>(selected);
+  return pending;
+}
+
+void ConcurrentMessageLoop::TraceQueueWait(ConcurrentTaskPriority priority,
+                                           fml::TimeDelta wait) const {
+#if !FLUTTER_RELEASE
+  const int64_t wait_micros = wait.ToMicroseconds();
+  switch (priority) {
+    case ConcurrentTaskPriority::kUserBlocking:
+      FML_TRACE_COUNTER("flutter", "ConcurrentMessageLoop::QueueWait",
+                        reinterpret_cast<int64_t>(this),  //
+                        "UserBlockingMicros", wait_micros);
+      break;
+    case ConcurrentTaskPriority::kDefault:
+      FML_TRACE_COUNTER("flutter", "ConcurrentMessageLoop::QueueWait",
+                        reinterpret_cast<int64_t>(this),  //
+                        "DefaultMicros", wait_micros);
+      break;
+    case ConcurrentTaskPriority::kBackground:
+      FML_TRACE_COUNTER("flutter", "ConcurrentMessageLoop::QueueWait",
+                        reinterpret_cast<int64_t>(this),  //
+                        "BackgroundMicros", wait_micros);
+      break;
+  }
+#endif  // !FLUTTER_RELEASE
+}
+
 bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
   return thread_tasks_.count(std::this_thread::get_id()) > 0;
 }
@@ -154,13 +223,18 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task) {
+  PostTask(std::move(task), ConcurrentTaskPriority::kDefault);
+}
+
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task,
+                                    ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(std::move(task), priority);
     return;
   }
 
@@ -170,4 +244,11 @@ void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
   task();
 }
 
+size_t ConcurrentTaskRunner::GetWorkerCount() const {
+  if (auto loop = weak_loop_.lock()) {
+    return loop->GetWorkerCount();
+  }
+  return 0;
+}
+
 }  // namespace fml
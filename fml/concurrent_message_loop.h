@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <array>
 #include <condition_variable>
 #include <map>
 #include <queue>
@@ -13,11 +14,26 @@
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_point.h"
 
 namespace fml {
 
 class ConcurrentTaskRunner;
 
+/// The priority class of a task posted to a \p ConcurrentMessageLoop. Workers
+/// always prefer the task at the head of the most important non-empty class
+/// but guarantee forward progress for the less important classes.
+enum class ConcurrentTaskPriority {
+  /// Work that a frame currently being produced is waiting on. For instance,
+  /// shader compilation requested by the rasterizer.
+  kUserBlocking,
+  /// The absence of a specialized `ConcurrentTaskPriority`.
+  kDefault,
+  /// Work whose results are not needed any time soon. For instance, cache
+  /// warm-ups.
+  kBackground,
+};
+
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
@@ -34,14 +50,27 @@ class ConcurrentMessageLoop
 
   void PostTaskToAllWorkers(fml::closure task);
 
+  /// The number of times in a row a non-empty priority class may be passed
+  /// over in favor of a more important class before one of its tasks is
+  /// serviced regardless.
+  static constexpr size_t kMaxStarvedDequeues = 8;
+
  private:
   friend ConcurrentTaskRunner;
 
+  static constexpr size_t kPriorityCount = 3;
+
+  struct PendingTask {
+    fml::UniqueClosure task;
+    fml::TimePoint post_time;
+  };
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
   std::mutex tasks_mutex_;
   std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
+  std::array<std::queue<PendingTask>, kPriorityCount> tasks_;
+  std::array<size_t, kPriorityCount> starved_dequeues_ = {};
   std::vector<std::thread::id> worker_thread_ids_;
   std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
   bool shutdown_ = false;
@@ -50,12 +79,19 @@ class ConcurrentMessageLoop
 
   void WorkerMain();
 
-  void PostTask(const fml::closure& task);
+  void PostTask(fml::UniqueClosure task, ConcurrentTaskPriority priority);
+
+  bool HasTasksLocked() const;
+
+  PendingTask PopTaskLocked(ConcurrentTaskPriority* priority);
 
   bool HasThreadTasksLocked() const;
 
   std::vector<fml::closure> GetThreadTasksLocked();
 
+  void TraceQueueWait(ConcurrentTaskPriority priority,
+                      fml::TimeDelta wait) const;
+
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
 
@@ -65,7 +101,15 @@ class ConcurrentTaskRunner : public BasicTaskRunner {
 
   virtual ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task) override;
+  /// Posts the task with `ConcurrentTaskPriority::kDefault`.
+  void PostTask(fml::UniqueClosure task) override;
+
+  /// Posts the task with the given priority class. Tasks within the same
+  /// priority class are executed in the order they were posted.
+  void PostTask(fml::UniqueClosure task, ConcurrentTaskPriority priority);
+
+  /// The number of workers of the loop, or zero if the loop has already died.
+  size_t GetWorkerCount() const;
 
  private:
   friend ConcurrentMessageLoop;
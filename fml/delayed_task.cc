@@ -6,25 +6,33 @@
 
 #include "flutter/fml/delayed_task.h"
 
+#include <algorithm>
+
 namespace fml {
 
 DelayedTask::DelayedTask(size_t order,
-                         const fml::closure& task,
+                         fml::UniqueClosure task,
                          fml::TimePoint target_time,
                          fml::TaskSourceGrade task_source_grade)
     : order_(order),
-      task_(task),
+      task_(std::move(task)),
       target_time_(target_time),
       task_source_grade_(task_source_grade) {}
 
 DelayedTask::~DelayedTask() = default;
 
-DelayedTask::DelayedTask(const DelayedTask& other) = default;
+DelayedTask::DelayedTask(DelayedTask&& other) = default;
+
+DelayedTask& DelayedTask::operator=(DelayedTask&& other) = default;
 
-const fml::closure& DelayedTask::GetTask() const {
+const fml::UniqueClosure& DelayedTask::GetTask() const {
   return task_;
 }
 
+fml::UniqueClosure DelayedTask::ReleaseTask() {
+  return std::move(task_);
+}
+
 fml::TimePoint DelayedTask::GetTargetTime() const {
   return target_time_;
 }
@@ -40,4 +48,28 @@ bool DelayedTask::operator>(const DelayedTask& other) const {
   return target_time_ > other.target_time_;
 }
 
+void DelayedTaskQueue::PushAll(std::vector<DelayedTask> tasks) {
+  const size_t existing_count = c.size();
+  for (auto& task : tasks) {
+    c.push_back(std::move(task));
+  }
+  // Sifting up each new task is O(k log(n + k)) while rebuilding the heap is
+  // O(n + k). Prefer the latter once the new tasks are at least as many as the
+  // existing ones.
+  if (tasks.size() >= existing_count) {
+    std::make_heap(c.begin(), c.end(), comp);
+  } else {
+    for (auto it = c.begin() + existing_count; it != c.end(); ++it) {
+      std::push_heap(c.begin(), it + 1, comp);
+    }
+  }
+}
+
+DelayedTask DelayedTaskQueue::Take() {
+  std::pop_heap(c.begin(), c.end(), comp);
+  DelayedTask task = std::move(c.back());
+  c.pop_back();
+  return task;
+}
+
 }  // namespace fml
@@ -6,6 +6,7 @@
 #define FLUTTER_FML_DELAYED_TASK_H_
 
 #include <queue>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/task_source_grade.h"
@@ -16,15 +17,20 @@ namespace fml {
 class DelayedTask {
  public:
   DelayedTask(size_t order,
-              const fml::closure& task,
+              fml::UniqueClosure task,
               fml::TimePoint target_time,
               fml::TaskSourceGrade task_source_grade);
 
-  DelayedTask(const DelayedTask& other);
+  DelayedTask(DelayedTask&& other);
+
+  DelayedTask& operator=(DelayedTask&& other);
 
   ~DelayedTask();
 
-  const fml::closure& GetTask() const;
+  const fml::UniqueClosure& GetTask() const;
+
+  /// Moves the task out of this `DelayedTask`, leaving it empty.
+  fml::UniqueClosure ReleaseTask();
 
   fml::TimePoint GetTargetTime() const;
 
@@ -34,14 +40,28 @@ class DelayedTask {
 
  private:
   size_t order_;
-  fml::closure task_;
+  fml::UniqueClosure task_;
   fml::TimePoint target_time_;
   fml::TaskSourceGrade task_source_grade_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTask);
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+/// A min-heap of `DelayedTask`s ordered by target time and then by the order
+/// in which they were posted.
+class DelayedTaskQueue : public std::priority_queue<DelayedTask,
+                                                   std::deque<DelayedTask>,
+                                                   std::greater<DelayedTask>> {
+ public:
+  /// Adds all the tasks to the queue. When the number of new tasks is large
+  /// compared to the number of tasks already in the queue, the heap is rebuilt
+  /// once instead of sifting each task up individually.
+  void PushAll(std::vector<DelayedTask> tasks);
+
+  /// Removes the top task from the queue and returns it. Unlike `pop`, this
+  /// allows the caller to take ownership of the move-only task.
+  DelayedTask Take();
+};
 
 }  // namespace fml
 
@@ -0,0 +1,202 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/fml/delayed_task_wheel.h"
+
+#include "flutter/fml/logging.h"
+
+namespace fml {
+
+namespace {
+
+constexpr int64_t kTickNanoseconds = 1000 * 1000;
+
+// Returns the index of the lowest set bit in |mask| that is above |index|, or
+// |DelayedTaskWheel::kSlotCount| if there is none.
+size_t FindOccupiedSlotAfter(uint64_t mask, size_t index) {
+  mask &= ~((uint64_t{2} << index) - 1);
+  if (mask == 0) {
+    return DelayedTaskWheel::kSlotCount;
+  }
+  size_t slot = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    slot++;
+  }
+  return slot;
+}
+
+}  // namespace
+
+DelayedTaskWheel::DelayedTaskWheel() = default;
+
+DelayedTaskWheel::~DelayedTaskWheel() = default;
+
+uint64_t DelayedTaskWheel::GetTick(fml::TimePoint time) {
+  const int64_t nanos = time.ToEpochDelta().ToNanoseconds();
+  return nanos <= 0 ? 0 : static_cast<uint64_t>(nanos / kTickNanoseconds);
+}
+
+bool DelayedTaskWheel::IsImmediate(const DelayedTask& task,
+                                   fml::TimePoint now) const {
+  // The FIFO must remain sorted.
+  if (!immediate_tasks_.empty() && !(task > immediate_tasks_.back())) {
+    return false;
+  }
+  return task.GetTargetTime() <= now;
+}
+
+void DelayedTaskWheel::Push(DelayedTask task) {
+  size_++;
+  if (IsImmediate(task, fml::TimePoint::Now())) {
+    immediate_tasks_.push_back(std::move(task));
+  } else {
+    PushDelayed(std::move(task));
+  }
+}
+
+void DelayedTaskWheel::PushAll(std::vector<DelayedTask> tasks) {
+  const auto now = fml::TimePoint::Now();
+  size_ += tasks.size();
+  for (auto& task : tasks) {
+    if (IsImmediate(task, now)) {
+      immediate_tasks_.push_back(std::move(task));
+    } else {
+      PushDelayed(std::move(task));
+    }
+  }
+}
+
+void DelayedTaskWheel::PushDelayed(DelayedTask task) {
+  if (near_tasks_.empty()) {
+    // The wheel is empty as well. Start it over at this task.
+    cursor_tick_ = GetTick(task.GetTargetTime());
+    near_tasks_.push(std::move(task));
+    return;
+  }
+  Place(std::move(task));
+}
+
+void DelayedTaskWheel::Place(DelayedTask task) {
+  const uint64_t tick = GetTick(task.GetTargetTime());
+  if (tick <= cursor_tick_) {
+    near_tasks_.push(std::move(task));
+    return;
+  }
+  // The level is the first one above which the task and the cursor agree.
+  const uint64_t difference = tick ^ cursor_tick_;
+  for (size_t level = 0; level < kLevelCount; level++) {
+    if ((difference >> (kSlotBits * (level + 1))) == 0) {
+      const size_t slot = (tick >> (kSlotBits * level)) & (kSlotCount - 1);
+      slots_[level][slot].emplace_back(std::move(task));
+      occupied_slots_[level] |= uint64_t{1} << slot;
+      return;
+    }
+  }
+  overflow_tasks_.push(std::move(task));
+}
+
+void DelayedTaskWheel::Advance() {
+  FML_DCHECK(near_tasks_.empty());
+  while (near_tasks_.empty()) {
+    bool found = false;
+    for (size_t level = 0; level < kLevelCount && !found; level++) {
+      const size_t cursor_slot =
+          (cursor_tick_ >> (kSlotBits * level)) & (kSlotCount - 1);
+      const size_t slot =
+          FindOccupiedSlotAfter(occupied_slots_[level], cursor_slot);
+      if (slot == kSlotCount) {
+        continue;
+      }
+      found = true;
+
+      // Move the cursor to the start of the slot.
+      const size_t span_bits = kSlotBits * (level + 1);
+      cursor_tick_ = ((cursor_tick_ >> span_bits) << span_bits) |
+                     (static_cast<uint64_t>(slot) << (kSlotBits * level));
+
+      std::vector<DelayedTask> tasks;
+      std::swap(tasks, slots_[level][slot]);
+      occupied_slots_[level] &= ~(uint64_t{1} << slot);
+
+      if (level == 0) {
+        // All tasks in a first level slot are due in the same millisecond.
+        near_tasks_.PushAll(std::move(tasks));
+      } else {
+        // Cascade the tasks into the finer levels.
+        for (auto& task : tasks) {
+          Place(std::move(task));
+        }
+      }
+    }
+    if (found) {
+      continue;
+    }
+
+    // The wheel is empty. Restart it at the earliest overflowing task and
+    // pull in all the overflowing tasks it can now represent.
+    FML_DCHECK(!overflow_tasks_.empty());
+    cursor_tick_ = GetTick(overflow_tasks_.top().GetTargetTime());
+    while (!overflow_tasks_.empty() &&
+           ((GetTick(overflow_tasks_.top().GetTargetTime()) ^ cursor_tick_) >>
+            (kSlotBits * kLevelCount)) == 0) {
+      Place(overflow_tasks_.Take());
+    }
+  }
+}
+
+const DelayedTask& DelayedTaskWheel::Top() const {
+  FML_DCHECK(!IsEmpty());
+  if (immediate_tasks_.empty()) {
+    return near_tasks_.top();
+  }
+  if (near_tasks_.empty()) {
+    return immediate_tasks_.front();
+  }
+  const auto& immediate_top = immediate_tasks_.front();
+  const auto& near_top = near_tasks_.top();
+  return immediate_top > near_top ? near_top : immediate_top;
+}
+
+DelayedTask DelayedTaskWheel::Take() {
+  FML_DCHECK(!IsEmpty());
+  size_--;
+  if (!immediate_tasks_.empty() &&
+      (near_tasks_.empty() || near_tasks_.top() > immediate_tasks_.front())) {
+    DelayedTask task = std::move(immediate_tasks_.front());
+    immediate_tasks_.pop_front();
+    return task;
+  }
+  DelayedTask task = near_tasks_.Take();
+  if (near_tasks_.empty() && size_ > immediate_tasks_.size()) {
+    Advance();
+  }
+  return task;
+}
+
+size_t DelayedTaskWheel::GetSize() const {
+  return size_;
+}
+
+bool DelayedTaskWheel::IsEmpty() const {
+  return size_ == 0;
+}
+
+void DelayedTaskWheel::Clear() {
+  immediate_tasks_.clear();
+  near_tasks_ = {};
+  for (auto& level : slots_) {
+    for (auto& slot : level) {
+      slot.clear();
+    }
+  }
+  occupied_slots_ = {};
+  overflow_tasks_ = {};
+  cursor_tick_ = 0;
+  size_ = 0;
+}
+
+}  // namespace fml
@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_DELAYED_TASK_WHEEL_H_
+#define FLUTTER_FML_DELAYED_TASK_WHEEL_H_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "flutter/fml/delayed_task.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace fml {
+
+//------------------------------------------------------------------------------
+/// @brief      A collection of `DelayedTask`s that yields them in the same
+///             order as a `DelayedTaskQueue`, i.e., by target time and then by
+///             the order in which they were posted, but in amortized constant
+///             time for most workloads.
+///
+///             Tasks whose target time has already passed when they are pushed
+///             and that don't need to jump ahead of other such tasks are kept
+///             in a FIFO. This is the common case of tasks posted via
+///             `TaskRunner::PostTask`.
+///
+///             All other tasks are kept in a hierarchical timing wheel with
+///             `kLevelCount` levels of `kSlotCount` slots each. The slots of
+///             the first level are a millisecond wide and each level is
+///             `kSlotCount` times coarser than the one before it. Tasks further
+///             out than the wheel can represent (about four and a half hours)
+///             are kept in an overflow heap. Only the tasks in the earliest
+///             occupied millisecond are kept in a small heap so that tasks due
+///             in the same millisecond are still ordered exactly.
+///
+class DelayedTaskWheel {
+ public:
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kSlotCount = 1u << kSlotBits;
+  static constexpr size_t kLevelCount = 4;
+
+  DelayedTaskWheel();
+
+  ~DelayedTaskWheel();
+
+  void Push(DelayedTask task);
+
+  void PushAll(std::vector<DelayedTask> tasks);
+
+  /// Returns the task with the earliest target time. Ties are broken by the
+  /// order in which the tasks were posted. The wheel must not be empty.
+  const DelayedTask& Top() const;
+
+  /// Removes the task returned by `Top` and returns it.
+  DelayedTask Take();
+
+  size_t GetSize() const;
+
+  bool IsEmpty() const;
+
+  /// Drops all pending tasks.
+  void Clear();
+
+ private:
+  // Tasks whose target time had passed when they were pushed. Sorted.
+  std::deque<DelayedTask> immediate_tasks_;
+  // Tasks at or before |cursor_tick_|. Only empty when the wheel and the
+  // overflow heap are also empty.
+  DelayedTaskQueue near_tasks_;
+  // Tasks after |cursor_tick_| by how far out they are.
+  std::array<std::array<std::vector<DelayedTask>, kSlotCount>, kLevelCount>
+      slots_;
+  // A bit per slot in |slots_| that is set when the slot is occupied.
+  std::array<uint64_t, kLevelCount> occupied_slots_ = {};
+  // Tasks too far out to be represented by the wheel.
+  DelayedTaskQueue overflow_tasks_;
+  uint64_t cursor_tick_ = 0;
+  size_t size_ = 0;
+
+  bool IsImmediate(const DelayedTask& task, fml::TimePoint now) const;
+
+  void PushDelayed(DelayedTask task);
+
+  void Place(DelayedTask task);
+
+  void Advance();
+
+  static uint64_t GetTick(fml::TimePoint time);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTaskWheel);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_DELAYED_TASK_WHEEL_H_
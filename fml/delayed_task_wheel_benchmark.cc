@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/delayed_task_wheel.h"
+
+#include <cassert>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/delayed_task.h"
+
+namespace fml {
+namespace benchmarking {
+
+namespace {
+
+constexpr size_t kImmediateTasksPerDelayedTask = 16;
+
+void Push(DelayedTaskQueue& queue, DelayedTask task) {
+  queue.push(std::move(task));
+}
+
+void Push(DelayedTaskWheel& wheel, DelayedTask task) {
+  wheel.Push(std::move(task));
+}
+
+DelayedTask Take(DelayedTaskQueue& queue) {
+  return queue.Take();
+}
+
+DelayedTask Take(DelayedTaskWheel& wheel) {
+  return wheel.Take();
+}
+
+}  // namespace
+
+// Keeps the benchmark argument number of delayed tasks (timers a second or more
+// out) pending while repeatedly registering and running batches of immediate
+// tasks, with one delayed task replacing the earliest one every batch. This is
+// what the platform and UI task queues typically look like.
+template <class Queue>
+static void MixedImmediateAndDelayedTasks(benchmark::State& state) {
+  Queue queue;
+  size_t order = 0;
+  const auto now = fml::TimePoint::Now();
+  const auto delayed_target_time = [&order, now]() {
+    return now + fml::TimeDelta::FromMilliseconds(1000) +
+           fml::TimeDelta::FromMicroseconds(order * 100);
+  };
+
+  for (int64_t i = 0; i < state.range(0); i++) {
+    Push(queue, DelayedTask(order, [] {}, delayed_target_time(),
+                            TaskSourceGrade::kUnspecified));
+    order++;
+  }
+
+  while (state.KeepRunning()) {
+    const auto target_time = fml::TimePoint::Now();
+    for (size_t i = 0; i < kImmediateTasksPerDelayedTask; i++) {
+      Push(queue, DelayedTask(order++, [] {}, target_time,
+                              TaskSourceGrade::kUnspecified));
+    }
+    Push(queue, DelayedTask(order, [] {}, delayed_target_time(),
+                            TaskSourceGrade::kUnspecified));
+    order++;
+    for (size_t i = 0; i < kImmediateTasksPerDelayedTask; i++) {
+      auto task = Take(queue);
+      assert(task.GetTargetTime() <= fml::TimePoint::Now());
+      benchmark::DoNotOptimize(task);
+    }
+    auto delayed_task = Take(queue);
+    assert(delayed_task.GetTargetTime() > fml::TimePoint::Now());
+    benchmark::DoNotOptimize(delayed_task);
+  }
+
+  state.SetItemsProcessed(
+      state.iterations() *
+      static_cast<int64_t>(kImmediateTasksPerDelayedTask + 1));
+}
+
+static void BM_MixedTasksOnDelayedTaskQueue(  // NOLINT
+    benchmark::State& state) {
+  MixedImmediateAndDelayedTasks<DelayedTaskQueue>(state);
+}
+
+static void BM_MixedTasksOnDelayedTaskWheel(  // NOLINT
+    benchmark::State& state) {
+  MixedImmediateAndDelayedTasks<DelayedTaskWheel>(state);
+}
+
+BENCHMARK(BM_MixedTasksOnDelayedTaskQueue)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_MixedTasksOnDelayedTaskWheel)->RangeMultiplier(8)->Range(8, 4096);
+
+}  // namespace benchmarking
+}  // namespace fml
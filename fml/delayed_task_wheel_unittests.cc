@@ -0,0 +1,161 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/fml/delayed_task_wheel.h"
+
+#include <random>
+#include <vector>
+
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+namespace {
+
+// The last order run by a task created by |CreateTask|.
+size_t last_run_order = 0;
+
+DelayedTask CreateTask(size_t order, fml::TimePoint target_time) {
+  return DelayedTask(
+      order, [order] { last_run_order = order; }, target_time,
+      TaskSourceGrade::kUnspecified);
+}
+
+size_t RunOrder(const DelayedTask& task) {
+  task.GetTask()();
+  return last_run_order;
+}
+
+std::vector<size_t> Drain(DelayedTaskWheel& wheel) {
+  std::vector<size_t> orders;
+  while (!wheel.IsEmpty()) {
+    const size_t top_order = RunOrder(wheel.Top());
+    auto task = wheel.Take();
+    EXPECT_EQ(RunOrder(task), top_order);
+    orders.push_back(top_order);
+  }
+  return orders;
+}
+
+}  // namespace
+
+TEST(DelayedTaskWheelTest, ImmediateTasksAreFIFO) {
+  DelayedTaskWheel wheel;
+  const auto now = fml::TimePoint::Now();
+  for (size_t i = 0; i < 10; i++) {
+    wheel.Push(CreateTask(i, now));
+  }
+  ASSERT_EQ(wheel.GetSize(), 10u);
+  ASSERT_EQ(Drain(wheel),
+            (std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(DelayedTaskWheelTest, ImmediateTasksPostedOutOfOrderAreSorted) {
+  DelayedTaskWheel wheel;
+  const auto now = fml::TimePoint::Now();
+  const auto earlier = now - fml::TimeDelta::FromMilliseconds(5);
+  wheel.Push(CreateTask(0, now));
+  // Sampled the clock before the task above but was registered after it.
+  wheel.Push(CreateTask(1, earlier));
+  wheel.Push(CreateTask(2, now));
+  ASSERT_EQ(Drain(wheel), (std::vector<size_t>{1, 0, 2}));
+}
+
+TEST(DelayedTaskWheelTest, DelayedTasksRunAfterImmediateTasks) {
+  DelayedTaskWheel wheel;
+  const auto now = fml::TimePoint::Now();
+  wheel.Push(CreateTask(0, now + fml::TimeDelta::FromMilliseconds(3)));
+  wheel.Push(CreateTask(1, now));
+  wheel.Push(CreateTask(2, now + fml::TimeDelta::FromMilliseconds(1)));
+  wheel.Push(CreateTask(3, now));
+  ASSERT_EQ(Drain(wheel), (std::vector<size_t>{1, 3, 2, 0}));
+}
+
+TEST(DelayedTaskWheelTest, TasksInTheSameMillisecondAreOrdered) {
+  DelayedTaskWheel wheel;
+  const auto later = fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(1);
+  wheel.Push(CreateTask(0, later + fml::TimeDelta::FromMicroseconds(300)));
+  wheel.Push(CreateTask(1, later + fml::TimeDelta::FromMicroseconds(100)));
+  wheel.Push(CreateTask(2, later + fml::TimeDelta::FromMicroseconds(100)));
+  wheel.Push(CreateTask(3, later + fml::TimeDelta::FromMicroseconds(200)));
+  ASSERT_EQ(Drain(wheel), (std::vector<size_t>{1, 2, 3, 0}));
+}
+
+TEST(DelayedTaskWheelTest, TasksBeyondTheWheelAreOrdered) {
+  DelayedTaskWheel wheel;
+  const auto now = fml::TimePoint::Now();
+  wheel.Push(CreateTask(0, fml::TimePoint::Max()));
+  wheel.Push(CreateTask(1, now + fml::TimeDelta::FromSeconds(48 * 3600)));
+  wheel.Push(CreateTask(2, now + fml::TimeDelta::FromSeconds(24 * 3600)));
+  wheel.Push(CreateTask(3, now + fml::TimeDelta::FromMilliseconds(1)));
+  wheel.Push(CreateTask(4, now + fml::TimeDelta::FromSeconds(24 * 3600)));
+  ASSERT_EQ(Drain(wheel), (std::vector<size_t>{3, 2, 4, 1, 0}));
+}
+
+TEST(DelayedTaskWheelTest, ClearDropsAllTasks) {
+  DelayedTaskWheel wheel;
+  const auto now = fml::TimePoint::Now();
+  wheel.Push(CreateTask(0, now));
+  wheel.Push(CreateTask(1, now + fml::TimeDelta::FromSeconds(10)));
+  wheel.Push(CreateTask(2, fml::TimePoint::Max()));
+  wheel.Clear();
+  ASSERT_TRUE(wheel.IsEmpty());
+  wheel.Push(CreateTask(3, now + fml::TimeDelta::FromSeconds(1)));
+  ASSERT_EQ(Drain(wheel), (std::vector<size_t>{3}));
+}
+
+// Interleaves pushes and takes of tasks spread across all levels of the wheel
+// and checks that they come out in the same order as from a plain heap.
+TEST(DelayedTaskWheelTest, MatchesDelayedTaskQueueOrdering) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int64_t> exponent(0, 44);
+  std::uniform_int_distribution<int> action(0, 2);
+  const auto now = fml::TimePoint::Now();
+
+  DelayedTaskWheel wheel;
+  DelayedTaskQueue reference;
+  size_t order = 0;
+  for (size_t i = 0; i < 20000; i++) {
+    if (action(generator) == 0 && !reference.empty()) {
+      ASSERT_EQ(wheel.GetSize(), reference.size());
+      ASSERT_EQ(RunOrder(wheel.Top()), RunOrder(reference.top()));
+      ASSERT_EQ(RunOrder(wheel.Take()), RunOrder(reference.Take()));
+      continue;
+    }
+    // Target times from the past up to days out, biased towards soon.
+    const int64_t offset = std::uniform_int_distribution<int64_t>(
+        0, int64_t{1} << exponent(generator))(generator);
+    const auto target_time =
+        now + fml::TimeDelta::FromNanoseconds(offset) -
+        fml::TimeDelta::FromMilliseconds(10);
+    if (action(generator) == 0) {
+      std::vector<DelayedTask> tasks;
+      std::vector<DelayedTask> reference_tasks;
+      for (size_t j = 0; j < 3; j++) {
+        tasks.push_back(CreateTask(order, target_time));
+        reference_tasks.push_back(CreateTask(order, target_time));
+        order++;
+      }
+      wheel.PushAll(std::move(tasks));
+      reference.PushAll(std::move(reference_tasks));
+    } else {
+      wheel.Push(CreateTask(order, target_time));
+      reference.push(CreateTask(order, target_time));
+      order++;
+    }
+  }
+
+  while (!reference.empty()) {
+    ASSERT_EQ(RunOrder(wheel.Take()), RunOrder(reference.Take()));
+  }
+  ASSERT_TRUE(wheel.IsEmpty());
+}
+
+}  // namespace testing
+}  // namespace fml
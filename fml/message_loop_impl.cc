@@ -54,16 +54,27 @@ MessageLoopImpl::~MessageLoopImpl() {
   task_queue_->Dispose(queue_id_);
 }
 
-void MessageLoopImpl::PostTask(const fml::closure& task,
+void MessageLoopImpl::PostTask(fml::UniqueClosure task,
                                fml::TimePoint target_time) {
   FML_DCHECK(task != nullptr);
-  FML_DCHECK(task != nullptr);
   if (terminated_) {
     // If the message loop has already been terminated, PostTask should destruct
     // |task| synchronously within this function.
     return;
   }
-  task_queue_->RegisterTask(queue_id_, task, target_time);
+  task_queue_->RegisterTask(queue_id_, std::move(task), target_time);
+}
+
+void MessageLoopImpl::PostTasks(std::vector<fml::UniqueClosure> tasks,
+                                fml::TimePoint target_time) {
+  FML_DCHECK(std::none_of(tasks.begin(), tasks.end(),
+                          [](const auto& task) { return task == nullptr; }));
+  if (terminated_) {
+    // If the message loop has already been terminated, PostTasks should
+    // destruct |tasks| synchronously within this function.
+    return;
+  }
+  task_queue_->RegisterTasks(queue_id_, std::move(tasks), target_time);
 }
 
 void MessageLoopImpl::AddTaskObserver(intptr_t key,
@@ -121,7 +132,7 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
 
   const auto now = fml::TimePoint::Now();
-  fml::closure invocation;
+  fml::UniqueClosure invocation;
   do {
     invocation = task_queue_->GetNextTaskToRun(queue_id_, now);
     if (!invocation) {
@@ -45,6 +45,11 @@ class TaskQueueEntry {
 
   TaskQueueId created_for;
 
+  /// Guards the tasks, observers and wakeable of this TaskQueue and, while
+  /// this TaskQueue owns others, those of every TaskQueue it subsumes. The
+  /// mutex of a subsumed TaskQueue is unused till it is unmerged.
+  std::mutex tasks_mutex;
+
   explicit TaskQueueEntry(TaskQueueId created_for);
 
  private:
@@ -60,6 +65,18 @@ enum class FlushType {
 /// fml::MessageLoops.
 ///
 /// This also wakes up the loop at the required times.
+///
+/// Locking is split in two levels so that unrelated message loops (for
+/// instance, the threads of different engines in the same process) don't
+/// contend on each other:
+///  1. The topology of the queues, i.e., the set of queues and how they are
+///     merged, is guarded by a reader/writer lock. Only creating, disposing,
+///     merging and unmerging queues acquire it exclusively. Everything else
+///     acquires it shared.
+///  2. The contents of each group of merged queues are guarded by the
+///     `TaskQueueEntry::tasks_mutex` of the group owner. Because the topology
+///     can't change while the shared lock is held, the owner of a group is
+///     stable for the duration of any operation on its contents.
 /// \see fml::MessageLoop
 /// \see fml::Wakeable
 class MessageLoopTaskQueues
@@ -78,14 +95,24 @@ class MessageLoopTaskQueues
   // Tasks methods.
 
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
+                    fml::UniqueClosure task,
                     fml::TimePoint target_time,
                     fml::TaskSourceGrade task_source_grade =
                         fml::TaskSourceGrade::kUnspecified);
 
+  /// Registers all the tasks for the same target time. This is equivalent to
+  /// calling \p RegisterTask for each task in order but the queue is locked
+  /// and its loop woken up just once.
+  void RegisterTasks(TaskQueueId queue_id,
+                     std::vector<fml::UniqueClosure> tasks,
+                     fml::TimePoint target_time,
+                     fml::TaskSourceGrade task_source_grade =
+                         fml::TaskSourceGrade::kUnspecified);
+
   bool HasPendingTasks(TaskQueueId queue_id) const;
 
-  fml::closure GetNextTaskToRun(TaskQueueId queue_id, fml::TimePoint from_time);
+  fml::UniqueClosure GetNextTaskToRun(TaskQueueId queue_id,
+                                      fml::TimePoint from_time);
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
@@ -146,6 +173,8 @@ class MessageLoopTaskQueues
 
   void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
 
+  std::mutex& GetTasksMutexUnlocked(TaskQueueId queue_id) const;
+
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
   TaskSource::TopTask PeekNextTaskUnlocked(TaskQueueId owner) const;
@@ -155,7 +184,7 @@ class MessageLoopTaskQueues
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
+  std::unique_ptr<fml::SharedMutex> topology_mutex_;
   std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
 
   size_t task_queue_id_counter_;
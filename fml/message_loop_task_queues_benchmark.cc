@@ -5,26 +5,33 @@
 #include "flutter/fml/message_loop_task_queues.h"
 
 #include <cassert>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/wakeable.h"
 
 namespace fml {
 namespace benchmarking {
 
+// Each thread registers and drains tasks on its own task queue. The number of
+// threads is the benchmark argument. Since the threads never share a task
+// queue, they should only contend on the task queues bookkeeping itself.
 static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
+  const int num_task_queues = static_cast<int>(state.range(0));
+  const int num_tasks_per_queue = 100;
+
   while (state.KeepRunning()) {
     auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
 
-    const int num_task_queues = 10;
-    const int num_tasks_per_queue = 100;
     const fml::TimePoint past = fml::TimePoint::Now();
 
+    std::vector<TaskQueueId> task_queue_ids;
     for (int i = 0; i < num_task_queues; i++) {
-      task_queue->CreateTaskQueue();
+      task_queue_ids.emplace_back(task_queue->CreateTaskQueue());
     }
 
     std::vector<std::thread> threads;
@@ -33,19 +40,19 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
     CountDownLatch tasks_done(num_task_queues);
 
     for (int i = 0; i < num_task_queues; i++) {
-      threads.emplace_back([task_runner_id = i, &task_queue, past, &tasks_done,
-                            &tasks_registered]() {
+      threads.emplace_back([task_queue_id = task_queue_ids[i], &task_queue,
+                            past, &tasks_done, &tasks_registered]() {
         for (int j = 0; j < num_tasks_per_queue; j++) {
           task_queue->RegisterTask(
-              TaskQueueId(task_runner_id), [] {}, past);
+              task_queue_id, [] {}, past);
         }
         tasks_registered.CountDown();
         tasks_registered.Wait();
         const auto now = fml::TimePoint::Now();
         int num_invocations = 0;
         for (;;) {
-          fml::closure invocation =
-              task_queue->GetNextTaskToRun(TaskQueueId(task_runner_id), now);
+          fml::UniqueClosure invocation =
+              task_queue->GetNextTaskToRun(task_queue_id, now);
           if (!invocation) {
             break;
           }
@@ -61,10 +68,119 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
     for (auto& thread : threads) {
       thread.join();
     }
+
+    for (const auto& task_queue_id : task_queue_ids) {
+      task_queue->Dispose(task_queue_id);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_task_queues *
+                          num_tasks_per_queue);
+}
+
+BENCHMARK(BM_RegisterAndGetTasks)->RangeMultiplier(2)->Range(1, 16);
+
+namespace {
+
+class NoopWakeable : public fml::Wakeable {
+ public:
+  void WakeUp(fml::TimePoint time_point) override {}
+};
+
+}  // namespace
+
+// Registers the benchmark argument number of tasks on a single task queue, one
+// at a time or as a batch, and then drains them.
+static void RegisterAndDrainTasks(benchmark::State& state, bool batched) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto task_queue_id = task_queue->CreateTaskQueue();
+  NoopWakeable wakeable;
+  task_queue->SetWakeable(task_queue_id, &wakeable);
+  const size_t num_tasks = static_cast<size_t>(state.range(0));
+
+  while (state.KeepRunning()) {
+    const fml::TimePoint now = fml::TimePoint::Now();
+    if (batched) {
+      std::vector<fml::UniqueClosure> tasks;
+      tasks.reserve(num_tasks);
+      for (size_t i = 0; i < num_tasks; i++) {
+        tasks.emplace_back([] {});
+      }
+      task_queue->RegisterTasks(task_queue_id, std::move(tasks), now);
+    } else {
+      for (size_t i = 0; i < num_tasks; i++) {
+        task_queue->RegisterTask(
+            task_queue_id, [] {}, now);
+      }
+    }
+    while (task_queue->GetNextTaskToRun(task_queue_id, now)) {
+    }
+  }
+
+  task_queue->Dispose(task_queue_id);
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+static void BM_RegisterTasksIndividually(benchmark::State& state) {  // NOLINT
+  RegisterAndDrainTasks(state, false);
+}
+
+static void BM_RegisterTasksBatched(benchmark::State& state) {  // NOLINT
+  RegisterAndDrainTasks(state, true);
+}
+
+BENCHMARK(BM_RegisterTasksIndividually)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_RegisterTasksBatched)->RangeMultiplier(4)->Range(4, 1024);
+
+// Registers and drains tasks shaped like the ones typically posted by the
+// engine, i.e., lambdas capturing a weak pointer and a few values. When
+// |type_erase_first| is true, each task is first converted to an
+// |fml::closure| which heap allocates for captures of this size. Otherwise it
+// is stored inline in the |fml::UniqueClosure| the task queues hold.
+static void RegisterAndDrainTypicalTasks(benchmark::State& state,
+                                         bool type_erase_first) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto task_queue_id = task_queue->CreateTaskQueue();
+  auto shared = std::make_shared<int>(0);
+  std::weak_ptr<int> weak = shared;
+  const int64_t a = 1, b = 2, c = 3;
+  constexpr size_t kNumTasks = 100;
+
+  while (state.KeepRunning()) {
+    const fml::TimePoint now = fml::TimePoint::Now();
+    for (size_t i = 0; i < kNumTasks; i++) {
+      auto task = [weak, a, b, c]() {
+        if (auto strong = weak.lock()) {
+          *strong += a + b + c;
+        }
+      };
+      if (type_erase_first) {
+        task_queue->RegisterTask(task_queue_id, fml::closure(task), now);
+      } else {
+        task_queue->RegisterTask(task_queue_id, task, now);
+      }
+    }
+    while (auto invocation = task_queue->GetNextTaskToRun(task_queue_id, now)) {
+      invocation();
+    }
   }
+
+  task_queue->Dispose(task_queue_id);
+  state.SetItemsProcessed(state.iterations() * kNumTasks);
+}
+
+static void BM_RegisterTypicalTasksAsClosure(  // NOLINT
+    benchmark::State& state) {
+  RegisterAndDrainTypicalTasks(state, true);
+}
+
+static void BM_RegisterTypicalTasksAsUniqueClosure(  // NOLINT
+    benchmark::State& state) {
+  RegisterAndDrainTypicalTasks(state, false);
 }
 
-BENCHMARK(BM_RegisterAndGetTasks);
+BENCHMARK(BM_RegisterTypicalTasksAsClosure);
+BENCHMARK(BM_RegisterTypicalTasksAsUniqueClosure);
 
 }  // namespace benchmarking
 }  // namespace fml
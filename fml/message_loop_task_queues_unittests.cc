@@ -7,6 +7,7 @@
 #include "flutter/fml/message_loop_task_queues.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <thread>
 
@@ -108,7 +109,7 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   const auto now = ChronoTicksSinceEpoch();
   int expected_value = 1;
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(queue_id, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(queue_id, now);
     if (!invocation) {
       break;
     }
@@ -148,7 +149,8 @@ TEST(MessageLoopTaskQueue, RegisterTasksOnMergedQueuesPreserveTaskOrdering) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster2_queue
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     if (!invocation) {
       break;
     }
@@ -191,7 +193,8 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster_queue (running on platform)
   for (int i = 0; i < 3; i++) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == i);
@@ -210,7 +213,8 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // platform_queue has 1 task left: "test_val = 4"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(platform_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 4);
@@ -220,14 +224,16 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // raster_queue has 2 tasks left: "test_val = 3" and "test_val = 5"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 2);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 3);
   }
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 5);
@@ -244,6 +250,31 @@ void TestNotifyObservers(fml::TaskQueueId queue_id) {
   }
 }
 
+TEST(MessageLoopTaskQueue, RegisterTasksWakesUpOnceAndPreservesOrdering) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+
+  int num_wakes = 0;
+  task_queue->SetWakeable(
+      queue_id, new TestWakeable(
+                    [&num_wakes](fml::TimePoint wake_time) { num_wakes++; }));
+
+  std::vector<int> values;
+  std::vector<fml::UniqueClosure> tasks;
+  for (int i = 0; i < 10; i++) {
+    tasks.emplace_back([&values, i]() { values.push_back(i); });
+  }
+  const auto now = ChronoTicksSinceEpoch();
+  task_queue->RegisterTasks(queue_id, std::move(tasks), now);
+  ASSERT_EQ(num_wakes, 1);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 10u);
+
+  while (auto invocation = task_queue->GetNextTaskToRun(queue_id, now)) {
+    invocation();
+  }
+  ASSERT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
 TEST(MessageLoopTaskQueue, AddRemoveNotifyObservers) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   auto queue_id = task_queue->CreateTaskQueue();
@@ -411,6 +442,48 @@ TEST(MessageLoopTaskQueue, ConcurrentQueueAndTaskCreatingCounts) {
   ASSERT_EQ(pending_tasks, kThreadCount * kThreadTaskCount);
 }
 
+//------------------------------------------------------------------------------
+/// Verifies that tasks can be registered on and drained from task queues while
+/// they are concurrently being merged and unmerged.
+///
+TEST(MessageLoopTaskQueue, ConcurrentRegisterWhileMergingAndUnmerging) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  auto platform_queue = task_queues->CreateTaskQueue();
+  auto raster_queue = task_queues->CreateTaskQueue();
+
+  constexpr size_t kTaskCount = 1000;
+  std::atomic_size_t tasks_run = 0;
+
+  std::thread merger([&]() {
+    for (size_t i = 0; i < kTaskCount; i++) {
+      task_queues->Merge(platform_queue, raster_queue);
+      task_queues->Unmerge(platform_queue, raster_queue);
+    }
+  });
+
+  std::thread poster([&]() {
+    for (size_t i = 0; i < kTaskCount; i++) {
+      task_queues->RegisterTask(
+          i % 2 ? platform_queue : raster_queue,
+          [&tasks_run]() { tasks_run++; }, ChronoTicksSinceEpoch());
+    }
+  });
+
+  merger.join();
+  poster.join();
+
+  for (auto queue_id : {platform_queue, raster_queue}) {
+    const auto now = ChronoTicksSinceEpoch();
+    while (auto invocation = task_queues->GetNextTaskToRun(queue_id, now)) {
+      invocation();
+    }
+  }
+
+  ASSERT_EQ(tasks_run, kTaskCount);
+  ASSERT_FALSE(task_queues->HasPendingTasks(platform_queue));
+  ASSERT_FALSE(task_queues->HasPendingTasks(raster_queue));
+}
+
 TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   auto platform_queue = task_queue->CreateTaskQueue();
@@ -6,11 +6,13 @@
 
 #include "flutter/fml/message_loop.h"
 
+#include <atomic>
 #include <iostream>
 #include <thread>
 
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/message_loop_impl.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/task_runner.h"
@@ -139,6 +141,72 @@ TEST(MessageLoop, DelayedTasksAtSameTimeAreRunInOrder) {
   ASSERT_TRUE(terminated);
 }
 
+TEST(MessageLoop, BatchedTasksAreRunInOrder) {
+  const size_t count = 100;
+  bool started = false;
+  bool terminated = false;
+  std::thread thread([&started, &terminated, count]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    size_t current = 0;
+    std::vector<fml::UniqueClosure> tasks;
+    for (size_t i = 0; i < count; i++) {
+      tasks.push_back(PLATFORM_SPECIFIC_CAPTURE(&terminated, i, &current)() {
+        ASSERT_EQ(current, i);
+        current++;
+        if (count == i + 1) {
+          fml::MessageLoop::GetCurrent().Terminate();
+          terminated = true;
+        }
+      });
+    }
+    loop.GetTaskRunner()->PostTasks(std::move(tasks));
+    loop.Run();
+    ASSERT_EQ(current, count);
+    started = true;
+  });
+  thread.join();
+  ASSERT_TRUE(started);
+  ASSERT_TRUE(terminated);
+}
+
+namespace {
+
+// A task runner without a message loop, like those that forward tasks to the
+// event loop of an embedder.
+class ForwardingTaskRunner : public fml::TaskRunner {
+ public:
+  ForwardingTaskRunner() : fml::TaskRunner(nullptr) {}
+
+  void PostTaskForTime(fml::UniqueClosure task,
+                       fml::TimePoint target_time) override {
+    tasks.push_back(std::move(task));
+    target_times.push_back(target_time);
+  }
+
+  std::vector<fml::UniqueClosure> tasks;
+  std::vector<fml::TimePoint> target_times;
+};
+
+}  // namespace
+
+TEST(MessageLoop, BatchedTasksAreForwardedWithoutALoop) {
+  auto task_runner = fml::MakeRefCounted<ForwardingTaskRunner>();
+  std::vector<int> runs;
+  const auto target_time =
+      fml::TimePoint::Now() + fml::TimeDelta::FromMilliseconds(2);
+  std::vector<fml::UniqueClosure> tasks;
+  tasks.emplace_back([&runs]() { runs.push_back(1); });
+  tasks.emplace_back([&runs]() { runs.push_back(2); });
+  task_runner->PostTasksForTime(std::move(tasks), target_time);
+  ASSERT_EQ(task_runner->tasks.size(), 2u);
+  for (size_t i = 0; i < task_runner->tasks.size(); i++) {
+    ASSERT_EQ(task_runner->target_times[i], target_time);
+    task_runner->tasks[i]();
+  }
+  ASSERT_EQ(runs, std::vector<int>({1, 2}));
+}
+
 TEST(MessageLoop, CheckRunsTaskOnCurrentThread) {
   fml::RefPtr<fml::TaskRunner> runner;
   fml::AutoResetWaitableEvent latch;
@@ -298,6 +366,14 @@ TEST(MessageLoop, CanCreateAndShutdownConcurrentMessageLoopsOverAndOver) {
   }
 }
 
+TEST(MessageLoop, ConcurrentTaskRunnerReportsWorkerCountOfLiveLoop) {
+  auto loop = fml::ConcurrentMessageLoop::Create(3u);
+  auto task_runner = loop->GetTaskRunner();
+  ASSERT_EQ(task_runner->GetWorkerCount(), 3u);
+  loop.reset();
+  ASSERT_EQ(task_runner->GetWorkerCount(), 0u);
+}
+
 TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   auto loop = fml::ConcurrentMessageLoop::Create();
   auto task_runner = loop->GetTaskRunner();
@@ -317,3 +393,78 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, ConcurrentMessageLoopServicesHigherPriorityFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+
+  // Keep the only worker busy till all tasks have been posted.
+  fml::AutoResetWaitableEvent started;
+  fml::AutoResetWaitableEvent unblock;
+  task_runner->PostTask([&started, &unblock]() {
+    started.Signal();
+    unblock.Wait();
+  });
+  started.Wait();
+
+  std::mutex order_mutex;
+  std::vector<fml::ConcurrentTaskPriority> order;
+  fml::CountDownLatch latch(3);
+  auto post = [&](fml::ConcurrentTaskPriority priority) {
+    task_runner->PostTask(
+        [&, priority]() {
+          std::scoped_lock lock(order_mutex);
+          order.push_back(priority);
+          latch.CountDown();
+        },
+        priority);
+  };
+  post(fml::ConcurrentTaskPriority::kBackground);
+  post(fml::ConcurrentTaskPriority::kDefault);
+  post(fml::ConcurrentTaskPriority::kUserBlocking);
+  unblock.Signal();
+  latch.Wait();
+
+  ASSERT_EQ(order.size(), 3u);
+  ASSERT_EQ(order[0], fml::ConcurrentTaskPriority::kUserBlocking);
+  ASSERT_EQ(order[1], fml::ConcurrentTaskPriority::kDefault);
+  ASSERT_EQ(order[2], fml::ConcurrentTaskPriority::kBackground);
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopDoesNotStarveLowerPriorities) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+
+  fml::AutoResetWaitableEvent started;
+  fml::AutoResetWaitableEvent unblock;
+  task_runner->PostTask([&started, &unblock]() {
+    started.Signal();
+    unblock.Wait();
+  });
+  started.Wait();
+
+  const size_t kUserBlockingCount =
+      fml::ConcurrentMessageLoop::kMaxStarvedDequeues * 2;
+  std::atomic_size_t user_blocking_ran = 0;
+  size_t user_blocking_ran_before_background = 0;
+  fml::CountDownLatch latch(kUserBlockingCount + 1);
+  task_runner->PostTask(
+      [&]() {
+        user_blocking_ran_before_background = user_blocking_ran;
+        latch.CountDown();
+      },
+      fml::ConcurrentTaskPriority::kBackground);
+  for (size_t i = 0; i < kUserBlockingCount; ++i) {
+    task_runner->PostTask(
+        [&]() {
+          user_blocking_ran++;
+          latch.CountDown();
+        },
+        fml::ConcurrentTaskPriority::kUserBlocking);
+  }
+  unblock.Signal();
+  latch.Wait();
+
+  ASSERT_EQ(user_blocking_ran_before_background,
+            fml::ConcurrentMessageLoop::kMaxStarvedDequeues);
+}
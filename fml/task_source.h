@@ -6,6 +6,7 @@
 #define FLUTTER_FML_TASK_SOURCE_H_
 
 #include "flutter/fml/delayed_task.h"
+#include "flutter/fml/delayed_task_wheel.h"
 #include "flutter/fml/task_queue_id.h"
 #include "flutter/fml/task_source_grade.h"
 
@@ -49,10 +50,16 @@ class TaskSource {
 
   /// Adds a task to the corresponding task heap as dictated by the
   /// `TaskSourceGrade` of the `DelayedTask`.
-  void RegisterTask(const DelayedTask& task);
+  void RegisterTask(DelayedTask task);
 
-  /// Pops the task heap corresponding to the `TaskSourceGrade`.
-  void PopTask(TaskSourceGrade grade);
+  /// Adds the tasks to the corresponding task heaps as dictated by the
+  /// `TaskSourceGrade` of each `DelayedTask`. Each heap is updated at most
+  /// once.
+  void RegisterTasks(std::vector<DelayedTask> tasks);
+
+  /// Pops the task heap corresponding to the `TaskSourceGrade` and returns the
+  /// popped task.
+  DelayedTask PopTask(TaskSourceGrade grade);
 
   /// Returns the number of pending tasks. Excludes the tasks from the secondary
   /// heap if it's paused.
@@ -73,8 +80,8 @@ class TaskSource {
 
  private:
   const fml::TaskQueueId task_queue_id_;
-  fml::DelayedTaskQueue primary_task_queue_;
-  fml::DelayedTaskQueue secondary_task_queue_;
+  fml::DelayedTaskWheel primary_task_queue_;
+  fml::DelayedTaskWheel secondary_task_queue_;
   int secondary_pause_requests_ = 0;
 
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(TaskSource);
@@ -4,6 +4,7 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_source.h"
@@ -50,6 +51,40 @@ TEST(TaskSourceTests, SimpleOrdering) {
   ASSERT_EQ(value, 7);
 }
 
+TEST(TaskSourceTests, RegisterTasksPreservesOrdering) {
+  TaskSource task_source = TaskSource(TaskQueueId(1));
+  auto now = ChronoTicksSinceEpoch();
+  auto later = now + fml::TimeDelta::FromMilliseconds(1);
+  std::vector<size_t> values;
+  auto task = [&values](size_t order, fml::TimePoint target_time) {
+    return DelayedTask(
+        order, [&values, order] { values.push_back(order); }, target_time,
+        TaskSourceGrade::kUnspecified);
+  };
+
+  task_source.RegisterTask(task(3, later));
+
+  // More new tasks than pending ones rebuild the heap.
+  std::vector<DelayedTask> first_batch;
+  first_batch.push_back(task(5, later));
+  first_batch.push_back(task(0, now));
+  first_batch.push_back(task(1, now));
+  first_batch.push_back(task(2, now));
+  task_source.RegisterTasks(std::move(first_batch));
+
+  // Fewer new tasks than pending ones are sifted up individually.
+  std::vector<DelayedTask> second_batch;
+  second_batch.push_back(task(4, later));
+  task_source.RegisterTasks(std::move(second_batch));
+
+  ASSERT_EQ(task_source.GetNumPendingTasks(), 6u);
+  while (!task_source.IsEmpty()) {
+    task_source.Top().task.GetTask()();
+    task_source.PopTask(TaskSourceGrade::kUnspecified);
+  }
+  ASSERT_EQ(values, (std::vector<size_t>{0, 1, 2, 3, 4, 5}));
+}
+
 TEST(TaskSourceTests, SimpleOrderingMultiTaskHeaps) {
   TaskSource task_source = TaskSource(TaskQueueId(1));
   auto time_stamp = ChronoTicksSinceEpoch();
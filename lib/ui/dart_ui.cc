@@ -20,6 +20,7 @@
 #include "flutter/lib/ui/painting/image_filter.h"
 #include "flutter/lib/ui/painting/image_shader.h"
 #include "flutter/lib/ui/painting/immutable_buffer.h"
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
 #include "flutter/lib/ui/painting/path.h"
 #include "flutter/lib/ui/painting/path_measure.h"
 #include "flutter/lib/ui/painting/picture.h"
@@ -72,6 +73,7 @@ void DartUI::InitForGlobal() {
     ImageFilter::RegisterNatives(g_natives);
     ImageShader::RegisterNatives(g_natives);
     ImmutableBuffer::RegisterNatives(g_natives);
+    IncrementalImageDecoder::RegisterNatives(g_natives);
     IsolateNameServerNatives::RegisterNatives(g_natives);
     NativeStringAttribute::RegisterNatives(g_natives);
     Paragraph::RegisterNatives(g_natives);
@@ -1565,10 +1565,6 @@ class Paint {
 
 /// The format in which image bytes should be returned when using
 /// [Image.toByteData].
-// We do not expect to add more encoding formats to the ImageByteFormat enum,
-// considering the binary size of the engine after LTO optimization. You can
-// use the third-party pure dart image library to encode other formats.
-// See: https://github.com/flutter/flutter/issues/16635 for more details.
 enum ImageByteFormat {
   /// Raw RGBA format.
   ///
@@ -1602,6 +1598,82 @@ enum ImageByteFormat {
   ///  * <https://en.wikipedia.org/wiki/Portable_Network_Graphics>, the Wikipedia page on PNG.
   ///  * <https://tools.ietf.org/rfc/rfc2083.txt>, the PNG standard.
   png,
+
+  /// JPEG format.
+  ///
+  /// A lossy compression format for photographs. Transparency is not
+  /// supported; transparent pixels become black. The quality is set by
+  /// [ImageEncodingOptions.quality].
+  ///
+  /// JPEG images normally use the `.jpg` file extension and the `image/jpeg`
+  /// MIME type.
+  jpeg,
+
+  /// WebP format.
+  ///
+  /// A compression format that is lossy unless [ImageEncodingOptions.quality]
+  /// is 100, in which case it is loss-less. Transparency is supported.
+  ///
+  /// WebP images normally use the `.webp` file extension and the `image/webp`
+  /// MIME type.
+  webp,
+}
+
+/// The filter applied to each row of a PNG image before it is compressed.
+///
+/// Filters store each byte as the difference to a neighboring byte, which
+/// compresses better for images with smooth gradients.
+///
+/// See also:
+///
+///  * <https://www.w3.org/TR/PNG/#9Filters>, the filters of the PNG standard.
+enum PngFilter {
+  /// Bytes are stored unmodified. This is the fastest filter, and often the
+  /// best one for images with few colors, such as screenshots of text.
+  none,
+
+  /// Bytes are stored as the difference to the byte of the pixel on the left.
+  sub,
+
+  /// Bytes are stored as the difference to the byte of the pixel above.
+  up,
+
+  /// Bytes are stored as the difference to the average of the bytes of the
+  /// pixels on the left and above.
+  average,
+
+  /// Bytes are stored as the difference to the byte of the pixel on the left,
+  /// above or above and to the left, whichever is closest to a linear
+  /// prediction.
+  paeth,
+
+  /// Each row uses the filter that is likely to compress it best. This is the
+  /// slowest filter, but usually gives the smallest images.
+  adaptive,
+}
+
+/// Compression settings for [Image.toByteData].
+class ImageEncodingOptions {
+  /// Creates compression settings for [Image.toByteData].
+  const ImageEncodingOptions({
+    this.quality = 90,
+    this.compressionLevel = 6,
+    this.pngFilter = PngFilter.adaptive,
+  }) : assert(quality >= 0 && quality <= 100),
+       assert(compressionLevel >= 0 && compressionLevel <= 9);
+
+  /// The quality of [ImageByteFormat.jpeg] and [ImageByteFormat.webp] images,
+  /// from 0 to 100. Higher values give larger images with fewer artifacts.
+  final int quality;
+
+  /// The zlib compression level of [ImageByteFormat.png] images, from 0 to 9.
+  ///
+  /// Level 0 does not compress the image at all, level 1 is the fastest and
+  /// level 9 gives the smallest images.
+  final int compressionLevel;
+
+  /// The filter applied to the rows of [ImageByteFormat.png] images.
+  final PngFilter pngFilter;
 }
 
 /// The format of pixel data given to [decodeImageFromPixels].
@@ -1706,17 +1778,18 @@ class Image {
   /// Converts the [Image] object into a byte array.
   ///
   /// The [format] argument specifies the format in which the bytes will be
-  /// returned.
+  /// returned. The [options] argument specifies how hard compressed formats
+  /// try to shrink the image. Large PNG images are compressed on multiple
+  /// threads.
   ///
   /// Returns a future that completes with the binary image data or an error
   /// if encoding fails.
-  // We do not expect to add more encoding formats to the ImageByteFormat enum,
-  // considering the binary size of the engine after LTO optimization. You can
-  // use the third-party pure dart image library to encode other formats.
-  // See: https://github.com/flutter/flutter/issues/16635 for more details.
-  Future<ByteData?> toByteData({ImageByteFormat format = ImageByteFormat.rawRgba}) {
+  Future<ByteData?> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    ImageEncodingOptions options = const ImageEncodingOptions(),
+  }) {
     assert(!_disposed && !_image._disposed);
-    return _image.toByteData(format: format);
+    return _image.toByteData(format: format, options: options);
   }
 
   /// If asserts are enabled, returns the [StackTrace]s of each open handle from
@@ -1848,16 +1921,19 @@ class _Image extends NativeFieldWrapperClass1 {
 
   int get height native 'Image_height';
 
-  Future<ByteData?> toByteData({ImageByteFormat format = ImageByteFormat.rawRgba}) {
+  Future<ByteData?> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    ImageEncodingOptions options = const ImageEncodingOptions(),
+  }) {
     return _futurize((_Callback<ByteData> callback) {
-      return _toByteData(format.index, (Uint8List? encoded) {
+      return _toByteData(format.index, options.quality, options.compressionLevel, options.pngFilter.index, (Uint8List? encoded) {
         callback(encoded!.buffer.asByteData());
       });
     });
   }
 
   /// Returns an error message on failure, null on success.
-  String? _toByteData(int format, _Callback<Uint8List?> callback) native 'Image_toByteData';
+  String? _toByteData(int format, int quality, int compressionLevel, int pngFilter, _Callback<Uint8List?> callback) native 'Image_toByteData';
 
   bool _disposed = false;
   void dispose() {
@@ -5521,6 +5597,57 @@ class ImageDescriptor extends NativeFieldWrapperClass1 {
   void _instantiateCodec(Codec outCodec, int targetWidth, int targetHeight) native 'ImageDescriptor_instantiateCodec';
 }
 
+/// Decodes an image while its encoded bytes are still arriving, for example
+/// from the network, so that the part of the image that has arrived can be
+/// shown early.
+///
+/// Pass each chunk of encoded bytes to [addChunk] as it arrives. Unlike with
+/// [ImageDescriptor.encoded], the bytes are dropped as soon as they have been
+/// decoded, so the whole encoded image never needs to be held in memory
+/// alongside the decoded one.
+///
+/// Progressive and interlaced images get sharper with each chunk. Formats
+/// that can't be decoded incrementally, such as JPEG, only produce an image
+/// once the last chunk has been added.
+class IncrementalImageDecoder extends NativeFieldWrapperClass1 {
+  /// Creates a decoder that has not been given any bytes yet.
+  @pragma('vm:entry-point')
+  IncrementalImageDecoder() { _constructor(); }
+  void _constructor() native 'IncrementalImageDecoder_constructor';
+
+  /// Adds the next chunk of encoded bytes and decodes as much of the image as
+  /// the bytes added so far allow.
+  ///
+  /// Completes with an image of everything decoded so far, in which the rows
+  /// that have not been decoded yet are transparent, or with null if the
+  /// chunk did not complete any more rows of the image. Set `isLast` for the
+  /// final chunk. The image it completes with is the final image, and no more
+  /// chunks may be added after it.
+  ///
+  /// Completes with an error if the bytes can't be decoded.
+  Future<Image?> addChunk(Uint8List chunk, {bool isLast = false}) {
+    final Completer<Image?> completer = Completer<Image?>.sync();
+    final String? error = _addChunk(chunk, isLast, (_Image? image, String? decodeError) {
+      if (decodeError != null) {
+        completer.completeError(Exception(decodeError));
+      } else {
+        completer.complete(image == null ? null : Image._(image));
+      }
+    });
+    if (error != null) {
+      throw Exception(error);
+    }
+    return completer.future;
+  }
+
+  /// Returns an error message on failure, null on success.
+  String? _addChunk(Uint8List chunk, bool isLast, void Function(_Image?, String?) callback) native 'IncrementalImageDecoder_addChunk';
+
+  /// Release the resources used by this object. The object is no longer usable
+  /// after this method is called.
+  void dispose() native 'IncrementalImageDecoder_dispose';
+}
+
 /// Generic callback signature, used by [_futurize].
 typedef _Callback<T> = void Function(T result);
 
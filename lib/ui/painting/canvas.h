@@ -169,6 +169,13 @@ class Canvas : public RefCountedDartWrappable<Canvas>, DisplayListOpFlags {
                   bool transparentOccluder);
 
   SkCanvas* canvas() const { return canvas_; }
+
+  // The builder that this canvas records into when display lists are
+  // enabled, or null.
+  DisplayListBuilder* display_list_builder() const {
+    return display_list_recorder_ ? display_list_recorder_->builder().get()
+                                  : nullptr;
+  }
   void Invalidate();
 
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
@@ -0,0 +1,260 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
+
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint8_t kKTXIdentifier[] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31,
+                                      0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr uint8_t kKTX2Identifier[] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                       0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr size_t kIdentifierSize = sizeof(kKTXIdentifier);
+
+// https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
+constexpr size_t kKTXHeaderSize = 64;
+constexpr uint32_t kKTXEndianness = 0x04030201;
+constexpr uint32_t kGLCompressedETC1RGB8 = 0x8D64;
+constexpr uint32_t kGLCompressedRGB8ETC2 = 0x9274;
+constexpr uint32_t kGLCompressedRGBS3TCDXT1 = 0x83F0;
+constexpr uint32_t kGLCompressedRGBAS3TCDXT1 = 0x83F1;
+
+// https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+constexpr size_t kKTX2HeaderSize = 80;
+constexpr size_t kKTX2LevelIndexEntrySize = 24;
+constexpr uint32_t kVkFormatBC1RGBUnormBlock = 131;
+constexpr uint32_t kVkFormatBC1RGBAUnormBlock = 133;
+constexpr uint32_t kVkFormatETC2R8G8B8UnormBlock = 147;
+
+// All of the supported formats store 4x4 pixel blocks in 8 bytes.
+constexpr int kBlockDimension = 4;
+constexpr size_t kBlockSize = 8;
+
+uint32_t ReadUint32(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         static_cast<uint32_t>(bytes[1]) << 8 |
+         static_cast<uint32_t>(bytes[2]) << 16 |
+         static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+uint64_t ReadUint64(const uint8_t* bytes) {
+  return static_cast<uint64_t>(ReadUint32(bytes)) |
+         static_cast<uint64_t>(ReadUint32(bytes + 4)) << 32;
+}
+
+// Whether the dimensions are valid and `size` bytes hold all of their blocks.
+bool HasAllBlocks(uint32_t width, uint32_t height, uint64_t size) {
+  // Stay well within the limits of `SkISize` and of texture sizes.
+  constexpr uint32_t kMaxDimension = 1 << 16;
+  if (width == 0 || height == 0 || width > kMaxDimension ||
+      height > kMaxDimension) {
+    return false;
+  }
+  const uint64_t blocks_wide = (width + kBlockDimension - 1) / kBlockDimension;
+  const uint64_t blocks_high =
+      (height + kBlockDimension - 1) / kBlockDimension;
+  return size >= blocks_wide * blocks_high * kBlockSize;
+}
+
+std::optional<SkImage::CompressionType> CompressionTypeForGLFormat(
+    uint32_t gl_internal_format) {
+  switch (gl_internal_format) {
+    // ETC2 decoders decode ETC1 blocks as they are.
+    case kGLCompressedETC1RGB8:
+    case kGLCompressedRGB8ETC2:
+      return SkImage::CompressionType::kETC2_RGB8_UNORM;
+    case kGLCompressedRGBS3TCDXT1:
+      return SkImage::CompressionType::kBC1_RGB8_UNORM;
+    case kGLCompressedRGBAS3TCDXT1:
+      return SkImage::CompressionType::kBC1_RGBA8_UNORM;
+    default:
+      return std::nullopt;
+  }
+}
+
+std::optional<SkImage::CompressionType> CompressionTypeForVkFormat(
+    uint32_t vk_format) {
+  switch (vk_format) {
+    case kVkFormatETC2R8G8B8UnormBlock:
+      return SkImage::CompressionType::kETC2_RGB8_UNORM;
+    case kVkFormatBC1RGBUnormBlock:
+      return SkImage::CompressionType::kBC1_RGB8_UNORM;
+    case kVkFormatBC1RGBAUnormBlock:
+      return SkImage::CompressionType::kBC1_RGBA8_UNORM;
+    default:
+      return std::nullopt;
+  }
+}
+
+std::optional<ImageGenerator::CompressedTexture> ReadKTX(
+    const sk_sp<SkData>& data) {
+  if (data->size() < kKTXHeaderSize + sizeof(uint32_t)) {
+    return std::nullopt;
+  }
+  const auto* header = data->bytes();
+  // Files written on big endian machines are not supported.
+  if (ReadUint32(header + 12) != kKTXEndianness) {
+    return std::nullopt;
+  }
+  const uint32_t gl_type = ReadUint32(header + 16);
+  const uint32_t gl_internal_format = ReadUint32(header + 28);
+  const uint32_t width = ReadUint32(header + 36);
+  const uint32_t height = ReadUint32(header + 40);
+  const uint32_t depth = ReadUint32(header + 44);
+  const uint32_t array_elements = ReadUint32(header + 48);
+  const uint32_t faces = ReadUint32(header + 52);
+  const uint32_t key_value_bytes = ReadUint32(header + 60);
+
+  // Compressed textures have a type of zero.
+  auto type = CompressionTypeForGLFormat(gl_internal_format);
+  if (gl_type != 0 || !type || depth > 1 || array_elements != 0 ||
+      faces != 1) {
+    return std::nullopt;
+  }
+
+  const uint64_t image_size_offset =
+      static_cast<uint64_t>(kKTXHeaderSize) + key_value_bytes;
+  if (image_size_offset + sizeof(uint32_t) > data->size()) {
+    return std::nullopt;
+  }
+  const uint64_t image_offset = image_size_offset + sizeof(uint32_t);
+  const uint32_t image_size = ReadUint32(header + image_size_offset);
+  if (image_size > data->size() - image_offset ||
+      !HasAllBlocks(width, height, image_size)) {
+    return std::nullopt;
+  }
+
+  return ImageGenerator::CompressedTexture{
+      .data = SkData::MakeSubset(data.get(), image_offset, image_size),
+      .dimensions = SkISize::Make(width, height),
+      .type = *type,
+  };
+}
+
+std::optional<ImageGenerator::CompressedTexture> ReadKTX2(
+    const sk_sp<SkData>& data) {
+  if (data->size() < kKTX2HeaderSize + kKTX2LevelIndexEntrySize) {
+    return std::nullopt;
+  }
+  const auto* header = data->bytes();
+  const uint32_t vk_format = ReadUint32(header + 12);
+  const uint32_t width = ReadUint32(header + 20);
+  const uint32_t height = ReadUint32(header + 24);
+  const uint32_t depth = ReadUint32(header + 28);
+  const uint32_t layers = ReadUint32(header + 32);
+  const uint32_t faces = ReadUint32(header + 36);
+  const uint32_t supercompression_scheme = ReadUint32(header + 44);
+
+  auto type = CompressionTypeForVkFormat(vk_format);
+  if (!type || depth != 0 || layers != 0 || faces != 1 ||
+      supercompression_scheme != 0) {
+    return std::nullopt;
+  }
+
+  // The level index starts with the largest level.
+  const auto* level = header + kKTX2HeaderSize;
+  const uint64_t level_offset = ReadUint64(level);
+  const uint64_t level_size = ReadUint64(level + 8);
+  if (level_offset > data->size() ||
+      level_size > data->size() - level_offset ||
+      !HasAllBlocks(width, height, level_size)) {
+    return std::nullopt;
+  }
+
+  return ImageGenerator::CompressedTexture{
+      .data = SkData::MakeSubset(data.get(), level_offset, level_size),
+      .dimensions = SkISize::Make(width, height),
+      .type = *type,
+  };
+}
+
+}  // namespace
+
+CompressedTextureImageGenerator::CompressedTextureImageGenerator(
+    CompressedTexture texture)
+    : texture_(std::move(texture)),
+      info_(SkImageInfo::MakeN32(
+          texture_.dimensions.width(),
+          texture_.dimensions.height(),
+          texture_.type == SkImage::CompressionType::kBC1_RGBA8_UNORM
+              ? kPremul_SkAlphaType
+              : kOpaque_SkAlphaType)) {}
+
+CompressedTextureImageGenerator::~CompressedTextureImageGenerator() = default;
+
+const SkImageInfo& CompressedTextureImageGenerator::GetInfo() {
+  return info_;
+}
+
+unsigned int CompressedTextureImageGenerator::GetFrameCount() const {
+  return 1;
+}
+
+unsigned int CompressedTextureImageGenerator::GetPlayCount() const {
+  return 1;
+}
+
+const ImageGenerator::FrameInfo CompressedTextureImageGenerator::GetFrameInfo(
+    unsigned int frame_index) const {
+  return {.required_frame = std::nullopt,
+          .duration = 0,
+          .disposal_method = SkCodecAnimation::DisposalMethod::kKeep};
+}
+
+SkISize CompressedTextureImageGenerator::GetScaledDimensions(
+    float desired_scale) {
+  return info_.dimensions();
+}
+
+bool CompressedTextureImageGenerator::GetPixels(
+    const SkImageInfo& info,
+    void* pixels,
+    size_t row_bytes,
+    unsigned int frame_index,
+    std::optional<unsigned int> prior_frame) {
+  TRACE_EVENT0("flutter", "CompressedTextureImageGenerator::GetPixels");
+  if (info.dimensions() != info_.dimensions()) {
+    return false;
+  }
+  auto image = SkImage::MakeRasterFromCompressed(
+      texture_.data, texture_.dimensions.width(), texture_.dimensions.height(),
+      texture_.type);
+  if (!image) {
+    FML_LOG(ERROR) << "Could not decompress texture.";
+    return false;
+  }
+  return image->readPixels(nullptr, info, pixels, row_bytes, 0, 0);
+}
+
+std::optional<ImageGenerator::CompressedTexture>
+CompressedTextureImageGenerator::GetCompressedTexture() {
+  return texture_;
+}
+
+std::unique_ptr<ImageGenerator> CompressedTextureImageGenerator::MakeFromData(
+    sk_sp<SkData> data) {
+  if (!data || data->size() < kIdentifierSize) {
+    return nullptr;
+  }
+  std::optional<CompressedTexture> texture;
+  if (memcmp(data->data(), kKTXIdentifier, kIdentifierSize) == 0) {
+    texture = ReadKTX(data);
+  } else if (memcmp(data->data(), kKTX2Identifier, kIdentifierSize) == 0) {
+    texture = ReadKTX2(data);
+  }
+  if (!texture || !texture->data) {
+    return nullptr;
+  }
+  return std::unique_ptr<ImageGenerator>(
+      new CompressedTextureImageGenerator(std::move(*texture)));
+}
+
+}  // namespace flutter
@@ -0,0 +1,73 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
+#define FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
+
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/painting/image_generator.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      An `ImageGenerator` for KTX and KTX2 containers of textures in
+///             a compressed format that Skia can upload, i.e. ETC1, ETC2 RGB8
+///             and BC1. The blocks of the first mipmap level are handed to the
+///             GPU as they are. Since not all backends can sample every
+///             format, `GetPixels` decompresses the blocks in software.
+///
+///             Other mipmap levels, texture arrays, cube maps and
+///             supercompressed KTX2 files are not supported.
+///
+class CompressedTextureImageGenerator : public ImageGenerator {
+ public:
+  ~CompressedTextureImageGenerator();
+
+  // |ImageGenerator|
+  const SkImageInfo& GetInfo() override;
+
+  // |ImageGenerator|
+  unsigned int GetFrameCount() const override;
+
+  // |ImageGenerator|
+  unsigned int GetPlayCount() const override;
+
+  // |ImageGenerator|
+  const ImageGenerator::FrameInfo GetFrameInfo(
+      unsigned int frame_index) const override;
+
+  // |ImageGenerator|
+  SkISize GetScaledDimensions(float desired_scale) override;
+
+  // |ImageGenerator|
+  bool GetPixels(
+      const SkImageInfo& info,
+      void* pixels,
+      size_t row_bytes,
+      unsigned int frame_index = 0,
+      std::optional<unsigned int> prior_frame = std::nullopt) override;
+
+  // |ImageGenerator|
+  std::optional<CompressedTexture> GetCompressedTexture() override;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Reads the header of a KTX or KTX2 container.
+  ///
+  /// @return     A generator for the texture, or null if `data` is not a
+  ///             container of a supported texture.
+  ///
+  static std::unique_ptr<ImageGenerator> MakeFromData(sk_sp<SkData> data);
+
+ private:
+  explicit CompressedTextureImageGenerator(CompressedTexture texture);
+
+  const CompressedTexture texture_;
+  const SkImageInfo info_;
+
+  FML_DISALLOW_COPY_ASSIGN_AND_MOVE(CompressedTextureImageGenerator);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
@@ -0,0 +1,178 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "flutter/lib/ui/painting/image_generator_registry.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr uint32_t kGLCompressedRGBS3TCDXT1 = 0x83F0;
+constexpr uint32_t kGLCompressedRGBA8ASTC4x4 = 0x93B0;
+constexpr uint32_t kVkFormatBC1RGBUnormBlock = 131;
+constexpr uint32_t kVkFormatETC2R8G8B8UnormBlock = 147;
+
+// A BC1 block of opaque red: both end points are red and all of the indices
+// select the first one.
+constexpr uint8_t kRedBC1Block[] = {0x00, 0xF8, 0x00, 0xF8, 0, 0, 0, 0};
+
+void AppendUint32(std::vector<uint8_t>& bytes, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    bytes.push_back((value >> (i * 8)) & 0xFF);
+  }
+}
+
+void AppendUint64(std::vector<uint8_t>& bytes, uint64_t value) {
+  AppendUint32(bytes, value & 0xFFFFFFFF);
+  AppendUint32(bytes, value >> 32);
+}
+
+std::vector<uint8_t> RedBlocks(int width, int height) {
+  std::vector<uint8_t> blocks;
+  for (int i = 0; i < ((width + 3) / 4) * ((height + 3) / 4); i++) {
+    blocks.insert(blocks.end(), std::begin(kRedBC1Block),
+                  std::end(kRedBC1Block));
+  }
+  return blocks;
+}
+
+sk_sp<SkData> MakeKTX(uint32_t gl_internal_format,
+                      int width,
+                      int height,
+                      const std::vector<uint8_t>& blocks) {
+  std::vector<uint8_t> bytes = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31,
+                                0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  AppendUint32(bytes, 0x04030201);          // endianness
+  AppendUint32(bytes, 0);                   // glType
+  AppendUint32(bytes, 1);                   // glTypeSize
+  AppendUint32(bytes, 0);                   // glFormat
+  AppendUint32(bytes, gl_internal_format);  // glInternalFormat
+  AppendUint32(bytes, 0x1907);              // glBaseInternalFormat
+  AppendUint32(bytes, width);               // pixelWidth
+  AppendUint32(bytes, height);              // pixelHeight
+  AppendUint32(bytes, 0);                   // pixelDepth
+  AppendUint32(bytes, 0);                   // numberOfArrayElements
+  AppendUint32(bytes, 1);                   // numberOfFaces
+  AppendUint32(bytes, 1);                   // numberOfMipmapLevels
+  AppendUint32(bytes, 8);                   // bytesOfKeyValueData
+  bytes.insert(bytes.end(), 8, 0);
+  AppendUint32(bytes, blocks.size());
+  bytes.insert(bytes.end(), blocks.begin(), blocks.end());
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+sk_sp<SkData> MakeKTX2(uint32_t vk_format,
+                       int width,
+                       int height,
+                       const std::vector<uint8_t>& blocks) {
+  std::vector<uint8_t> bytes = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  AppendUint32(bytes, vk_format);  // vkFormat
+  AppendUint32(bytes, 1);          // typeSize
+  AppendUint32(bytes, width);      // pixelWidth
+  AppendUint32(bytes, height);     // pixelHeight
+  AppendUint32(bytes, 0);          // pixelDepth
+  AppendUint32(bytes, 0);          // layerCount
+  AppendUint32(bytes, 1);          // faceCount
+  AppendUint32(bytes, 1);          // levelCount
+  AppendUint32(bytes, 0);          // supercompressionScheme
+  // The data format descriptor and key/value data are not read.
+  bytes.insert(bytes.end(), 32, 0);
+  const uint64_t level_offset = bytes.size() + 24;
+  AppendUint64(bytes, level_offset);   // byteOffset
+  AppendUint64(bytes, blocks.size());  // byteLength
+  AppendUint64(bytes, blocks.size());  // uncompressedByteLength
+  bytes.insert(bytes.end(), blocks.begin(), blocks.end());
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+void ExpectRedPixels(ImageGenerator& generator) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(generator.GetInfo());
+  ASSERT_TRUE(generator.GetPixels(bitmap.info(), bitmap.getPixels(),
+                                  bitmap.rowBytes()));
+  for (int y = 0; y < bitmap.height(); y++) {
+    for (int x = 0; x < bitmap.width(); x++) {
+      ASSERT_EQ(bitmap.getColor(x, y), SK_ColorRED);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CompressedTextureImageGeneratorTest, ReadsKTX) {
+  const auto blocks = RedBlocks(10, 6);
+  auto generator = CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX(kGLCompressedRGBS3TCDXT1, 10, 6, blocks));
+  ASSERT_TRUE(generator);
+  ASSERT_EQ(generator->GetInfo().dimensions(), SkISize::Make(10, 6));
+  ASSERT_EQ(generator->GetInfo().alphaType(), kOpaque_SkAlphaType);
+  ASSERT_EQ(generator->GetFrameCount(), 1u);
+
+  auto texture = generator->GetCompressedTexture();
+  ASSERT_TRUE(texture);
+  ASSERT_EQ(texture->type, SkImage::CompressionType::kBC1_RGB8_UNORM);
+  ASSERT_EQ(texture->dimensions, SkISize::Make(10, 6));
+  ASSERT_EQ(texture->data->size(), blocks.size());
+  ASSERT_EQ(memcmp(texture->data->data(), blocks.data(), blocks.size()), 0);
+
+  ExpectRedPixels(*generator);
+}
+
+TEST(CompressedTextureImageGeneratorTest, ReadsKTX2) {
+  const auto blocks = RedBlocks(16, 8);
+  auto generator = CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX2(kVkFormatBC1RGBUnormBlock, 16, 8, blocks));
+  ASSERT_TRUE(generator);
+  ASSERT_EQ(generator->GetInfo().dimensions(), SkISize::Make(16, 8));
+
+  auto texture = generator->GetCompressedTexture();
+  ASSERT_TRUE(texture);
+  ASSERT_EQ(texture->type, SkImage::CompressionType::kBC1_RGB8_UNORM);
+  ASSERT_EQ(texture->data->size(), blocks.size());
+
+  ExpectRedPixels(*generator);
+
+  auto etc2_generator = CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX2(kVkFormatETC2R8G8B8UnormBlock, 16, 8, blocks));
+  ASSERT_TRUE(etc2_generator);
+  ASSERT_EQ(etc2_generator->GetCompressedTexture()->type,
+            SkImage::CompressionType::kETC2_RGB8_UNORM);
+}
+
+TEST(CompressedTextureImageGeneratorTest, RejectsUnsupportedTextures) {
+  // Skia cannot upload or decompress ASTC textures.
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX(kGLCompressedRGBA8ASTC4x4, 8, 8, std::vector<uint8_t>(64))));
+
+  // Not all blocks are present.
+  auto blocks = RedBlocks(8, 8);
+  blocks.pop_back();
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX(kGLCompressedRGBS3TCDXT1, 8, 8, blocks)));
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      MakeKTX2(kVkFormatBC1RGBUnormBlock, 8, 8, blocks)));
+
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      SkData::MakeWithCString("Not a texture")));
+}
+
+TEST(CompressedTextureImageGeneratorTest, IsRegisteredByDefault) {
+  ImageGeneratorRegistry registry;
+  auto generator = registry.CreateCompatibleGenerator(
+      MakeKTX(kGLCompressedRGBS3TCDXT1, 4, 4, RedBlocks(4, 4)));
+  ASSERT_TRUE(generator);
+  ASSERT_TRUE(generator->GetCompressedTexture());
+}
+
+}  // namespace testing
+}  // namespace flutter
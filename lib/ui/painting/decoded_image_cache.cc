@@ -0,0 +1,204 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/image_descriptor.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint64_t kHashMultiplier = 0x9E3779B97F4A7C15ull;
+
+uint64_t Mix(uint64_t hash, uint64_t value) {
+  hash ^= value * kHashMultiplier;
+  hash = (hash << 31) | (hash >> 33);
+  return hash * kHashMultiplier;
+}
+
+// A fast non-cryptographic hash that consumes eight bytes at a time. Collisions
+// are tolerated since the cache compares the bytes of matching entries.
+uint64_t HashBytes(const uint8_t* bytes, size_t size) {
+  uint64_t hash = size * kHashMultiplier;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + offset, sizeof(word));
+    hash = Mix(hash, word);
+  }
+  if (offset < size) {
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes + offset, size - offset);
+    hash = Mix(hash, tail);
+  }
+  return hash ^ (hash >> 29);
+}
+
+}  // namespace
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  return content_hash == other.content_hash &&
+         content_size == other.content_size &&
+         source_width == other.source_width &&
+         source_height == other.source_height &&
+         source_row_bytes == other.source_row_bytes &&
+         color_type == other.color_type && alpha_type == other.alpha_type &&
+         is_compressed == other.is_compressed &&
+         target_width == other.target_width &&
+         target_height == other.target_height &&
+         frame_index == other.frame_index;
+}
+
+std::size_t DecodedImageCache::KeyHash::operator()(const Key& key) const {
+  return fml::HashCombine(key.content_hash, key.target_width,
+                          key.target_height, static_cast<int>(key.color_type),
+                          key.frame_index);
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() {
+  Purge();
+}
+
+DecodedImageCache::Key DecodedImageCache::MakeKey(
+    const ImageDescriptor& descriptor,
+    uint32_t target_width,
+    uint32_t target_height) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::MakeKey");
+  const auto data = descriptor.data();
+  const auto& image_info = descriptor.image_info();
+  return {
+      .content_hash = HashBytes(data->bytes(), data->size()),
+      .content_size = data->size(),
+      .source_width = image_info.width(),
+      .source_height = image_info.height(),
+      .source_row_bytes = static_cast<size_t>(descriptor.row_bytes()),
+      .color_type = image_info.colorType(),
+      .alpha_type = image_info.alphaType(),
+      .is_compressed = descriptor.is_compressed(),
+      .target_width = target_width,
+      .target_height = target_height,
+  };
+}
+
+DecodedImageCache::Key DecodedImageCache::MakeFrameKey(
+    const sk_sp<SkData>& data,
+    const SkImageInfo& frame_info,
+    int frame_index) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::MakeFrameKey");
+  return {
+      .content_hash = HashBytes(data->bytes(), data->size()),
+      .content_size = data->size(),
+      .source_width = frame_info.width(),
+      .source_height = frame_info.height(),
+      .source_row_bytes = frame_info.minRowBytes(),
+      .color_type = frame_info.colorType(),
+      .alpha_type = frame_info.alphaType(),
+      .is_compressed = true,
+      .target_width = static_cast<uint32_t>(frame_info.width()),
+      .target_height = static_cast<uint32_t>(frame_info.height()),
+      .frame_index = frame_index,
+  };
+}
+
+SkiaGPUObject<SkImage> DecodedImageCache::Get(const Key& key,
+                                              const sk_sp<SkData>& data) {
+  if (max_bytes_ == 0) {
+    return {};
+  }
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return {};
+  }
+  const auto& entry = found->second;
+  if (entry->data != data && !entry->data->equals(data.get())) {
+    return {};
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  return {entry->image, entry->unref_queue};
+}
+
+void DecodedImageCache::Put(const Key& key,
+                            sk_sp<SkData> data,
+                            sk_sp<SkImage> image,
+                            fml::RefPtr<SkiaUnrefQueue> unref_queue) {
+  if (!data || !image) {
+    return;
+  }
+  const size_t size_in_bytes = image->imageInfo().computeMinByteSize();
+  if (data->size() + size_in_bytes > max_bytes_) {
+    if (unref_queue) {
+      unref_queue->Unref(image.release());
+    }
+    return;
+  }
+
+  std::scoped_lock lock(mutex_);
+  auto existing = index_.find(key);
+  if (existing != index_.end()) {
+    EvictLocked(existing->second);
+  }
+  // Evictions may release the data, so whether it needs to be accounted for
+  // is checked each time.
+  auto added_bytes = [&]() {
+    return size_in_bytes +
+           (data_entry_counts_.count(data.get()) ? 0 : data->size());
+  };
+  while (size_in_bytes_ + added_bytes() > max_bytes_) {
+    EvictLocked(std::prev(entries_.end()));
+  }
+  size_in_bytes_ += added_bytes();
+  data_entry_counts_[data.get()]++;
+  entries_.push_front({
+      .key = key,
+      .data = std::move(data),
+      .image = std::move(image),
+      .unref_queue = std::move(unref_queue),
+      .size_in_bytes = size_in_bytes,
+  });
+  index_[key] = entries_.begin();
+}
+
+void DecodedImageCache::Purge() {
+  std::scoped_lock lock(mutex_);
+  purge_count_++;
+  while (!entries_.empty()) {
+    EvictLocked(entries_.begin());
+  }
+}
+
+size_t DecodedImageCache::GetSizeInBytes() const {
+  std::scoped_lock lock(mutex_);
+  return size_in_bytes_;
+}
+
+size_t DecodedImageCache::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+void DecodedImageCache::EvictLocked(std::list<Entry>::iterator entry) {
+  if (entry->unref_queue) {
+    entry->unref_queue->Unref(entry->image.release());
+  }
+  size_in_bytes_ -= entry->size_in_bytes;
+  auto data_entry_count = data_entry_counts_.find(entry->data.get());
+  if (--data_entry_count->second == 0) {
+    size_in_bytes_ -= entry->data->size();
+    data_entry_counts_.erase(data_entry_count);
+  }
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+}  // namespace flutter
@@ -0,0 +1,154 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+
+namespace flutter {
+
+class ImageDescriptor;
+
+//------------------------------------------------------------------------------
+/// @brief      A byte bounded, least recently used cache of images decoded by
+///             the `ImageDecoder`.
+///
+///             Entries are keyed by a hash of the encoded (or raw) image bytes
+///             along with the layout of those bytes and the dimensions the
+///             image was decoded at. Since hashes may collide, the bytes of an
+///             entry are retained and compared on lookup. Both the bytes and
+///             the decoded image count against the budget. Bytes shared by
+///             several entries, like the frames of an animation, count once.
+///
+///             Images are released on the unref queue they were cached with
+///             so that textures are always collected on the IO thread.
+///
+///             This class is thread safe. It is shared by all isolates that
+///             decode images using the same `ImageDecoder`.
+///
+class DecodedImageCache {
+ public:
+  struct Key {
+    uint64_t content_hash = 0;
+    size_t content_size = 0;
+    int source_width = 0;
+    int source_height = 0;
+    size_t source_row_bytes = 0;
+    SkColorType color_type = kUnknown_SkColorType;
+    SkAlphaType alpha_type = kUnknown_SkAlphaType;
+    bool is_compressed = false;
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+    // The frame of a multi-frame image, or -1 for images decoded by the
+    // `ImageDecoder`.
+    int frame_index = -1;
+
+    bool operator==(const Key& other) const;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a cache that holds at most `max_bytes` worth of
+  ///             images and image data. A budget of zero disables the cache.
+  ///
+  explicit DecodedImageCache(size_t max_bytes);
+
+  ~DecodedImageCache();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Hashes the bytes of the descriptor and returns the key under
+  ///             which its image decoded at the given target size is cached.
+  ///             This reads all of the image data and should not be called on
+  ///             the UI thread.
+  ///
+  static Key MakeKey(const ImageDescriptor& descriptor,
+                     uint32_t target_width,
+                     uint32_t target_height);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Hashes the encoded bytes of a multi-frame image and returns
+  ///             the key under which its frame at `frame_index` is cached. The
+  ///             `frame_index` of the key may be changed to look up the other
+  ///             frames without hashing the bytes again.
+  ///
+  static Key MakeFrameKey(const sk_sp<SkData>& data,
+                          const SkImageInfo& frame_info,
+                          int frame_index);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Returns the cached image for the key if its data matches
+  ///             `data`, or an empty object otherwise.
+  ///
+  SkiaGPUObject<SkImage> Get(const Key& key, const sk_sp<SkData>& data);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Caches the image decoded from `data`, evicting the least
+  ///             recently used entries to stay within the budget. Images that
+  ///             don't fit the budget on their own are not cached.
+  ///
+  void Put(const Key& key,
+           sk_sp<SkData> data,
+           sk_sp<SkImage> image,
+           fml::RefPtr<SkiaUnrefQueue> unref_queue);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Drops all entries, e.g., in response to memory pressure.
+  ///
+  void Purge();
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of times the cache has been purged. Users that
+  ///             would rather not refill the cache after memory pressure can
+  ///             compare this with the count they last saw.
+  ///
+  size_t GetPurgeCount() const { return purge_count_; }
+
+  size_t GetMaxBytes() const { return max_bytes_; }
+
+  size_t GetSizeInBytes() const;
+
+  size_t GetEntryCount() const;
+
+ private:
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    sk_sp<SkData> data;
+    sk_sp<SkImage> image;
+    fml::RefPtr<SkiaUnrefQueue> unref_queue;
+    // The size of the image. The data is accounted for separately.
+    size_t size_in_bytes = 0;
+  };
+
+  const size_t max_bytes_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+  // The number of entries retaining each data.
+  std::unordered_map<const SkData*, size_t> data_entry_counts_;
+  size_t size_in_bytes_ = 0;
+  std::atomic_size_t purge_count_ = 0;
+
+  void EvictLocked(std::list<Entry>::iterator entry);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
@@ -0,0 +1,146 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// 10x10 N32 images take 400 bytes.
+constexpr size_t kImageBytes = 400;
+
+sk_sp<SkImage> CreateImage() {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  bitmap.eraseColor(SK_ColorRED);
+  bitmap.setImmutable();
+  return bitmap.asImage();
+}
+
+DecodedImageCache::Key CreateKey(uint64_t content_hash,
+                                 const sk_sp<SkData>& data) {
+  return {
+      .content_hash = content_hash,
+      .content_size = data->size(),
+      .color_type = kN32_SkColorType,
+      .target_width = 10,
+      .target_height = 10,
+  };
+}
+
+}  // namespace
+
+TEST(DecodedImageCacheTest, ReturnsCachedImageForEqualBytes) {
+  DecodedImageCache cache(10 * kImageBytes);
+  auto data = SkData::MakeWithCString("image");
+  auto key = CreateKey(1, data);
+  auto image = CreateImage();
+  cache.Put(key, data, image, nullptr);
+
+  // Different buffers with the same contents match.
+  auto same_data = SkData::MakeWithCString("image");
+  ASSERT_EQ(cache.Get(key, same_data).skia_object(), image);
+  ASSERT_EQ(cache.GetEntryCount(), 1u);
+  ASSERT_EQ(cache.GetSizeInBytes(), kImageBytes + data->size());
+}
+
+TEST(DecodedImageCacheTest, HashCollisionsDoNotMatch) {
+  DecodedImageCache cache(10 * kImageBytes);
+  auto data = SkData::MakeWithCString("image");
+  auto key = CreateKey(1, data);
+  cache.Put(key, data, CreateImage(), nullptr);
+
+  auto other_data = SkData::MakeWithCString("other");
+  ASSERT_EQ(other_data->size(), data->size());
+  ASSERT_FALSE(cache.Get(key, other_data).skia_object());
+}
+
+TEST(DecodedImageCacheTest, EvictsLeastRecentlyUsedImages) {
+  auto data = SkData::MakeWithCString("image");
+  DecodedImageCache cache(2 * (kImageBytes + data->size()));
+  cache.Put(CreateKey(1, data), data, CreateImage(), nullptr);
+  cache.Put(CreateKey(2, data), data, CreateImage(), nullptr);
+
+  // Makes the first image the most recently used one.
+  ASSERT_TRUE(cache.Get(CreateKey(1, data), data).skia_object());
+
+  cache.Put(CreateKey(3, data), data, CreateImage(), nullptr);
+  ASSERT_EQ(cache.GetEntryCount(), 2u);
+  ASSERT_TRUE(cache.Get(CreateKey(1, data), data).skia_object());
+  ASSERT_FALSE(cache.Get(CreateKey(2, data), data).skia_object());
+  ASSERT_TRUE(cache.Get(CreateKey(3, data), data).skia_object());
+}
+
+TEST(DecodedImageCacheTest, DoesNotCacheImagesOverBudget) {
+  auto data = SkData::MakeWithCString("image");
+  DecodedImageCache cache(kImageBytes);
+  cache.Put(CreateKey(1, data), data, CreateImage(), nullptr);
+  ASSERT_EQ(cache.GetEntryCount(), 0u);
+  ASSERT_EQ(cache.GetSizeInBytes(), 0u);
+}
+
+TEST(DecodedImageCacheTest, PurgeDropsAllImages) {
+  DecodedImageCache cache(10 * kImageBytes);
+  auto data = SkData::MakeWithCString("image");
+  cache.Put(CreateKey(1, data), data, CreateImage(), nullptr);
+  cache.Put(CreateKey(2, data), data, CreateImage(), nullptr);
+  cache.Purge();
+  ASSERT_EQ(cache.GetEntryCount(), 0u);
+  ASSERT_EQ(cache.GetSizeInBytes(), 0u);
+  ASSERT_FALSE(cache.Get(CreateKey(1, data), data).skia_object());
+}
+
+TEST(DecodedImageCacheTest, CountsPurges) {
+  DecodedImageCache cache(10 * kImageBytes);
+  ASSERT_EQ(cache.GetPurgeCount(), 0u);
+  cache.Purge();
+  cache.Purge();
+  ASSERT_EQ(cache.GetPurgeCount(), 2u);
+}
+
+TEST(DecodedImageCacheTest, CachesFramesSeparately) {
+  DecodedImageCache cache(10 * kImageBytes);
+  auto data = SkData::MakeWithCString("animation");
+  const auto info = SkImageInfo::MakeN32Premul(10, 10);
+  auto key = DecodedImageCache::MakeFrameKey(data, info, 0);
+  auto first_frame = CreateImage();
+  cache.Put(key, data, first_frame, nullptr);
+
+  key.frame_index = 1;
+  ASSERT_FALSE(cache.Get(key, data).skia_object());
+  auto second_frame = CreateImage();
+  cache.Put(key, data, second_frame, nullptr);
+
+  ASSERT_EQ(cache.Get(DecodedImageCache::MakeFrameKey(data, info, 0), data)
+                .skia_object(),
+            first_frame);
+  ASSERT_EQ(cache.Get(key, data).skia_object(), second_frame);
+  ASSERT_EQ(cache.GetEntryCount(), 2u);
+}
+
+TEST(DecodedImageCacheTest, CountsSharedDataOnce) {
+  auto data = SkData::MakeWithCString("animation");
+  DecodedImageCache cache(2 * kImageBytes + data->size());
+  const auto info = SkImageInfo::MakeN32Premul(10, 10);
+  cache.Put(DecodedImageCache::MakeFrameKey(data, info, 0), data,
+            CreateImage(), nullptr);
+  cache.Put(DecodedImageCache::MakeFrameKey(data, info, 1), data,
+            CreateImage(), nullptr);
+  ASSERT_EQ(cache.GetEntryCount(), 2u);
+  ASSERT_EQ(cache.GetSizeInBytes(), 2 * kImageBytes + data->size());
+
+  // Other data is counted on its own and evicts both frames.
+  auto other_data = SkData::MakeWithCString("image");
+  cache.Put(CreateKey(1, other_data), other_data, CreateImage(), nullptr);
+  ASSERT_EQ(cache.GetEntryCount(), 1u);
+  ASSERT_EQ(cache.GetSizeInBytes(), kImageBytes + other_data->size());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -39,8 +39,24 @@ CanvasImage::CanvasImage() = default;
 
 CanvasImage::~CanvasImage() = default;
 
-Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
-  return EncodeImage(this, format, callback);
+Dart_Handle CanvasImage::toByteData(int format,
+                                    int quality,
+                                    int compression_level,
+                                    int png_filter,
+                                    Dart_Handle callback) {
+  if (png_filter < 0 ||
+      png_filter > static_cast<int>(ParallelPngEncoder::Filter::kAdaptive)) {
+    return tonic::ToDart("Unknown PNG filter.");
+  }
+  const ImageEncodingOptions options = {
+      .quality = quality,
+      .png =
+          {
+              .compression_level = compression_level,
+              .filter = static_cast<ParallelPngEncoder::Filter>(png_filter),
+          },
+  };
+  return EncodeImage(this, format, options, callback);
 }
 
 void CanvasImage::dispose() {
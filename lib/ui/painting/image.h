@@ -30,7 +30,11 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
 
   int height() { return image_.skia_object()->height(); }
 
-  Dart_Handle toByteData(int format, Dart_Handle callback);
+  Dart_Handle toByteData(int format,
+                         int quality,
+                         int compression_level,
+                         int png_filter,
+                         Dart_Handle callback);
 
   void dispose();
 
@@ -5,8 +5,11 @@
 #include "flutter/lib/ui/painting/image_decoder.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/lib/ui/painting/image_downscaler.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 
 namespace flutter {
@@ -14,10 +17,13 @@ namespace flutter {
 ImageDecoder::ImageDecoder(
     TaskRunners runners,
     std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-    fml::WeakPtr<IOManager> io_manager)
+    fml::WeakPtr<IOManager> io_manager,
+    size_t decoded_image_cache_max_bytes)
     : runners_(std::move(runners)),
       concurrent_task_runner_(std::move(concurrent_task_runner)),
       io_manager_(std::move(io_manager)),
+      decoded_image_cache_(
+          std::make_shared<DecodedImageCache>(decoded_image_cache_max_bytes)),
       weak_factory_(this) {
   FML_DCHECK(runners_.IsValid());
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread())
@@ -43,6 +49,15 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return image->makeRasterImage();
   }
 
+  SkPixmap pixmap;
+  if (ImageDownscaler::CanDownscale(image->imageInfo(), resized_dimensions) &&
+      image->peekPixels(&pixmap)) {
+    if (auto scaled_image =
+            ImageDownscaler::Downscale(pixmap, resized_dimensions)) {
+      return scaled_image;
+    }
+  }
+
   const auto scaled_image_info =
       image->imageInfo().makeDimensions(resized_dimensions);
 
@@ -98,14 +113,161 @@ static sk_sp<SkImage> ImageFromDecompressedData(
                            SkISize::Make(target_width, target_height), flow);
 }
 
-sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
-                                       uint32_t target_width,
-                                       uint32_t target_height,
-                                       const fml::tracing::TraceFlow& flow) {
+static sk_sp<SkImage> DecodeAndDownscaleRows(
+    ImageDescriptor* descriptor,
+    const SkISize& decode_dimensions,
+    const SkISize& resized_dimensions,
+    const fml::tracing::TraceFlow& flow) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  // The downscaler averages premultiplied colors, so ask the codec for those.
+  auto info = descriptor->image_info().makeDimensions(decode_dimensions);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  if (!ImageDownscaler::CanDownscale(info, resized_dimensions)) {
+    return nullptr;
+  }
+
+  ImageDownscaler downscaler(info, resized_dimensions);
+  if (!downscaler.IsValid() ||
+      !descriptor->get_scanlines(info, [&downscaler](const void* row) {
+        downscaler.AddRow(row);
+      })) {
+    return nullptr;
+  }
+  return downscaler.MakeImage();
+}
+
+namespace {
+
+// Images smaller than this are decoded by a single worker since splitting
+// them up costs about as much as it saves.
+constexpr int64_t kMinPixelsForBandDecode = 2 * 1024 * 1024;
+constexpr int kMinRowsPerBand = 256;
+constexpr int kMaxBandCount = 8;
+// Keeps bands aligned to JPEG MCU rows.
+constexpr int kBandRowAlignment = 16;
+
+// Hands out the bands of an image to whichever thread asks for one first.
+// Bands are claimed rather than assigned so that the thread waiting for the
+// decode can decode every band itself if all other workers are busy, instead
+// of waiting on tasks that have not started.
+class BandDecode {
+ public:
+  using DecodeBand = std::function<bool(int band)>;
+
+  BandDecode(int band_count, DecodeBand decode_band)
+      : band_count_(band_count),
+        decode_band_(std::move(decode_band)),
+        bands_done_(band_count) {}
+
+  // Decodes bands until none are left to claim.
+  void DecodeRemainingBands() {
+    for (int band = next_band_++; band < band_count_; band = next_band_++) {
+      if (!decode_band_(band)) {
+        failed_ = true;
+      }
+      bands_done_.CountDown();
+    }
+  }
+
+  // Waits for bands claimed by other threads to finish. Only valid after a
+  // call to `DecodeRemainingBands` returned.
+  bool Wait() {
+    bands_done_.Wait();
+    return !failed_;
+  }
+
+ private:
+  const int band_count_;
+  const DecodeBand decode_band_;
+  std::atomic_int next_band_ = 0;
+  std::atomic_bool failed_ = false;
+  fml::CountDownLatch bands_done_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(BandDecode);
+};
+
+}  // namespace
+
+static sk_sp<SkImage> ImageFromCompressedDataInBands(
+    ImageDescriptor* descriptor,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner,
+    const fml::tracing::TraceFlow& flow) {
+  const auto& info = descriptor->image_info();
+  if (!concurrent_task_runner ||
+      static_cast<int64_t>(info.width()) * info.height() <
+          kMinPixelsForBandDecode) {
+    return nullptr;
+  }
+  // The decode already runs on one of the workers, which decodes bands too.
+  const int max_band_count =
+      std::clamp(static_cast<int>(concurrent_task_runner->GetWorkerCount()), 1,
+                 kMaxBandCount);
+  int band_count =
+      std::clamp(info.height() / kMinRowsPerBand, 1, max_band_count);
+  if (band_count < 2 || !descriptor->supports_band_decoding()) {
+    return nullptr;
+  }
+  const int rows_per_band =
+      ((info.height() + band_count - 1) / band_count + kBandRowAlignment - 1) /
+      kBandRowAlignment * kBandRowAlignment;
+  band_count = (info.height() + rows_per_band - 1) / rows_per_band;
+
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  // Tasks that start after every band was claimed only touch the shared
+  // state, never the descriptor or bitmap, which may be gone by then.
+  auto decode = std::make_shared<BandDecode>(
+      band_count, [descriptor, pixmap = bitmap.pixmap(), rows_per_band,
+                   height = info.height()](int band) {
+        TRACE_EVENT0("flutter", "DecodeImageBand");
+        const int first_row = band * rows_per_band;
+        return descriptor->get_band_pixels(
+            pixmap, first_row, std::min(rows_per_band, height - first_row));
+      });
+  for (int i = 1; i < band_count; i++) {
+    concurrent_task_runner->PostTask(
+        [decode] { decode->DecodeRemainingBands(); });
+  }
+  decode->DecodeRemainingBands();
+  if (!decode->Wait()) {
+    FML_LOG(ERROR) << "Could not decode all bands of the image.";
+    return nullptr;
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+sk_sp<SkImage> ImageFromCompressedData(
+    ImageDescriptor* descriptor,
+    uint32_t target_width,
+    uint32_t target_height,
+    const fml::tracing::TraceFlow& flow,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   flow.Step(__FUNCTION__);
 
   if (!descriptor->should_resize(target_width, target_height)) {
+    // Large images are split into bands that are decoded in parallel.
+    if (auto image = ImageFromCompressedDataInBands(
+            descriptor, concurrent_task_runner, flow)) {
+      return image;
+    }
+
     // No resizing requested. Just decode & rasterize the image.
     sk_sp<SkImage> image = descriptor->image();
     return image ? image->makeRasterImage() : nullptr;
@@ -121,6 +283,15 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
                static_cast<double>(resized_dimensions.height()) /
                    source_dimensions.height()));
 
+  // Where the codec can decode one row at a time, shrink the rows as they are
+  // decoded so that the image is never held at the decoded size.
+  if (decode_dimensions != resized_dimensions) {
+    if (auto image = DecodeAndDownscaleRows(descriptor, decode_dimensions,
+                                            resized_dimensions, flow)) {
+      return image;
+    }
+  }
+
   // If the codec supports efficient sub-pixel decoding, decoded at a resolution
   // close to the target resolution before resizing.
   if (decode_dimensions != source_dimensions) {
@@ -216,6 +387,60 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
+// Uploads the blocks of a compressed texture without decoding them first. If
+// the backend cannot sample the format, Skia decompresses the blocks in
+// software before uploading them.
+static SkiaGPUObject<SkImage> UploadCompressedTexture(
+    const ImageGenerator::CompressedTexture& texture,
+    fml::WeakPtr<IOManager> io_manager,
+    const fml::tracing::TraceFlow& flow) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  auto decompress = [&texture] {
+    return SkImage::MakeRasterFromCompressed(
+        texture.data, texture.dimensions.width(),
+        texture.dimensions.height(), texture.type);
+  };
+
+  // If the IO manager does not have a resource context, the caller might not
+  // have set one or a software backend could be in use.
+  if (!io_manager->GetResourceContext()) {
+    return {decompress(), io_manager->GetSkiaUnrefQueue()};
+  }
+
+  SkiaGPUObject<SkImage> result;
+  io_manager->GetIsGpuDisabledSyncSwitch()->Execute(
+      fml::SyncSwitch::Handlers()
+          .SetIfTrue([&result, &decompress] {
+            result = {decompress(), nullptr};
+          })
+          .SetIfFalse([&result, &texture,
+                       context = io_manager->GetResourceContext(),
+                       queue = io_manager->GetSkiaUnrefQueue()] {
+            TRACE_EVENT0("flutter", "MakeTextureFromCompressed");
+            sk_sp<SkImage> texture_image = SkImage::MakeTextureFromCompressed(
+                context.get(), texture.data, texture.dimensions.width(),
+                texture.dimensions.height(), texture.type);
+            if (!texture_image) {
+              FML_LOG(ERROR) << "Could not upload compressed texture.";
+              result = {};
+            } else {
+              result = {std::move(texture_image), queue};
+            }
+          }));
+
+  return result;
+}
+
+// Whether an image returned by the upload functions above may be cached.
+// While the GPU is disabled, they return raster images instead of textures.
+// Those must not be handed out from the cache once the GPU is available again.
+static bool IsCacheableUpload(const sk_sp<SkImage>& image,
+                              const fml::WeakPtr<IOManager>& io_manager) {
+  return image->isTextureBacked() || !io_manager->GetResourceContext();
+}
+
 void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
                           uint32_t target_width,
                           uint32_t target_height,
@@ -265,25 +490,83 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
 
   concurrent_task_runner_->PostTask(
       fml::MakeCopyable([raw_descriptor,                          //
+                         concurrent_task_runner =                 //
+                         concurrent_task_runner_,                 //
                          io_manager = io_manager_,                //
                          io_runner = runners_.GetIOTaskRunner(),  //
+                         cache = decoded_image_cache_,            //
                          result,                                  //
                          target_width = target_width,             //
                          target_height = target_height,           //
                          flow = std::move(flow)                   //
   ]() mutable {
+        // Step 0: Look for an image decoded from the same bytes.
+        // On Worker.
+
+        std::optional<DecodedImageCache::Key> cache_key;
+        if (cache->GetMaxBytes() > 0) {
+          cache_key = DecodedImageCache::MakeKey(*raw_descriptor, target_width,
+                                                 target_height);
+          auto cached = cache->Get(*cache_key, raw_descriptor->data());
+          if (cached.skia_object()) {
+            flow.Step("DecodedImageCacheHit");
+            result(std::move(cached), std::move(flow));
+            return;
+          }
+        }
+
+        // Textures in a format that GPUs can sample are uploaded as they are.
+        // On IO Thread.
+
+        auto compressed_texture =
+            raw_descriptor->should_resize(target_width, target_height)
+                ? std::nullopt
+                : raw_descriptor->get_compressed_texture();
+        if (compressed_texture) {
+          io_runner->PostTask(fml::MakeCopyable(
+              [io_manager, texture = std::move(*compressed_texture), result,
+               cache, cache_key, data = raw_descriptor->data(),
+               flow = std::move(flow)]() mutable {
+                if (!io_manager) {
+                  FML_DLOG(ERROR) << "Could not acquire IO manager.";
+                  result({}, std::move(flow));
+                  return;
+                }
+
+                auto uploaded =
+                    UploadCompressedTexture(texture, io_manager, flow);
+                if (!uploaded.skia_object()) {
+                  FML_DLOG(ERROR) << "Could not upload compressed texture.";
+                  result({}, std::move(flow));
+                  return;
+                }
+
+                if (cache_key &&
+                    IsCacheableUpload(uploaded.skia_object(), io_manager)) {
+                  cache->Put(*cache_key, std::move(data),
+                             uploaded.skia_object(),
+                             io_manager->GetSkiaUnrefQueue());
+                }
+                result(std::move(uploaded), std::move(flow));
+              }));
+          return;
+        }
+
         // Step 1: Decompress the image.
         // On Worker.
 
-        auto decompressed = raw_descriptor->is_compressed()
-                                ? ImageFromCompressedData(raw_descriptor,  //
-                                                          target_width,    //
-                                                          target_height,   //
-                                                          flow)
-                                : ImageFromDecompressedData(raw_descriptor,  //
-                                                            target_width,    //
-                                                            target_height,   //
-                                                            flow);
+        auto decompressed =
+            raw_descriptor->is_compressed()
+                ? ImageFromCompressedData(raw_descriptor,         //
+                                          target_width,           //
+                                          target_height,          //
+                                          flow,                   //
+                                          concurrent_task_runner  //
+                                          )
+                : ImageFromDecompressedData(raw_descriptor,  //
+                                            target_width,    //
+                                            target_height,   //
+                                            flow);
 
         if (!decompressed) {
           FML_DLOG(ERROR) << "Could not decompress image.";
@@ -295,6 +578,8 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
         // On IO Thread.
 
         io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                               cache, cache_key,
+                                               data = raw_descriptor->data(),
                                                flow =
                                                    std::move(flow)]() mutable {
           if (!io_manager) {
@@ -307,6 +592,10 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
           // might not have set one or a software backend could be in use.
           // Either way, just return the image as-is.
           if (!io_manager->GetResourceContext()) {
+            if (cache_key) {
+              cache->Put(*cache_key, std::move(data), decompressed,
+                         io_manager->GetSkiaUnrefQueue());
+            }
             result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
                    std::move(flow));
             return;
@@ -321,12 +610,100 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
             return;
           }
 
+          if (cache_key &&
+              IsCacheableUpload(uploaded.skia_object(), io_manager)) {
+            cache->Put(*cache_key, std::move(data), uploaded.skia_object(),
+                       io_manager->GetSkiaUnrefQueue());
+          }
+
           // Finally, all done.
           result(std::move(uploaded), std::move(flow));
         }));
       }));
 }
 
+void ImageDecoder::DecodeIncrementally(
+    std::shared_ptr<IncrementalImageGenerator> generator,
+    const IncrementalImageResult& callback) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  fml::tracing::TraceFlow flow(__FUNCTION__);
+
+  FML_DCHECK(callback);
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  // Always service the callback on the UI thread.
+  auto result = [callback, ui_runner = runners_.GetUITaskRunner()](
+                    IncrementalImageGenerator::Status status,
+                    SkiaGPUObject<SkImage> image,
+                    fml::tracing::TraceFlow flow) {
+    ui_runner->PostTask(
+        fml::MakeCopyable([callback, status, image = std::move(image),
+                           flow = std::move(flow)]() mutable {
+          // We are going to terminate the trace flow here. Flows cannot
+          // terminate without a base trace. Add one explicitly.
+          TRACE_EVENT0("flutter", "IncrementalImageDecodeCallback");
+          flow.End();
+          callback(status, std::move(image));
+        }));
+  };
+
+  concurrent_task_runner_->PostTask(
+      fml::MakeCopyable([generator = std::move(generator),       //
+                         io_manager = io_manager_,                //
+                         io_runner = runners_.GetIOTaskRunner(),  //
+                         result,                                  //
+                         flow = std::move(flow)                   //
+  ]() mutable {
+        // Step 1: Decode as much of the image as the bytes so far allow.
+        // On Worker.
+
+        flow.Step("IncrementalImageGenerator::Decode");
+        const auto status = generator->Decode();
+        auto image = generator->MakeImage();
+        if (!image) {
+          result(status, {}, std::move(flow));
+          return;
+        }
+
+        // Step 2: Upload the rows decoded so far to the GPU.
+        // On IO Thread.
+
+        io_runner->PostTask(fml::MakeCopyable([io_manager, status, image,
+                                               result,
+                                               flow =
+                                                   std::move(flow)]() mutable {
+          if (!io_manager) {
+            FML_DLOG(ERROR) << "Could not acquire IO manager.";
+            result(status, {}, std::move(flow));
+            return;
+          }
+
+          if (!io_manager->GetResourceContext()) {
+            result(status, {std::move(image), io_manager->GetSkiaUnrefQueue()},
+                   std::move(flow));
+            return;
+          }
+
+          auto uploaded = UploadRasterImage(std::move(image), io_manager, flow);
+          result(status, std::move(uploaded), std::move(flow));
+        }));
+      }));
+}
+
+void ImageDecoder::PurgeDecodedImageCache() {
+  decoded_image_cache_->Purge();
+}
+
+const std::shared_ptr<DecodedImageCache>& ImageDecoder::GetDecodedImageCache()
+    const {
+  return decoded_image_cache_;
+}
+
+const std::shared_ptr<fml::ConcurrentTaskRunner>&
+ImageDecoder::GetConcurrentTaskRunner() const {
+  return concurrent_task_runner_;
+}
+
 fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
 }
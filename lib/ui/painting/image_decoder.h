@@ -15,7 +15,9 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_descriptor.h"
+#include "flutter/lib/ui/painting/incremental_image_generator.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
@@ -31,10 +33,13 @@ namespace flutter {
 // occur in a frame pipeline.
 class ImageDecoder {
  public:
+  static constexpr size_t kDefaultDecodedImageCacheMaxBytes = 0;
+
   ImageDecoder(
       TaskRunners runners,
       std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-      fml::WeakPtr<IOManager> io_manager);
+      fml::WeakPtr<IOManager> io_manager,
+      size_t decoded_image_cache_max_bytes = kDefaultDecodedImageCacheMaxBytes);
 
   ~ImageDecoder();
 
@@ -45,25 +50,56 @@ class ImageDecoder {
   // concurrently. Texture upload is done on the IO thread and the result
   // returned back on the UI thread. On error, the texture is null but the
   // callback is guaranteed to return on the UI thread.
+  //
+  // Images decoded from the same bytes at the same target size are served from
+  // the decoded image cache instead of being decoded and uploaded again.
   void Decode(fml::RefPtr<ImageDescriptor> descriptor,
               uint32_t target_width,
               uint32_t target_height,
               const ImageResult& result);
 
+  using IncrementalImageResult =
+      std::function<void(IncrementalImageGenerator::Status,
+                         SkiaGPUObject<SkImage>)>;
+
+  // Decodes as much of the image as the bytes added to the generator so far
+  // allow on a worker thread and uploads the rows decoded so far on the IO
+  // thread. The result is returned on the UI thread. The image is null if no
+  // rows could be decoded yet. Passes must not overlap for the same generator.
+  void DecodeIncrementally(std::shared_ptr<IncrementalImageGenerator> generator,
+                           const IncrementalImageResult& result);
+
+  // Drops all images held by the decoded image cache. Images still referenced
+  // elsewhere stay alive.
+  void PurgeDecodedImageCache();
+
+  const std::shared_ptr<DecodedImageCache>& GetDecodedImageCache() const;
+
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& GetConcurrentTaskRunner()
+      const;
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  // Shared with in-flight decodes, which may outlive this object.
+  std::shared_ptr<DecodedImageCache> decoded_image_cache_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
-sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
-                                       uint32_t target_width,
-                                       uint32_t target_height,
-                                       const fml::tracing::TraceFlow& flow);
+// Decodes and resizes an image on the calling thread. If a concurrent task
+// runner is given, large images that are not resized are decoded in bands
+// in parallel, with the calling thread decoding bands as well.
+sk_sp<SkImage> ImageFromCompressedData(
+    ImageDescriptor* descriptor,
+    uint32_t target_width,
+    uint32_t target_height,
+    const fml::tracing::TraceFlow& flow,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner =
+        nullptr);
 
 }  // namespace flutter
 
@@ -4,6 +4,9 @@
 
 #include "flutter/lib/ui/painting/image_decoder.h"
 
+#include <atomic>
+#include <vector>
+
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -76,6 +79,10 @@ class TestIOManager final : public IOManager {
     return is_gpu_disabled_sync_switch_;
   }
 
+  void SetGpuDisabled(bool disabled) {
+    is_gpu_disabled_sync_switch_->SetSwitch(disabled);
+  }
+
   bool did_access_is_gpu_disabled_sync_switch_ = false;
 
  private:
@@ -450,6 +457,100 @@ TEST_F(ImageDecoderFixtureTest, CanDecodeWithResizes) {
   PostTaskSync(runners.GetUITaskRunner(), [&]() { image_decoder.reset(); });
 }
 
+TEST_F(ImageDecoderFixtureTest, ReusesImagesDecodedFromTheSameBytes) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<TestIOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+
+  // Setup the IO manager.
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+  });
+
+  // Setup the image decoder.
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager(),
+        /*decoded_image_cache_max_bytes=*/32 * 1024 * 1024);
+  });
+
+  // Decodes a fresh copy of the fixture, as if it was loaded again.
+  auto decode = [&](uint32_t target_width,
+                    uint32_t target_height) -> sk_sp<SkImage> {
+    sk_sp<SkImage> result;
+    runners.GetUITaskRunner()->PostTask([&]() {
+      auto fixture = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+      ASSERT_TRUE(fixture);
+      auto data = SkData::MakeWithCopy(fixture->data(), fixture->size());
+
+      ImageGeneratorRegistry registry;
+      std::shared_ptr<ImageGenerator> generator =
+          registry.CreateCompatibleGenerator(data);
+      ASSERT_TRUE(generator);
+
+      auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+          std::move(data), std::move(generator));
+
+      ImageDecoder::ImageResult callback = [&](SkiaGPUObject<SkImage> image) {
+        result = image.skia_object();
+        latch.Signal();
+      };
+      image_decoder->Decode(descriptor, target_width, target_height, callback);
+    });
+    latch.Wait();
+    return result;
+  };
+
+  auto first = decode(100, 100);
+  ASSERT_TRUE(first);
+  auto second = decode(100, 100);
+  ASSERT_EQ(first, second);
+
+  auto other_size = decode(50, 50);
+  ASSERT_TRUE(other_size);
+  ASSERT_NE(first, other_size);
+  ASSERT_EQ(image_decoder->GetDecodedImageCache()->GetEntryCount(), 2u);
+
+  PostTaskSync(runners.GetUITaskRunner(),
+               [&]() { image_decoder->PurgeDecodedImageCache(); });
+  ASSERT_EQ(image_decoder->GetDecodedImageCache()->GetEntryCount(), 0u);
+  auto after_purge = decode(100, 100);
+  ASSERT_TRUE(after_purge);
+  ASSERT_NE(first, after_purge);
+
+  // Images decoded while the GPU is disabled are not textures and must not be
+  // handed out once it is available again.
+  io_manager->SetGpuDisabled(true);
+  auto gpu_disabled = decode(50, 50);
+  ASSERT_TRUE(gpu_disabled);
+  ASSERT_FALSE(gpu_disabled->isTextureBacked());
+  ASSERT_EQ(image_decoder->GetDecodedImageCache()->GetEntryCount(), 1u);
+  io_manager->SetGpuDisabled(false);
+
+  // Textures must be collected on the IO thread.
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    first.reset();
+    second.reset();
+    other_size.reset();
+    after_purge.reset();
+    gpu_disabled.reset();
+  });
+
+  // Destroy the image decoder
+  PostTaskSync(runners.GetUITaskRunner(), [&]() { image_decoder.reset(); });
+
+  // Destroy the IO manager
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() { io_manager.reset(); });
+}
+
 // TODO(https://github.com/flutter/flutter/issues/81232) - disabled due to
 // flakiness
 TEST_F(ImageDecoderFixtureTest, DISABLED_CanResizeWithoutDecode) {
@@ -610,6 +711,80 @@ TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   assert_image(decode(300, 100));
 }
 
+TEST(ImageDecoderTest, LargeImagesDecodedInBandsMatchSerialDecodes) {
+  // Large enough to be split into bands.
+  SkBitmap source;
+  source.allocPixels(SkImageInfo::MakeN32Premul(2000, 1500));
+  for (int y = 0; y < source.height(); y++) {
+    for (int x = 0; x < source.width(); x++) {
+      *source.getAddr32(x, y) =
+          SkColorSetARGB(255, x * 255 / 2000, y * 255 / 1500, 128);
+    }
+  }
+  source.setImmutable();
+  auto data = SkImage::MakeFromBitmap(source)->encodeToData(
+      SkEncodedImageFormat::kJPEG, 90);
+  ASSERT_TRUE(data);
+
+  ImageGeneratorRegistry registry;
+  std::shared_ptr<ImageGenerator> generator =
+      registry.CreateCompatibleGenerator(data);
+  ASSERT_TRUE(generator);
+  ASSERT_TRUE(generator->SupportsBandDecoding());
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                         std::move(generator));
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto serial = ImageFromCompressedData(descriptor.get(), 2000, 1500,
+                                        fml::tracing::TraceFlow(""));
+  auto banded = ImageFromCompressedData(descriptor.get(), 2000, 1500,
+                                        fml::tracing::TraceFlow(""),
+                                        loop->GetTaskRunner());
+  loop->Terminate();
+  ASSERT_TRUE(serial);
+  ASSERT_TRUE(banded);
+  ASSERT_EQ(banded->dimensions(), SkISize::Make(2000, 1500));
+
+  SkPixmap serial_pixmap;
+  SkPixmap banded_pixmap;
+  ASSERT_TRUE(serial->peekPixels(&serial_pixmap));
+  ASSERT_TRUE(banded->peekPixels(&banded_pixmap));
+  ASSERT_EQ(serial_pixmap.info(), banded_pixmap.info());
+  // Chroma upsampling at the top of a band may differ very slightly.
+  for (int y = 0; y < serial_pixmap.height(); y++) {
+    for (int x = 0; x < serial_pixmap.width(); x++) {
+      const SkColor serial_color = serial_pixmap.getColor(x, y);
+      const SkColor banded_color = banded_pixmap.getColor(x, y);
+      ASSERT_NEAR(SkColorGetR(serial_color), SkColorGetR(banded_color), 2);
+      ASSERT_NEAR(SkColorGetG(serial_color), SkColorGetG(banded_color), 2);
+      ASSERT_NEAR(SkColorGetB(serial_color), SkColorGetB(banded_color), 2);
+    }
+  }
+}
+
+TEST(ImageDecoderTest, ProgressiveJpegsAreNotDecodedInBands) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+  ASSERT_TRUE(data);
+  ImageGeneratorRegistry registry;
+  ASSERT_TRUE(registry.CreateCompatibleGenerator(data)->SupportsBandDecoding());
+
+  // Mark the baseline frame as progressive. Only the header is read to tell
+  // whether bands can be decoded.
+  std::vector<uint8_t> bytes(data->bytes(), data->bytes() + data->size());
+  for (size_t i = 2; i + 3 < bytes.size();
+       i += 2 + ((bytes[i + 2] << 8) | bytes[i + 3])) {
+    ASSERT_EQ(bytes[i], 0xFF);
+    if (bytes[i + 1] == 0xC0) {
+      bytes[i + 1] = 0xC2;
+      break;
+    }
+  }
+  auto progressive_data = SkData::MakeWithCopy(bytes.data(), bytes.size());
+  auto generator = registry.CreateCompatibleGenerator(progressive_data);
+  ASSERT_TRUE(generator);
+  ASSERT_FALSE(generator->SupportsBandDecoding());
+}
+
 TEST_F(ImageDecoderFixtureTest,
        MultiFrameCodecCanBeCollectedBeforeIOTasksFinish) {
   // This test verifies that the MultiFrameCodec safely shares state between
@@ -765,5 +940,175 @@ TEST_F(ImageDecoderFixtureTest, MultiFrameCodecDidAccessGpuDisabledSyncSwitch) {
   PostTaskSync(runners.GetIOTaskRunner(), [&]() { io_manager.reset(); });
 }
 
+// Counts how many times each frame is decoded.
+class CountingImageGenerator : public ImageGenerator {
+ public:
+  explicit CountingImageGenerator(std::shared_ptr<ImageGenerator> generator)
+      : generator_(std::move(generator)),
+        decode_counts_(generator_->GetFrameCount()) {}
+
+  // |ImageGenerator|
+  const SkImageInfo& GetInfo() override { return generator_->GetInfo(); }
+
+  // |ImageGenerator|
+  unsigned int GetFrameCount() const override {
+    return generator_->GetFrameCount();
+  }
+
+  // |ImageGenerator|
+  unsigned int GetPlayCount() const override {
+    return generator_->GetPlayCount();
+  }
+
+  // |ImageGenerator|
+  const ImageGenerator::FrameInfo GetFrameInfo(
+      unsigned int frame_index) const override {
+    return generator_->GetFrameInfo(frame_index);
+  }
+
+  // |ImageGenerator|
+  SkISize GetScaledDimensions(float desired_scale) override {
+    return generator_->GetScaledDimensions(desired_scale);
+  }
+
+  // |ImageGenerator|
+  bool GetPixels(const SkImageInfo& info,
+                 void* pixels,
+                 size_t row_bytes,
+                 unsigned int frame_index,
+                 std::optional<unsigned int> prior_frame) override {
+    decode_counts_[frame_index]++;
+    return generator_->GetPixels(info, pixels, row_bytes, frame_index,
+                                 prior_frame);
+  }
+
+  int GetDecodeCount(unsigned int frame_index) const {
+    return decode_counts_[frame_index];
+  }
+
+ private:
+  const std::shared_ptr<ImageGenerator> generator_;
+  std::vector<std::atomic_int> decode_counts_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(CountingImageGenerator);
+};
+
+TEST_F(ImageDecoderFixtureTest, MultiFrameCodecDecodesEachCachedFrameOnce) {
+  auto settings = CreateSettingsForFixture();
+  auto vm_ref = DartVMRef::Create(settings);
+  auto vm_data = vm_ref.GetVMData();
+
+  auto gif_mapping = OpenFixtureAsSkData("hello_loop_2.gif");
+
+  ASSERT_TRUE(gif_mapping);
+
+  ImageGeneratorRegistry registry;
+  auto gif_generator = std::make_shared<CountingImageGenerator>(
+      registry.CreateCompatibleGenerator(gif_mapping));
+  const int frame_count = gif_generator->GetFrameCount();
+  ASSERT_GT(frame_count, 1);
+
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  std::unique_ptr<TestIOManager> io_manager;
+  fml::RefPtr<MultiFrameCodec> codec;
+  auto frame_cache = std::make_shared<DecodedImageCache>(256 * 1024 * 1024);
+  auto look_ahead_loop = fml::ConcurrentMessageLoop::Create(1);
+
+  // Setup the IO manager.
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+  });
+
+  auto isolate = RunDartCodeInIsolate(vm_ref, settings, runners, "main", {},
+                                      GetDefaultKernelFilePath(),
+                                      io_manager->GetWeakIOManager());
+
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    EXPECT_TRUE(isolate->RunInIsolateScope([&]() -> bool {
+      Dart_Handle library = Dart_RootLibrary();
+      if (Dart_IsError(library)) {
+        return false;
+      }
+      Dart_Handle closure =
+          Dart_GetField(library, Dart_NewStringFromCString("frameCallback"));
+      if (Dart_IsError(closure) || !Dart_IsClosure(closure)) {
+        return false;
+      }
+
+      codec = fml::MakeRefCounted<MultiFrameCodec>(
+          gif_generator, gif_mapping, frame_cache,
+          look_ahead_loop->GetTaskRunner());
+      // Every frame after the first is decoded ahead of time. The second loop
+      // is served from the frame cache.
+      for (int i = 0; i < 2 * frame_count; i++) {
+        codec->getNextFrame(closure);
+        PostTaskSync(runners.GetIOTaskRunner(), [] {});
+      }
+      return true;
+    }));
+  });
+
+  for (int i = 0; i < frame_count; i++) {
+    EXPECT_EQ(gif_generator->GetDecodeCount(i), 1) << i;
+  }
+  EXPECT_EQ(frame_cache->GetEntryCount(), static_cast<size_t>(frame_count));
+
+  // Destroy the Isolate
+  isolate = nullptr;
+
+  // Destroy the MultiFrameCodec
+  PostTaskSync(runners.GetUITaskRunner(), [&]() { codec = nullptr; });
+
+  // Release the cached frames and destroy the IO manager
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    frame_cache->Purge();
+    io_manager.reset();
+  });
+}
+
+TEST_F(ImageDecoderFixtureTest, MultiFrameCodecCountsTheLookAheadFrame) {
+  auto gif_mapping = OpenFixtureAsSkData("hello_loop_2.gif");
+  ASSERT_TRUE(gif_mapping);
+
+  ImageGeneratorRegistry registry;
+  std::shared_ptr<ImageGenerator> gif_generator =
+      registry.CreateCompatibleGenerator(gif_mapping);
+  ASSERT_TRUE(gif_generator);
+  const size_t frame_bytes = gif_generator->GetInfo()
+                                 .makeColorType(kN32_SkColorType)
+                                 .computeMinByteSize();
+  const size_t animation_bytes =
+      gif_mapping->size() + gif_generator->GetFrameCount() * frame_bytes;
+  auto look_ahead_loop = fml::ConcurrentMessageLoop::Create(1);
+
+  auto without_look_ahead = fml::MakeRefCounted<MultiFrameCodec>(
+      gif_generator, gif_mapping,
+      std::make_shared<DecodedImageCache>(MultiFrameCodec::kMaxFrameCacheShare *
+                                          animation_bytes));
+  // All of the frames fit in the share of the cache, but not together with
+  // the frame decoded ahead of time.
+  auto not_caching = fml::MakeRefCounted<MultiFrameCodec>(
+      gif_generator, gif_mapping,
+      std::make_shared<DecodedImageCache>(MultiFrameCodec::kMaxFrameCacheShare *
+                                          animation_bytes),
+      look_ahead_loop->GetTaskRunner());
+  auto caching = fml::MakeRefCounted<MultiFrameCodec>(
+      gif_generator, gif_mapping,
+      std::make_shared<DecodedImageCache>(MultiFrameCodec::kMaxFrameCacheShare *
+                                          (animation_bytes + frame_bytes)),
+      look_ahead_loop->GetTaskRunner());
+
+  EXPECT_EQ(not_caching->GetAllocationSize(),
+            without_look_ahead->GetAllocationSize());
+  EXPECT_EQ(caching->GetAllocationSize(),
+            without_look_ahead->GetAllocationSize() + frame_bytes);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -134,7 +134,15 @@ void ImageDescriptor::instantiateCodec(Dart_Handle codec_handle,
         static_cast<fml::RefPtr<ImageDescriptor>>(this), target_width,
         target_height);
   } else {
-    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(generator_);
+    std::shared_ptr<DecodedImageCache> frame_cache;
+    std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner;
+    if (auto decoder = UIDartState::Current()->GetImageDecoder()) {
+      frame_cache = decoder->GetDecodedImageCache();
+      look_ahead_task_runner = decoder->GetConcurrentTaskRunner();
+    }
+    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(
+        generator_, buffer_, std::move(frame_cache),
+        std::move(look_ahead_task_runner));
   }
   ui_codec->AssociateWithDartWrapper(codec_handle);
 }
@@ -149,4 +157,20 @@ bool ImageDescriptor::get_pixels(const SkPixmap& pixmap) const {
                                pixmap.rowBytes());
 }
 
+bool ImageDescriptor::get_scanlines(
+    const SkImageInfo& info,
+    const ImageGenerator::ScanlineCallback& callback) const {
+  FML_DCHECK(generator_);
+  return generator_->GetScanlines(info, callback);
+}
+
+bool ImageDescriptor::get_band_pixels(const SkPixmap& pixmap,
+                                      int first_row,
+                                      int row_count) const {
+  FML_DCHECK(generator_);
+  return generator_->GetBandPixels(pixmap.info(),
+                                   pixmap.writable_addr(0, first_row),
+                                   pixmap.rowBytes(), first_row, row_count);
+}
+
 }  // namespace flutter
@@ -106,6 +106,36 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   ///         orientation tag, if applicable.
   bool get_pixels(const SkPixmap& pixmap) const;
 
+  /// @brief  Decodes the rows of this image one at a time, if the backing
+  ///         `ImageGenerator` supports it.
+  /// @see    `ImageGenerator::GetScanlines`
+  bool get_scanlines(const SkImageInfo& info,
+                     const ImageGenerator::ScanlineCallback& callback) const;
+
+  /// @brief  Whether bands of rows of this image can be decoded separately.
+  /// @see    `ImageGenerator::SupportsBandDecoding`
+  bool supports_band_decoding() const {
+    return generator_ && generator_->SupportsBandDecoding();
+  }
+
+  /// @brief  Decodes a band of rows of this image. Bands that do not overlap
+  ///         may be decoded concurrently.
+  /// @see    `ImageGenerator::GetBandPixels`
+  bool get_band_pixels(const SkPixmap& pixmap,
+                       int first_row,
+                       int row_count) const;
+
+  /// @brief  The compressed texture blocks of this image, if it is stored in a
+  ///         format that can be uploaded without decoding it.
+  /// @see    `ImageGenerator::GetCompressedTexture`
+  std::optional<ImageGenerator::CompressedTexture> get_compressed_texture()
+      const {
+    if (generator_) {
+      return generator_->GetCompressedTexture();
+    }
+    return std::nullopt;
+  }
+
   void dispose() {
     buffer_.reset();
     generator_.reset();
@@ -0,0 +1,320 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_downscaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FLUTTER_DOWNSCALER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLUTTER_DOWNSCALER_NEON 1
+#endif
+
+namespace flutter {
+
+namespace {
+
+constexpr size_t kChannels = 4;
+
+// Keeps the per column sums of a box within 16 bits (255 * 128 < 65536).
+constexpr int kMaxBoxSize = 128;
+
+// Bilinear weights are 7 bits so that a weighted pair of 8 bit channels still
+// fits within 16 bits.
+constexpr int kWeightBits = 7;
+constexpr int kWeightOne = 1 << kWeightBits;
+
+// sums[i] += row[i] for `count` channels.
+void AccumulateRow(const uint8_t* row, uint16_t* sums, size_t count) {
+  size_t i = 0;
+#if FLUTTER_DOWNSCALER_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    const __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    __m128i* lo = reinterpret_cast<__m128i*>(sums + i);
+    __m128i* hi = reinterpret_cast<__m128i*>(sums + i + 8);
+    _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo),
+                                       _mm_unpacklo_epi8(pixels, zero)));
+    _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi),
+                                       _mm_unpackhi_epi8(pixels, zero)));
+  }
+#elif FLUTTER_DOWNSCALER_NEON
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t pixels = vld1q_u8(row + i);
+    vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(pixels)));
+    vst1q_u16(sums + i + 8,
+              vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(pixels)));
+  }
+#endif
+  for (; i < count; i++) {
+    sums[i] += row[i];
+  }
+}
+
+// result[i] = top[i] * (kWeightOne - bottom_weight) + bottom[i] * bottom_weight
+// for `count` channels.
+void LerpRows(const uint8_t* top,
+              const uint8_t* bottom,
+              int bottom_weight,
+              uint16_t* result,
+              size_t count) {
+  const int top_weight = kWeightOne - bottom_weight;
+  size_t i = 0;
+#if FLUTTER_DOWNSCALER_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i top_weights = _mm_set1_epi16(top_weight);
+  const __m128i bottom_weights = _mm_set1_epi16(bottom_weight);
+  for (; i + 16 <= count; i += 16) {
+    const __m128i t =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+    const __m128i lo = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(t, zero), top_weights),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), bottom_weights));
+    const __m128i hi = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(t, zero), top_weights),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), bottom_weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i + 8), hi);
+  }
+#elif FLUTTER_DOWNSCALER_NEON
+  const uint8x8_t top_weights = vdup_n_u8(top_weight);
+  const uint8x8_t bottom_weights = vdup_n_u8(bottom_weight);
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t t = vld1q_u8(top + i);
+    const uint8x16_t b = vld1q_u8(bottom + i);
+    vst1q_u16(result + i,
+              vmlal_u8(vmull_u8(vget_low_u8(t), top_weights), vget_low_u8(b),
+                       bottom_weights));
+    vst1q_u16(result + i + 8,
+              vmlal_u8(vmull_u8(vget_high_u8(t), top_weights),
+                       vget_high_u8(b), bottom_weights));
+  }
+#endif
+  for (; i < count; i++) {
+    result[i] = top[i] * top_weight + bottom[i] * bottom_weight;
+  }
+}
+
+// Where a destination pixel samples the reduced image along one axis.
+struct Sample {
+  int first;
+  int second;
+  int second_weight;
+};
+
+// The number of boxes of `box_size` needed to cover `source_size` pixels. The
+// last box may be partial.
+int ReducedSize(int source_size, int box_size) {
+  return (source_size + box_size - 1) / box_size;
+}
+
+std::vector<Sample> ComputeSamples(int source_size,
+                                   int box_size,
+                                   int scaled_size) {
+  const int reduced_size = ReducedSize(source_size, box_size);
+  // Where the center of each reduced pixel lies in the source, accounting for
+  // the last box being partial.
+  auto center = [&](int index) {
+    const int start = index * box_size;
+    return (start + std::min(start + box_size, source_size)) / 2.0;
+  };
+
+  std::vector<Sample> samples(scaled_size);
+  const double scale = static_cast<double>(source_size) / scaled_size;
+  for (int i = 0; i < scaled_size; i++) {
+    if (reduced_size == 1) {
+      samples[i] = {.first = 0, .second = 0, .second_weight = 0};
+      continue;
+    }
+    const double position = (i + 0.5) * scale;
+    const int first = std::clamp(
+        static_cast<int>(std::floor(position / box_size - 0.5)), 0,
+        reduced_size - 2);
+    const double fraction =
+        std::clamp((position - center(first)) /
+                       (center(first + 1) - center(first)),
+                   0.0, 1.0);
+    samples[i] = {
+        .first = first,
+        .second = first + 1,
+        .second_weight = static_cast<int>(std::lround(fraction * kWeightOne)),
+    };
+  }
+  return samples;
+}
+
+int BoxSize(int source_size, int scaled_size) {
+  return std::clamp(source_size / std::max(scaled_size, 1), 1, kMaxBoxSize);
+}
+
+}  // namespace
+
+bool ImageDownscaler::CanDownscale(const SkImageInfo& source_info,
+                                   const SkISize& scaled_dimensions) {
+  if (source_info.colorType() != kRGBA_8888_SkColorType &&
+      source_info.colorType() != kBGRA_8888_SkColorType) {
+    return false;
+  }
+  // Averaging unpremultiplied colors would bleed the color of transparent
+  // pixels into their neighbors.
+  if (source_info.alphaType() != kPremul_SkAlphaType &&
+      source_info.alphaType() != kOpaque_SkAlphaType) {
+    return false;
+  }
+  return !scaled_dimensions.isEmpty() && !source_info.isEmpty() &&
+         scaled_dimensions.width() <= source_info.width() &&
+         scaled_dimensions.height() <= source_info.height();
+}
+
+sk_sp<SkImage> ImageDownscaler::Downscale(const SkPixmap& source,
+                                          const SkISize& scaled_dimensions) {
+  TRACE_EVENT0("flutter", "ImageDownscaler::Downscale");
+  if (!CanDownscale(source.info(), scaled_dimensions)) {
+    return nullptr;
+  }
+  ImageDownscaler downscaler(source.info(), scaled_dimensions);
+  if (!downscaler.IsValid()) {
+    return nullptr;
+  }
+  for (int y = 0; y < source.height(); y++) {
+    downscaler.AddRow(source.addr(0, y));
+  }
+  return downscaler.MakeImage();
+}
+
+ImageDownscaler::ImageDownscaler(const SkImageInfo& source_info,
+                                 const SkISize& scaled_dimensions)
+    : source_info_(source_info),
+      scaled_dimensions_(scaled_dimensions),
+      box_width_(BoxSize(source_info.width(), scaled_dimensions.width())),
+      box_height_(BoxSize(source_info.height(), scaled_dimensions.height())) {
+  FML_DCHECK(CanDownscale(source_info, scaled_dimensions));
+  const auto reduced_info =
+      source_info_.makeWH(ReducedSize(source_info_.width(), box_width_),
+                          ReducedSize(source_info_.height(), box_height_));
+  if (!reduced_bitmap_.tryAllocPixels(reduced_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << reduced_info.computeMinByteSize() << "B";
+    return;
+  }
+  column_sums_.resize(source_info_.width() * kChannels);
+}
+
+ImageDownscaler::~ImageDownscaler() = default;
+
+bool ImageDownscaler::IsValid() const {
+  return !reduced_bitmap_.drawsNothing();
+}
+
+void ImageDownscaler::AddRow(const void* row) {
+  FML_DCHECK(IsValid());
+  FML_DCHECK(rows_added_ < source_info_.height());
+  AccumulateRow(static_cast<const uint8_t*>(row), column_sums_.data(),
+                column_sums_.size());
+  rows_added_++;
+  if (rows_added_ % box_height_ == 0 ||
+      rows_added_ == source_info_.height()) {
+    EmitReducedRow();
+  }
+}
+
+void ImageDownscaler::EmitReducedRow() {
+  auto* reduced_row =
+      static_cast<uint8_t*>(reduced_bitmap_.getAddr(0, reduced_rows_));
+  // The boxes in the last row and column may be partial.
+  const int box_height = rows_added_ - reduced_rows_ * box_height_;
+  const uint16_t* sums = column_sums_.data();
+  for (int x = 0; x < reduced_bitmap_.width(); x++) {
+    const int box_width =
+        std::min(box_width_, source_info_.width() - x * box_width_);
+    const uint32_t box_area = box_width * box_height;
+    uint32_t totals[kChannels] = {};
+    for (int i = 0; i < box_width; i++) {
+      for (size_t c = 0; c < kChannels; c++) {
+        totals[c] += sums[c];
+      }
+      sums += kChannels;
+    }
+    for (size_t c = 0; c < kChannels; c++) {
+      reduced_row[c] = (totals[c] + box_area / 2) / box_area;
+    }
+    reduced_row += kChannels;
+  }
+  std::fill(column_sums_.begin(), column_sums_.end(), 0);
+  reduced_rows_++;
+}
+
+sk_sp<SkImage> ImageDownscaler::MakeImage() {
+  TRACE_EVENT0("flutter", "ImageDownscaler::MakeImage");
+  if (!IsValid() || reduced_rows_ != reduced_bitmap_.height()) {
+    FML_LOG(ERROR) << "Not all rows of the image were added to the downscaler.";
+    return nullptr;
+  }
+
+  // Boxes are limited to kMaxBoxSize, so the reduced image may still be more
+  // than twice the scaled size. Resampling it with a bilinear filter would
+  // skip some of its pixels, so it is reduced again first.
+  if (reduced_bitmap_.width() > 2 * scaled_dimensions_.width() ||
+      reduced_bitmap_.height() > 2 * scaled_dimensions_.height()) {
+    ImageDownscaler downscaler(reduced_bitmap_.info(), scaled_dimensions_);
+    if (!downscaler.IsValid()) {
+      return nullptr;
+    }
+    for (int y = 0; y < reduced_bitmap_.height(); y++) {
+      downscaler.AddRow(reduced_bitmap_.getAddr(0, y));
+    }
+    return downscaler.MakeImage();
+  }
+
+  const auto scaled_info = source_info_.makeDimensions(scaled_dimensions_);
+  SkBitmap scaled_bitmap;
+  if (!scaled_bitmap.tryAllocPixels(scaled_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << scaled_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  const auto columns = ComputeSamples(source_info_.width(), box_width_,
+                                      scaled_dimensions_.width());
+  const auto rows = ComputeSamples(source_info_.height(), box_height_,
+                                   scaled_dimensions_.height());
+  std::vector<uint16_t> blended_row(reduced_bitmap_.width() * kChannels);
+  constexpr int kRounding = 1 << (2 * kWeightBits - 1);
+  for (int y = 0; y < scaled_dimensions_.height(); y++) {
+    const auto& row = rows[y];
+    LerpRows(static_cast<const uint8_t*>(reduced_bitmap_.getAddr(0, row.first)),
+             static_cast<const uint8_t*>(
+                 reduced_bitmap_.getAddr(0, row.second)),
+             row.second_weight, blended_row.data(), blended_row.size());
+    auto* scaled_row = static_cast<uint8_t*>(scaled_bitmap.getAddr(0, y));
+    for (const auto& column : columns) {
+      const uint16_t* first = &blended_row[column.first * kChannels];
+      const uint16_t* second = &blended_row[column.second * kChannels];
+      const int first_weight = kWeightOne - column.second_weight;
+      for (size_t c = 0; c < kChannels; c++) {
+        scaled_row[c] = (first[c] * first_weight +
+                         second[c] * column.second_weight + kRounding) >>
+                        (2 * kWeightBits);
+      }
+      scaled_row += kChannels;
+    }
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  scaled_bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(scaled_bitmap);
+}
+
+}  // namespace flutter
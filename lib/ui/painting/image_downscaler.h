@@ -0,0 +1,100 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_DOWNSCALER_H_
+#define FLUTTER_LIB_UI_PAINTING_IMAGE_DOWNSCALER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Shrinks 8888 images to a target size without holding on to the
+///             full resolution pixels.
+///
+///             Source rows are summed into an integer box filter as they are
+///             added, which reduces the image to at most twice the target size
+///             in each dimension. Boxes are at most 128 pixels wide and tall,
+///             so the reduced image of a larger reduction is box filtered
+///             again. The reduced image is then resampled to the target size
+///             with a bilinear filter. This means the rows of a
+///             decoder can be fed in one at a time so that the full resolution
+///             image never needs to be allocated.
+///
+///             The inner loops use SSE2 on x86 and NEON on ARM, with a scalar
+///             fallback everywhere else.
+///
+class ImageDownscaler {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Whether images described by `source_info` can be shrunk to
+  ///             `scaled_dimensions` by this class. Only premultiplied or
+  ///             opaque RGBA and BGRA 8888 images that are not being enlarged
+  ///             are supported.
+  ///
+  static bool CanDownscale(const SkImageInfo& source_info,
+                           const SkISize& scaled_dimensions);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Shrinks all of the pixels in `source` at once.
+  ///
+  /// @return     The scaled image, or null if the pixels could not be scaled.
+  ///
+  static sk_sp<SkImage> Downscale(const SkPixmap& source,
+                                  const SkISize& scaled_dimensions);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Prepares to shrink an image described by `source_info`, whose
+  ///             rows will be added one at a time. `CanDownscale` must be true
+  ///             for the arguments.
+  ///
+  ImageDownscaler(const SkImageInfo& source_info,
+                  const SkISize& scaled_dimensions);
+
+  ~ImageDownscaler();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether memory for the reduced image could be allocated.
+  ///
+  bool IsValid() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Adds the next row of source pixels. Rows must be added from
+  ///             top to bottom and each must be `source_info.minRowBytes()`
+  ///             long. The row is not referenced after this call returns.
+  ///
+  void AddRow(const void* row);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Resamples the rows added so far to the scaled dimensions.
+  ///
+  /// @return     The scaled image, or null if not all rows were added.
+  ///
+  sk_sp<SkImage> MakeImage();
+
+ private:
+  const SkImageInfo source_info_;
+  const SkISize scaled_dimensions_;
+  const int box_width_;
+  const int box_height_;
+  SkBitmap reduced_bitmap_;
+  std::vector<uint16_t> column_sums_;
+  int rows_added_ = 0;
+  int reduced_rows_ = 0;
+
+  void EmitReducedRow();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ImageDownscaler);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_DOWNSCALER_H_
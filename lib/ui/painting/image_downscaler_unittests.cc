@@ -0,0 +1,176 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_downscaler.h"
+
+#include <cstdlib>
+
+#include "flutter/lib/ui/painting/image_generator_registry.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkColor.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+sk_sp<SkData> OpenFixtureAsSkData(const char* name) {
+  auto mapping = OpenFixtureAsMapping(name);
+  if (!mapping) {
+    return nullptr;
+  }
+  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+}
+
+// Red increases from left to right and green from top to bottom.
+SkBitmap MakeGradientBitmap(int width, int height) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::MakeN32Premul(width, height));
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      *bitmap.getAddr32(x, y) = SkPreMultiplyARGB(
+          255, x * 255 / (width - 1), y * 255 / (height - 1), 128);
+    }
+  }
+  bitmap.setImmutable();
+  return bitmap;
+}
+
+// The largest difference between any channel of the two images.
+int MaxChannelDifference(const sk_sp<SkImage>& a, const sk_sp<SkImage>& b) {
+  SkPixmap a_pixmap;
+  SkPixmap b_pixmap;
+  FML_CHECK(a->peekPixels(&a_pixmap) && b->peekPixels(&b_pixmap));
+  FML_CHECK(a->dimensions() == b->dimensions());
+  int difference = 0;
+  for (int y = 0; y < a->height(); y++) {
+    for (int x = 0; x < a->width(); x++) {
+      const auto* a_pixel = static_cast<const uint8_t*>(a_pixmap.addr(x, y));
+      const auto* b_pixel = static_cast<const uint8_t*>(b_pixmap.addr(x, y));
+      for (int c = 0; c < 4; c++) {
+        difference = std::max(difference, std::abs(a_pixel[c] - b_pixel[c]));
+      }
+    }
+  }
+  return difference;
+}
+
+}  // namespace
+
+TEST(ImageDownscalerTest, OnlyDownscales8888PremulImages) {
+  const auto info = SkImageInfo::MakeN32Premul(100, 50);
+  ASSERT_TRUE(ImageDownscaler::CanDownscale(info, {10, 5}));
+  ASSERT_TRUE(ImageDownscaler::CanDownscale(info, {100, 50}));
+  ASSERT_TRUE(ImageDownscaler::CanDownscale(
+      info.makeAlphaType(kOpaque_SkAlphaType), {10, 5}));
+  ASSERT_FALSE(ImageDownscaler::CanDownscale(info, {200, 5}));
+  ASSERT_FALSE(ImageDownscaler::CanDownscale(info, {0, 5}));
+  ASSERT_FALSE(ImageDownscaler::CanDownscale(
+      info.makeAlphaType(kUnpremul_SkAlphaType), {10, 5}));
+  ASSERT_FALSE(ImageDownscaler::CanDownscale(
+      info.makeColorType(kRGB_565_SkColorType), {10, 5}));
+}
+
+TEST(ImageDownscalerTest, AveragesWholeBoxes) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::MakeN32Premul(4, 2));
+  bitmap.eraseColor(SK_ColorBLACK);
+  // The left box averages to mid-gray and the right one to transparent.
+  *bitmap.getAddr32(0, 0) = SK_ColorWHITE;
+  *bitmap.getAddr32(1, 1) = SK_ColorWHITE;
+  bitmap.erase(SK_ColorTRANSPARENT, SkIRect::MakeLTRB(2, 0, 4, 2));
+
+  auto image = ImageDownscaler::Downscale(bitmap.pixmap(), {2, 1});
+  ASSERT_TRUE(image);
+  ASSERT_EQ(image->dimensions(), SkISize::Make(2, 1));
+  SkPixmap pixmap;
+  ASSERT_TRUE(image->peekPixels(&pixmap));
+  ASSERT_EQ(pixmap.getColor(0, 0), SkColorSetARGB(255, 128, 128, 128));
+  ASSERT_EQ(pixmap.getColor(1, 0), SK_ColorTRANSPARENT);
+}
+
+TEST(ImageDownscalerTest, SamplesGradientsAtPixelCenters) {
+  const int width = 1201;
+  const int height = 803;
+  const auto bitmap = MakeGradientBitmap(width, height);
+  for (const auto& dimensions :
+       {SkISize{1201, 803}, SkISize{1000, 700}, SkISize{300, 200},
+        SkISize{64, 64}, SkISize{1, 1}}) {
+    auto image = ImageDownscaler::Downscale(bitmap.pixmap(), dimensions);
+    ASSERT_TRUE(image);
+    ASSERT_EQ(image->dimensions(), dimensions);
+    SkPixmap pixmap;
+    ASSERT_TRUE(image->peekPixels(&pixmap));
+    for (int y = 0; y < dimensions.height(); y++) {
+      for (int x = 0; x < dimensions.width(); x++) {
+        // Where the center of the scaled pixel lies in the source image.
+        const double source_x = (x + 0.5) * width / dimensions.width() - 0.5;
+        const double source_y = (y + 0.5) * height / dimensions.height() - 0.5;
+        const SkColor color = pixmap.getColor(x, y);
+        ASSERT_NEAR(SkColorGetR(color), source_x * 255 / (width - 1), 2);
+        ASSERT_NEAR(SkColorGetG(color), source_y * 255 / (height - 1), 2);
+        ASSERT_EQ(SkColorGetB(color), 128u);
+        ASSERT_EQ(SkColorGetA(color), 255u);
+      }
+    }
+  }
+}
+
+TEST(ImageDownscalerTest, AveragesAllPixelsOfLargeReductions) {
+  // Every fourth run of 128 columns is white. Scaled to 16 columns, each
+  // pixel covers 512 columns, a quarter of which are white.
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::MakeN32Premul(8192, 4));
+  bitmap.eraseColor(SK_ColorBLACK);
+  for (int x = 0; x < bitmap.width(); x += 512) {
+    bitmap.erase(SK_ColorWHITE, SkIRect::MakeXYWH(x, 0, 128, 4));
+  }
+
+  auto image = ImageDownscaler::Downscale(bitmap.pixmap(), {16, 1});
+  ASSERT_TRUE(image);
+  ASSERT_EQ(image->dimensions(), SkISize::Make(16, 1));
+  SkPixmap pixmap;
+  ASSERT_TRUE(image->peekPixels(&pixmap));
+  for (int x = 0; x < 16; x++) {
+    ASSERT_EQ(pixmap.getColor(x, 0), SkColorSetARGB(255, 64, 64, 64)) << x;
+  }
+}
+
+TEST(ImageDownscalerTest, NeedsAllRows) {
+  const auto bitmap = MakeGradientBitmap(40, 40);
+  ImageDownscaler downscaler(bitmap.info(), {10, 10});
+  ASSERT_TRUE(downscaler.IsValid());
+  for (int y = 0; y < 20; y++) {
+    downscaler.AddRow(bitmap.getAddr(0, y));
+  }
+  ASSERT_FALSE(downscaler.MakeImage());
+}
+
+TEST(ImageDownscalerTest, DownscalesDecodedScanlines) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+  ASSERT_TRUE(data);
+  ImageGeneratorRegistry registry;
+  auto generator = registry.CreateCompatibleGenerator(data);
+  ASSERT_TRUE(generator);
+
+  const auto info = generator->GetInfo().makeAlphaType(kPremul_SkAlphaType);
+  const SkISize dimensions = {info.width() / 5, info.height() / 5};
+  ImageDownscaler downscaler(info, dimensions);
+  ASSERT_TRUE(downscaler.IsValid());
+  ASSERT_TRUE(generator->GetScanlines(
+      info, [&downscaler](const void* row) { downscaler.AddRow(row); }));
+  auto image = downscaler.MakeImage();
+  ASSERT_TRUE(image);
+
+  SkBitmap bitmap;
+  bitmap.allocPixels(info);
+  ASSERT_TRUE(generator->GetPixels(info, bitmap.getPixels(),
+                                   bitmap.rowBytes()));
+  ASSERT_EQ(MaxChannelDifference(
+                image, ImageDownscaler::Downscale(bitmap.pixmap(), dimensions)),
+            0);
+}
+
+}  // namespace testing
+}  // namespace flutter
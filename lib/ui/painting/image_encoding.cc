@@ -13,7 +13,10 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/skia/include/encode/SkPngEncoder.h"
 #include "third_party/tonic/dart_persistent_value.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 #include "third_party/tonic/typed_data/typed_list.h"
@@ -31,6 +34,8 @@ enum ImageByteFormat {
   kRawStraightRGBA,
   kRawUnmodified,
   kPNG,
+  kJPEG,
+  kWebP,
 };
 
 void FinalizeSkData(void* isolate_callback_data, void* peer) {
@@ -158,7 +163,62 @@ sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
   return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
 }
 
-sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
+SkPngEncoder::FilterFlag ToSkPngFilterFlags(ParallelPngEncoder::Filter filter) {
+  switch (filter) {
+    case ParallelPngEncoder::Filter::kNone:
+      return SkPngEncoder::FilterFlag::kNone;
+    case ParallelPngEncoder::Filter::kSub:
+      return SkPngEncoder::FilterFlag::kSub;
+    case ParallelPngEncoder::Filter::kUp:
+      return SkPngEncoder::FilterFlag::kUp;
+    case ParallelPngEncoder::Filter::kAverage:
+      return SkPngEncoder::FilterFlag::kAvg;
+    case ParallelPngEncoder::Filter::kPaeth:
+      return SkPngEncoder::FilterFlag::kPaeth;
+    case ParallelPngEncoder::Filter::kAdaptive:
+      return SkPngEncoder::FilterFlag::kAll;
+  }
+  return SkPngEncoder::FilterFlag::kAll;
+}
+
+sk_sp<SkData> EncodePNG(
+    const sk_sp<SkImage>& raster_image,
+    const ParallelPngEncoder::Options& options,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  // PNGs store unpremultiplied pixels.
+  const SkImageInfo info =
+      raster_image->imageInfo()
+          .makeColorType(kRGBA_8888_SkColorType)
+          .makeAlphaType(raster_image->isOpaque() ? kOpaque_SkAlphaType
+                                                  : kUnpremul_SkAlphaType);
+  SkBitmap bitmap;
+  if (ParallelPngEncoder::CanEncode(info) && bitmap.tryAllocPixels(info) &&
+      raster_image->readPixels(nullptr, bitmap.pixmap(), 0, 0)) {
+    return ParallelPngEncoder::Encode(bitmap.pixmap(), options,
+                                      concurrent_task_runner);
+  }
+
+  // Images in other color spaces are encoded by Skia, which embeds their
+  // color profile.
+  SkPixmap pixmap;
+  if (!raster_image->peekPixels(&pixmap)) {
+    return nullptr;
+  }
+  SkPngEncoder::Options png_options;
+  png_options.fZLibLevel = options.compression_level;
+  png_options.fFilterFlags = ToSkPngFilterFlags(options.filter);
+  SkDynamicMemoryWStream stream;
+  if (!SkPngEncoder::Encode(&stream, pixmap, png_options)) {
+    return nullptr;
+  }
+  return stream.detachAsData();
+}
+
+sk_sp<SkData> EncodeImage(
+    sk_sp<SkImage> raster_image,
+    ImageByteFormat format,
+    const ImageEncodingOptions& options,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
   TRACE_EVENT0("flutter", __FUNCTION__);
 
   if (!raster_image) {
@@ -168,7 +228,7 @@ sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
   switch (format) {
     case kPNG: {
       auto png_image =
-          raster_image->encodeToData(SkEncodedImageFormat::kPNG, 0);
+          EncodePNG(raster_image, options.png, concurrent_task_runner);
 
       if (png_image == nullptr) {
         FML_LOG(ERROR) << "Could not convert raster image to PNG.";
@@ -176,6 +236,28 @@ sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
       };
       return png_image;
     } break;
+    case kJPEG: {
+      // JPEGs have no alpha channel. Since the pixels are premultiplied,
+      // transparent pixels become black.
+      auto jpeg_image = raster_image->encodeToData(SkEncodedImageFormat::kJPEG,
+                                                   options.quality);
+
+      if (jpeg_image == nullptr) {
+        FML_LOG(ERROR) << "Could not convert raster image to JPEG.";
+        return nullptr;
+      };
+      return jpeg_image;
+    } break;
+    case kWebP: {
+      auto webp_image = raster_image->encodeToData(SkEncodedImageFormat::kWEBP,
+                                                   options.quality);
+
+      if (webp_image == nullptr) {
+        FML_LOG(ERROR) << "Could not convert raster image to WebP.";
+        return nullptr;
+      };
+      return webp_image;
+    } break;
     case kRawRGBA: {
       return CopyImageByteData(raster_image, kRGBA_8888_SkColorType,
                                kPremul_SkAlphaType);
@@ -198,6 +280,8 @@ void EncodeImageAndInvokeDataCallback(
     sk_sp<SkImage> image,
     std::unique_ptr<DartPersistentValue> callback,
     ImageByteFormat format,
+    const ImageEncodingOptions& options,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
     fml::RefPtr<fml::TaskRunner> raster_task_runner,
     fml::RefPtr<fml::TaskRunner> io_task_runner,
@@ -210,8 +294,10 @@ void EncodeImageAndInvokeDataCallback(
       });
 
   auto encode_task = [callback_task = std::move(callback_task), format,
+                      options, concurrent_task_runner,
                       ui_task_runner](sk_sp<SkImage> raster_image) {
-    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), format);
+    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), format,
+                                        options, concurrent_task_runner);
     ui_task_runner->PostTask([callback_task = std::move(callback_task),
                               encoded = std::move(encoded)]() mutable {
       callback_task(std::move(encoded));
@@ -228,6 +314,14 @@ void EncodeImageAndInvokeDataCallback(
 Dart_Handle EncodeImage(CanvasImage* canvas_image,
                         int format,
                         Dart_Handle callback_handle) {
+  return EncodeImage(canvas_image, format, ImageEncodingOptions{},
+                     callback_handle);
+}
+
+Dart_Handle EncodeImage(CanvasImage* canvas_image,
+                        int format,
+                        const ImageEncodingOptions& options,
+                        Dart_Handle callback_handle) {
   if (!canvas_image) {
     return ToDart("encode called with non-genuine Image.");
   }
@@ -238,24 +332,40 @@ Dart_Handle EncodeImage(CanvasImage* canvas_image,
 
   ImageByteFormat image_format = static_cast<ImageByteFormat>(format);
 
+  if (options.quality < 0 || options.quality > 100) {
+    return ToDart("Quality must be between 0 and 100.");
+  }
+
+  if (options.png.compression_level < 0 ||
+      options.png.compression_level > 9) {
+    return ToDart("Compression level must be between 0 and 9.");
+  }
+
   auto callback = std::make_unique<DartPersistentValue>(
       tonic::DartState::Current(), callback_handle);
 
   const auto& task_runners = UIDartState::Current()->GetTaskRunners();
 
+  // PNGs are deflated on the image decoder's workers as well.
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner;
+  if (auto image_decoder = UIDartState::Current()->GetImageDecoder()) {
+    concurrent_task_runner = image_decoder->GetConcurrentTaskRunner();
+  }
+
   task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
       [callback = std::move(callback), image = canvas_image->image(),
-       image_format, ui_task_runner = task_runners.GetUITaskRunner(),
+       image_format, options, concurrent_task_runner,
+       ui_task_runner = task_runners.GetUITaskRunner(),
        raster_task_runner = task_runners.GetRasterTaskRunner(),
        io_task_runner = task_runners.GetIOTaskRunner(),
        io_manager = UIDartState::Current()->GetIOManager(),
        snapshot_delegate =
            UIDartState::Current()->GetSnapshotDelegate()]() mutable {
         EncodeImageAndInvokeDataCallback(
-            std::move(image), std::move(callback), image_format,
-            std::move(ui_task_runner), std::move(raster_task_runner),
-            std::move(io_task_runner), io_manager->GetResourceContext(),
-            std::move(snapshot_delegate),
+            std::move(image), std::move(callback), image_format, options,
+            std::move(concurrent_task_runner), std::move(ui_task_runner),
+            std::move(raster_task_runner), std::move(io_task_runner),
+            io_manager->GetResourceContext(), std::move(snapshot_delegate),
             io_manager->GetIsGpuDisabledSyncSwitch());
       }));
 
@@ -5,14 +5,30 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_ENCODING_H_
 #define FLUTTER_LIB_UI_PAINTING_IMAGE_ENCODING_H_
 
+#include "flutter/lib/ui/painting/parallel_png_encoder.h"
 #include "third_party/tonic/dart_library_natives.h"
 
 namespace flutter {
 
 class CanvasImage;
 
+// The compression settings of `Image.toByteData`. This must be kept in sync
+// with `ImageEncodingOptions` in painting.dart.
+struct ImageEncodingOptions {
+  // The quality of JPEG and WebP images, from 0 to 100. WebP images of quality
+  // 100 are lossless.
+  int quality = 90;
+
+  ParallelPngEncoder::Options png;
+};
+
+Dart_Handle EncodeImage(CanvasImage* canvas_image,
+                        int format,
+                        Dart_Handle callback_handle);
+
 Dart_Handle EncodeImage(CanvasImage* canvas_image,
                         int format,
+                        const ImageEncodingOptions& options,
                         Dart_Handle callback_handle);
 
 }  // namespace flutter
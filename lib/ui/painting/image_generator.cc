@@ -4,6 +4,8 @@
 
 #include "flutter/lib/ui/painting/image_generator.h"
 
+#include <vector>
+
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -29,6 +31,28 @@ sk_sp<SkImage> ImageGenerator::GetImage() {
   return SkImage::MakeFromBitmap(bitmap);
 }
 
+bool ImageGenerator::GetScanlines(const SkImageInfo& info,
+                                  const ScanlineCallback& callback) {
+  return false;
+}
+
+bool ImageGenerator::SupportsBandDecoding() {
+  return false;
+}
+
+std::optional<ImageGenerator::CompressedTexture>
+ImageGenerator::GetCompressedTexture() {
+  return std::nullopt;
+}
+
+bool ImageGenerator::GetBandPixels(const SkImageInfo& info,
+                                   void* pixels,
+                                   size_t row_bytes,
+                                   int first_row,
+                                   int row_count) {
+  return false;
+}
+
 BuiltinSkiaImageGenerator::~BuiltinSkiaImageGenerator() = default;
 
 BuiltinSkiaImageGenerator::BuiltinSkiaImageGenerator(
@@ -85,7 +109,8 @@ BuiltinSkiaCodecImageGenerator::BuiltinSkiaCodecImageGenerator(
 BuiltinSkiaCodecImageGenerator::BuiltinSkiaCodecImageGenerator(
     sk_sp<SkData> buffer)
     : codec_generator_(static_cast<SkCodecImageGenerator*>(
-          SkCodecImageGenerator::MakeFromEncodedCodec(buffer).release())) {}
+          SkCodecImageGenerator::MakeFromEncodedCodec(buffer).release())),
+      data_(std::move(buffer)) {}
 
 const SkImageInfo& BuiltinSkiaCodecImageGenerator::GetInfo() {
   return codec_generator_->getInfo();
@@ -131,13 +156,120 @@ bool BuiltinSkiaCodecImageGenerator::GetPixels(
   return codec_generator_->getPixels(info, pixels, row_bytes, &options);
 }
 
+bool BuiltinSkiaCodecImageGenerator::GetScanlines(
+    const SkImageInfo& info,
+    const ScanlineCallback& callback) {
+  if (!data_) {
+    return false;
+  }
+  auto codec = SkCodec::MakeFromData(data_);
+  // Scanline decoding ignores the EXIF orientation that `GetPixels` applies.
+  if (!codec || codec->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    return false;
+  }
+  if (codec->startScanlineDecode(info) != SkCodec::kSuccess ||
+      codec->getScanlineOrder() != SkCodec::kTopDown_SkScanlineOrder) {
+    return false;
+  }
+  std::vector<uint8_t> row(info.minRowBytes());
+  for (int y = 0; y < info.height(); y++) {
+    // The codec fills in the rows missing from truncated data, but `GetPixels`
+    // reports those rows as incomplete input, so leave truncated data to it.
+    if (codec->getScanlines(row.data(), 1, row.size()) != 1) {
+      return false;
+    }
+    callback(row.data());
+  }
+  return true;
+}
+
+// Whether the JPEG `data` is encoded with progressive scans, looking only at
+// the markers in front of its first scan.
+static bool IsProgressiveJpeg(const SkData& data) {
+  const auto* bytes = data.bytes();
+  const size_t size = data.size();
+  // Skip the start of image marker.
+  size_t offset = 2;
+  while (offset + 1 < size) {
+    if (bytes[offset] != 0xFF) {
+      return false;
+    }
+    const uint8_t marker = bytes[offset + 1];
+    offset += 2;
+    if (marker == 0xFF) {
+      // Fill byte.
+      offset--;
+      continue;
+    }
+    // Markers without a segment.
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      continue;
+    }
+    // Every start of frame marker (0xC0 to 0xCF) except those of the Huffman
+    // tables (0xC4), the JPEG extensions (0xC8) and the arithmetic coding
+    // conditioning (0xCC). The progressive ones are 0xC2, 0xC6, 0xCA and 0xCE.
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+        marker != 0xCC) {
+      return (marker & 0x03) == 0x02;
+    }
+    // Start of scan or end of image.
+    if (marker == 0xDA || marker == 0xD9 || offset + 1 >= size) {
+      return false;
+    }
+    offset += (bytes[offset] << 8) | bytes[offset + 1];
+  }
+  return false;
+}
+
+bool BuiltinSkiaCodecImageGenerator::SupportsBandDecoding() {
+  if (!data_) {
+    return false;
+  }
+  auto codec = SkCodec::MakeFromData(data_);
+  // Bands are decoded in the encoded orientation.
+  if (!codec || codec->getOrigin() != kTopLeft_SkEncodedOrigin ||
+      codec->getFrameCount() > 1) {
+    return false;
+  }
+  // JPEG decoders can skip the inverse DCT and color conversion of the rows
+  // above a band. Other formats (e.g. WebP, PNG) need to fully decode those
+  // rows, which makes the last band as slow as the whole image. So do
+  // progressive JPEGs, whose every scan has to be read before any row.
+  return codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG &&
+         !IsProgressiveJpeg(*data_);
+}
+
+bool BuiltinSkiaCodecImageGenerator::GetBandPixels(const SkImageInfo& info,
+                                                   void* pixels,
+                                                   size_t row_bytes,
+                                                   int first_row,
+                                                   int row_count) {
+  if (!data_) {
+    return false;
+  }
+  // A codec of our own so that bands can be decoded concurrently.
+  auto codec = SkCodec::MakeFromData(data_);
+  if (!codec || codec->startScanlineDecode(info) != SkCodec::kSuccess) {
+    return false;
+  }
+  // The rows above the band are still entropy decoded, but skipping them
+  // avoids the expensive parts of decoding them.
+  if (first_row > 0 && !codec->skipScanlines(first_row)) {
+    return false;
+  }
+  return codec->getScanlines(pixels, row_count, row_bytes) == row_count;
+}
+
 std::unique_ptr<ImageGenerator> BuiltinSkiaCodecImageGenerator::MakeFromData(
     sk_sp<SkData> data) {
   auto codec = SkCodec::MakeFromData(data);
   if (!codec) {
     return nullptr;
   }
-  return std::make_unique<BuiltinSkiaCodecImageGenerator>(std::move(codec));
+  auto generator =
+      std::make_unique<BuiltinSkiaCodecImageGenerator>(std::move(codec));
+  generator->data_ = std::move(data);
+  return generator;
 }
 
 }  // namespace flutter
@@ -5,8 +5,10 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_GENERATOR_H_
 #define FLUTTER_LIB_UI_PAINTING_IMAGE_GENERATOR_H_
 
+#include <functional>
 #include <optional>
 #include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
@@ -21,6 +23,10 @@ namespace flutter {
 /// @see    `ImageGenerator::GetScaledDimensions`
 class ImageGenerator {
  public:
+  /// Receives one decoded row of pixels at a time. The row is only valid for
+  /// the duration of the call.
+  using ScanlineCallback = std::function<void(const void* row)>;
+
   /// Frame count value to denote infinite looping.
   const static unsigned int kInfinitePlayCount =
       std::numeric_limits<unsigned int>::max();
@@ -39,6 +45,17 @@ class ImageGenerator {
     SkCodecAnimation::DisposalMethod disposal_method;
   };
 
+  /// @brief  The blocks of an image stored in a GPU compressed texture format,
+  ///         which can be uploaded without decoding them first.
+  struct CompressedTexture {
+    /// The blocks of the largest mipmap level.
+    sk_sp<SkData> data;
+
+    SkISize dimensions;
+
+    SkImage::CompressionType type;
+  };
+
   virtual ~ImageGenerator();
 
   /// @brief   Returns basic information about the contents of the encoded
@@ -123,6 +140,68 @@ class ImageGenerator {
       unsigned int frame_index = 0,
       std::optional<unsigned int> prior_frame = std::nullopt) = 0;
 
+  /// @brief      Decode the first frame of the image one row at a time, from
+  ///             top to bottom, without allocating memory for the whole image.
+  ///             This allows the rows to be consumed (e.g. downscaled) as they
+  ///             are decoded.
+  /// @param[in]  info      The desired size and color info of the decoded
+  ///                       rows. As with `GetPixels`, the size must be one
+  ///                       returned by `GetScaledDimensions`.
+  /// @param[in]  callback  Invoked once for each of the `info.height()` rows,
+  ///                       in order. Each row is `info.minRowBytes()` long.
+  /// @return     True if every row was passed to the callback. False if the
+  ///             generator cannot decode rows in order for this image (e.g. it
+  ///             needs to be reoriented) or if the encoded data ends before
+  ///             the last row, in which case the caller should use
+  ///             `GetPixels` instead. The default implementation always
+  ///             returns false.
+  /// @note       This method performs potentially long synchronous work, and so
+  ///             it should never be executed on the UI thread.
+  /// @see        `GetPixels`
+  virtual bool GetScanlines(const SkImageInfo& info,
+                            const ScanlineCallback& callback);
+
+  /// @brief      Whether `GetBandPixels` can decode this image. Generators
+  ///             should only return true if decoding bands of rows separately
+  ///             is worthwhile, i.e. if a band can be decoded without doing
+  ///             most of the work of decoding the whole image.
+  /// @return     True if `GetBandPixels` is supported. The default
+  ///             implementation always returns false.
+  /// @see        `GetBandPixels`
+  virtual bool SupportsBandDecoding();
+
+  /// @brief      Decode a horizontal band of rows of the first frame of the
+  ///             image at its full size. Unlike the other methods of
+  ///             `ImageGenerator`, this method may be called concurrently from
+  ///             multiple threads as long as the bands do not overlap.
+  /// @param[in]  info       The color info and full size of the image.
+  /// @param[in]  pixels     The location where the first row of the band
+  ///                        should be written.
+  /// @param[in]  row_bytes  The total number of bytes that make up a single
+  ///                        row of decoded image data.
+  /// @param[in]  first_row  The index of the first row of the band. This is a
+  ///                        multiple of 16, which is the tallest JPEG MCU.
+  /// @param[in]  row_count  The number of rows in the band.
+  /// @return     True if every row of the band was successfully decoded.
+  /// @note       This method performs potentially long synchronous work, and so
+  ///             it should never be executed on the UI thread.
+  /// @see        `SupportsBandDecoding`
+  virtual bool GetBandPixels(const SkImageInfo& info,
+                             void* pixels,
+                             size_t row_bytes,
+                             int first_row,
+                             int row_count);
+
+  /// @brief      Get the compressed texture blocks of the image, if it is
+  ///             stored in a format that GPUs can sample from directly.
+  ///             Uploading these blocks takes a fraction of the memory of the
+  ///             decoded pixels. `GetPixels` must still decode the image in
+  ///             software for backends that cannot upload the blocks.
+  /// @return     The compressed texture, or an empty value if the image is not
+  ///             stored in a compressed texture format. The default
+  ///             implementation always returns an empty value.
+  virtual std::optional<CompressedTexture> GetCompressedTexture();
+
   /// @brief   Creates an `SkImage` based on the current `ImageInfo` of this
   ///          `ImageGenerator`.
   /// @return  A new `SkImage` containing the decoded image data.
@@ -200,11 +279,28 @@ class BuiltinSkiaCodecImageGenerator : public ImageGenerator {
       unsigned int frame_index = 0,
       std::optional<unsigned int> prior_frame = std::nullopt) override;
 
+  // |ImageGenerator|
+  bool GetScanlines(const SkImageInfo& info,
+                    const ScanlineCallback& callback) override;
+
+  // |ImageGenerator|
+  bool SupportsBandDecoding() override;
+
+  // |ImageGenerator|
+  bool GetBandPixels(const SkImageInfo& info,
+                     void* pixels,
+                     size_t row_bytes,
+                     int first_row,
+                     int row_count) override;
+
   static std::unique_ptr<ImageGenerator> MakeFromData(sk_sp<SkData> data);
 
  private:
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(BuiltinSkiaCodecImageGenerator);
   std::unique_ptr<SkCodecImageGenerator> codec_generator_;
+  // The encoded data, if known. Scanline decoding needs a codec of its own
+  // since `SkCodecImageGenerator` does not expose the one it wraps.
+  sk_sp<SkData> data_;
 };
 
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "flutter/lib/ui/painting/image_generator_registry.h"
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 #include "third_party/skia/include/core/SkImageGenerator.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
@@ -23,6 +24,12 @@ ImageGeneratorRegistry::ImageGeneratorRegistry() : weak_factory_(this) {
       },
       0);
 
+  AddFactory(
+      [](sk_sp<SkData> buffer) {
+        return CompressedTextureImageGenerator::MakeFromData(buffer);
+      },
+      0);
+
   // todo(bdero): https://github.com/flutter/flutter/issues/82603
 #ifdef OS_MACOSX
   AddFactory(
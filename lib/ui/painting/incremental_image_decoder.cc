@@ -0,0 +1,157 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
+
+#include <vector>
+
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/tonic/dart_args.h"
+#include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/dart_library_natives.h"
+#include "third_party/tonic/logging/dart_invoke.h"
+#include "third_party/tonic/typed_data/typed_list.h"
+
+namespace flutter {
+
+static void IncrementalImageDecoder_constructor(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  DartCallConstructor(&IncrementalImageDecoder::Create, args);
+}
+
+IMPLEMENT_WRAPPERTYPEINFO(ui, IncrementalImageDecoder);
+
+#define FOR_EACH_BINDING(V)            \
+  V(IncrementalImageDecoder, addChunk) \
+  V(IncrementalImageDecoder, dispose)
+
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+void IncrementalImageDecoder::RegisterNatives(
+    tonic::DartLibraryNatives* natives) {
+  natives->Register({{"IncrementalImageDecoder_constructor",
+                      IncrementalImageDecoder_constructor, 1, true},
+                     FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
+
+fml::RefPtr<IncrementalImageDecoder> IncrementalImageDecoder::Create() {
+  return fml::MakeRefCounted<IncrementalImageDecoder>();
+}
+
+IncrementalImageDecoder::IncrementalImageDecoder()
+    : generator_(std::make_shared<IncrementalImageGenerator>()) {}
+
+IncrementalImageDecoder::~IncrementalImageDecoder() = default;
+
+Dart_Handle IncrementalImageDecoder::addChunk(Dart_Handle chunk_handle,
+                                              bool is_last,
+                                              Dart_Handle callback_handle) {
+  if (!Dart_IsClosure(callback_handle)) {
+    return tonic::ToDart("Callback must be a function");
+  }
+  if (!generator_) {
+    return tonic::ToDart("The decoder has been disposed");
+  }
+
+  tonic::Uint8List chunk(chunk_handle);
+  generator_->AddChunk(
+      SkData::MakeWithCopy(chunk.data(), chunk.num_elements()));
+  chunk.Release();
+  if (is_last) {
+    generator_->Finish();
+  }
+
+  pending_callbacks_.emplace_back(UIDartState::Current(), callback_handle);
+
+  if (decode_in_progress_) {
+    // The chunk is picked up by the pass that follows the one in flight.
+    return Dart_Null();
+  }
+  return StartDecode();
+}
+
+Dart_Handle IncrementalImageDecoder::StartDecode() {
+  auto decoder = UIDartState::Current()->GetImageDecoder();
+  if (!decoder) {
+    return tonic::ToDart(
+        "Failed to access the internal image decoder "
+        "registry on this isolate. Please file a bug on "
+        "https://github.com/flutter/flutter/issues.");
+  }
+
+  decode_in_progress_ = true;
+
+  // The decoder must be deleted on the UI thread. Allocate a RefPtr on the
+  // heap to keep it alive until the callback is invoked on the UI thread. The
+  // callback then drops the reference.
+  auto* raw_decoder_ref = new fml::RefPtr<IncrementalImageDecoder>(this);
+  decoder->DecodeIncrementally(
+      generator_, [raw_decoder_ref, callback_count = pending_callbacks_.size()](
+                      auto status, auto image) {
+        std::unique_ptr<fml::RefPtr<IncrementalImageDecoder>> decoder_ref(
+            raw_decoder_ref);
+        (*decoder_ref)->OnDecoded(callback_count, status, std::move(image));
+      });
+  return Dart_Null();
+}
+
+void IncrementalImageDecoder::OnDecoded(
+    size_t callback_count,
+    IncrementalImageGenerator::Status status,
+    SkiaGPUObject<SkImage> image) {
+  decode_in_progress_ = false;
+
+  auto state = pending_callbacks_.front().dart_state().lock();
+  if (!state) {
+    // This is probably because the isolate has been terminated before the
+    // image could be decoded.
+    return;
+  }
+
+  tonic::DartState::Scope scope(state.get());
+
+  fml::RefPtr<CanvasImage> canvas_image;
+  if (image.skia_object()) {
+    canvas_image = fml::MakeRefCounted<CanvasImage>();
+    canvas_image->set_image(std::move(image));
+  }
+
+  Dart_Handle error = Dart_Null();
+  if (status == IncrementalImageGenerator::Status::kError) {
+    error = tonic::ToDart(
+        "Could not decode image, possibly due to invalid image data.");
+  }
+
+  if (!generator_) {
+    // Disposed during this pass. There won't be another one.
+    callback_count = pending_callbacks_.size();
+  }
+  std::vector<tonic::DartPersistentValue> callbacks;
+  callbacks.reserve(callback_count);
+  for (size_t i = 0; i < callback_count; i++) {
+    callbacks.emplace_back(std::move(pending_callbacks_.front()));
+    pending_callbacks_.pop_front();
+  }
+
+  // Chunks that arrived during this pass are decoded in the next one.
+  if (!pending_callbacks_.empty()) {
+    StartDecode();
+  }
+
+  for (const auto& callback : callbacks) {
+    tonic::DartInvoke(callback.value(), {tonic::ToDart(canvas_image), error});
+  }
+}
+
+void IncrementalImageDecoder::dispose() {
+  generator_.reset();
+  ClearDartWrapper();
+}
+
+size_t IncrementalImageDecoder::GetAllocationSize() const {
+  return sizeof(*this) + (generator_ ? generator_->GetBufferedBytes() : 0);
+}
+
+}  // namespace flutter
@@ -0,0 +1,69 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
+#define FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
+
+#include <deque>
+#include <memory>
+
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/dart_wrapper.h"
+#include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/painting/incremental_image_generator.h"
+#include "third_party/tonic/dart_persistent_value.h"
+
+namespace tonic {
+class DartLibraryNatives;
+}  // namespace tonic
+
+namespace flutter {
+
+/// @brief  The engine side of `dart:ui`'s `IncrementalImageDecoder`. Feeds
+///         chunks of encoded bytes into an `IncrementalImageGenerator` and
+///         returns the image decoded so far for each chunk.
+///
+///         Decode passes for the same decoder never overlap. Chunks added
+///         while a pass is in flight are decoded together in the next pass.
+/// @see    `IncrementalImageGenerator`
+class IncrementalImageDecoder
+    : public RefCountedDartWrappable<IncrementalImageDecoder> {
+  DEFINE_WRAPPERTYPEINFO();
+  FML_FRIEND_MAKE_REF_COUNTED(IncrementalImageDecoder);
+
+ public:
+  ~IncrementalImageDecoder() override;
+
+  static fml::RefPtr<IncrementalImageDecoder> Create();
+
+  Dart_Handle addChunk(Dart_Handle chunk_handle,
+                       bool is_last,
+                       Dart_Handle callback_handle);
+
+  void dispose();
+
+  // |DartWrappable|
+  size_t GetAllocationSize() const override;
+
+  static void RegisterNatives(tonic::DartLibraryNatives* natives);
+
+ private:
+  std::shared_ptr<IncrementalImageGenerator> generator_;
+  std::deque<tonic::DartPersistentValue> pending_callbacks_;
+  bool decode_in_progress_ = false;
+
+  IncrementalImageDecoder();
+
+  Dart_Handle StartDecode();
+
+  void OnDecoded(size_t callback_count,
+                 IncrementalImageGenerator::Status status,
+                 SkiaGPUObject<SkImage> image);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IncrementalImageDecoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
@@ -0,0 +1,311 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_image_generator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkStream.h"
+
+namespace flutter {
+
+// The encoded bytes added so far along with a read cursor.
+//
+// Until the codec has started decoding incrementally, all bytes are retained
+// so that they can be read again from the start once more bytes have arrived.
+// After that the codec reads sequentially and consumed bytes are dropped.
+class IncrementalImageGenerator::ChunkBuffer {
+ public:
+  void Append(sk_sp<SkData> chunk) {
+    std::scoped_lock lock(mutex_);
+    FML_DCHECK(!finished_);
+    if (chunk && chunk->size() > 0) {
+      chunks_.emplace_back(std::move(chunk));
+    }
+  }
+
+  void Finish() {
+    std::scoped_lock lock(mutex_);
+    finished_ = true;
+  }
+
+  bool IsFinished() const {
+    std::scoped_lock lock(mutex_);
+    return finished_;
+  }
+
+  size_t Read(void* buffer, size_t size) {
+    std::scoped_lock lock(mutex_);
+    size_t bytes_read = 0;
+    while (bytes_read < size && chunk_index_ < chunks_.size()) {
+      const auto& chunk = chunks_[chunk_index_];
+      const size_t length =
+          std::min(size - bytes_read, chunk->size() - chunk_offset_);
+      if (buffer) {
+        std::memcpy(static_cast<uint8_t*>(buffer) + bytes_read,
+                    chunk->bytes() + chunk_offset_, length);
+      }
+      bytes_read += length;
+      chunk_offset_ += length;
+      if (chunk_offset_ == chunk->size()) {
+        chunk_index_++;
+        chunk_offset_ = 0;
+      }
+    }
+    DropConsumedChunksLocked();
+    return bytes_read;
+  }
+
+  bool IsAtEnd() const {
+    std::scoped_lock lock(mutex_);
+    return finished_ && chunk_index_ == chunks_.size();
+  }
+
+  bool Rewind() {
+    std::scoped_lock lock(mutex_);
+    if (!retain_consumed_chunks_) {
+      return false;
+    }
+    chunk_index_ = 0;
+    chunk_offset_ = 0;
+    return true;
+  }
+
+  void StopRetainingConsumedChunks() {
+    std::scoped_lock lock(mutex_);
+    retain_consumed_chunks_ = false;
+    DropConsumedChunksLocked();
+  }
+
+  // Returns all of the bytes in one block and drops the chunks. Must only be
+  // called while the consumed chunks are still retained.
+  sk_sp<SkData> TakeAllBytes() {
+    std::scoped_lock lock(mutex_);
+    FML_DCHECK(retain_consumed_chunks_);
+    size_t size = 0;
+    for (const auto& chunk : chunks_) {
+      size += chunk->size();
+    }
+    sk_sp<SkData> data = SkData::MakeUninitialized(size);
+    size_t offset = 0;
+    for (const auto& chunk : chunks_) {
+      std::memcpy(static_cast<uint8_t*>(data->writable_data()) + offset,
+                  chunk->bytes(), chunk->size());
+      offset += chunk->size();
+    }
+    chunks_.clear();
+    chunk_index_ = 0;
+    chunk_offset_ = 0;
+    return data;
+  }
+
+  size_t GetBufferedBytes() const {
+    std::scoped_lock lock(mutex_);
+    size_t size = 0;
+    for (const auto& chunk : chunks_) {
+      size += chunk->size();
+    }
+    return size;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<sk_sp<SkData>> chunks_;
+  size_t chunk_index_ = 0;
+  size_t chunk_offset_ = 0;
+  bool retain_consumed_chunks_ = true;
+  bool finished_ = false;
+
+  void DropConsumedChunksLocked() {
+    if (retain_consumed_chunks_) {
+      return;
+    }
+    while (chunk_index_ > 0) {
+      chunks_.pop_front();
+      chunk_index_--;
+    }
+  }
+};
+
+// Reads from a |ChunkBuffer|. Running out of bytes before the buffer is
+// finished looks like a short read to the codec, which reports incomplete
+// input and resumes reading on the next incremental decode.
+class IncrementalImageGenerator::ChunkStream : public SkStream {
+ public:
+  explicit ChunkStream(std::shared_ptr<ChunkBuffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  // |SkStream|
+  size_t read(void* buffer, size_t size) override {
+    return buffer_->Read(buffer, size);
+  }
+
+  // |SkStream|
+  bool isAtEnd() const override { return buffer_->IsAtEnd(); }
+
+  // |SkStream|
+  bool rewind() override { return buffer_->Rewind(); }
+
+ private:
+  std::shared_ptr<ChunkBuffer> buffer_;
+};
+
+IncrementalImageGenerator::IncrementalImageGenerator()
+    : buffer_(std::make_shared<ChunkBuffer>()) {}
+
+IncrementalImageGenerator::~IncrementalImageGenerator() = default;
+
+void IncrementalImageGenerator::AddChunk(sk_sp<SkData> chunk) {
+  buffer_->Append(std::move(chunk));
+}
+
+void IncrementalImageGenerator::Finish() {
+  buffer_->Finish();
+}
+
+size_t IncrementalImageGenerator::GetBufferedBytes() const {
+  return buffer_->GetBufferedBytes();
+}
+
+bool IncrementalImageGenerator::CreateCodec() {
+  buffer_->Rewind();
+  SkCodec::Result result = SkCodec::kSuccess;
+  codec_ =
+      SkCodec::MakeFromStream(std::make_unique<ChunkStream>(buffer_), &result);
+  if (!codec_) {
+    status_ = result == SkCodec::kIncompleteInput && !all_bytes_added_
+                  ? Status::kNeedsMoreData
+                  : Status::kError;
+    return false;
+  }
+
+  const auto& info = codec_->getInfo();
+  const auto decode_info = info.makeColorType(kN32_SkColorType)
+                               .makeAlphaType(info.isOpaque()
+                                                  ? kOpaque_SkAlphaType
+                                                  : kPremul_SkAlphaType);
+  if (!bitmap_.tryAllocPixels(decode_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << decode_info.computeMinByteSize() << "B";
+    status_ = Status::kError;
+    return false;
+  }
+  bitmap_.eraseColor(SK_ColorTRANSPARENT);
+  return true;
+}
+
+IncrementalImageGenerator::Status IncrementalImageGenerator::DecodeAllAtOnce() {
+  if (!all_bytes_added_) {
+    return Status::kNeedsMoreData;
+  }
+  // The streaming codec has already consumed some of the bytes, so the image
+  // is decoded from all of them with a codec of its own.
+  auto codec = SkCodec::MakeFromData(buffer_->TakeAllBytes());
+  if (!codec) {
+    return Status::kError;
+  }
+  const auto result = codec->getPixels(bitmap_.pixmap());
+  has_pixels_ = result == SkCodec::kSuccess ||
+                result == SkCodec::kIncompleteInput ||
+                result == SkCodec::kErrorInInput;
+  has_new_pixels_ = has_pixels_;
+  return has_pixels_ ? Status::kComplete : Status::kError;
+}
+
+IncrementalImageGenerator::Status IncrementalImageGenerator::Decode() {
+  TRACE_EVENT0("flutter", "IncrementalImageGenerator::Decode");
+  if (status_ == Status::kComplete || status_ == Status::kError) {
+    return status_;
+  }
+
+  // Sampled before decoding so that running out of bytes while a chunk is
+  // being added isn't mistaken for the end of the image.
+  all_bytes_added_ = buffer_->IsFinished();
+
+  if (decode_all_at_once_) {
+    status_ = DecodeAllAtOnce();
+  } else {
+    if (!codec_ && !CreateCodec()) {
+      return status_;
+    }
+
+    if (!incremental_decode_started_) {
+      switch (codec_->startIncrementalDecode(
+          bitmap_.info(), bitmap_.getPixels(), bitmap_.rowBytes())) {
+        case SkCodec::kSuccess:
+          incremental_decode_started_ = true;
+          // The codec reads the rest of the bytes sequentially from here on.
+          buffer_->StopRetainingConsumedChunks();
+          break;
+        case SkCodec::kIncompleteInput:
+          status_ =
+              all_bytes_added_ ? Status::kError : Status::kNeedsMoreData;
+          return status_;
+        case SkCodec::kUnimplemented:
+          decode_all_at_once_ = true;
+          codec_.reset();
+          status_ = DecodeAllAtOnce();
+          break;
+        default:
+          status_ = Status::kError;
+          break;
+      }
+    }
+
+    if (incremental_decode_started_) {
+      status_ = DecodeIncrementally();
+    }
+  }
+
+  if (status_ == Status::kComplete) {
+    // Nothing writes to the pixels anymore, so the final image can share them.
+    bitmap_.setImmutable();
+    codec_.reset();
+  }
+  return status_;
+}
+
+IncrementalImageGenerator::Status
+IncrementalImageGenerator::DecodeIncrementally() {
+  int rows_decoded = 0;
+  switch (codec_->incrementalDecode(&rows_decoded)) {
+    case SkCodec::kSuccess:
+      has_pixels_ = true;
+      has_new_pixels_ = true;
+      return Status::kComplete;
+    case SkCodec::kIncompleteInput:
+    case SkCodec::kErrorInInput:
+      if (rows_decoded > rows_decoded_) {
+        rows_decoded_ = rows_decoded;
+        has_pixels_ = true;
+        has_new_pixels_ = true;
+      }
+      if (all_bytes_added_) {
+        // The bytes ended early. Show what could be decoded.
+        has_new_pixels_ = has_pixels_;
+        return has_pixels_ ? Status::kComplete : Status::kError;
+      }
+      return has_pixels_ ? Status::kPartial : Status::kNeedsMoreData;
+    default:
+      return Status::kError;
+  }
+}
+
+sk_sp<SkImage> IncrementalImageGenerator::MakeImage() {
+  if (!has_new_pixels_) {
+    return nullptr;
+  }
+  has_new_pixels_ = false;
+  if (bitmap_.isImmutable()) {
+    return SkImage::MakeFromBitmap(bitmap_);
+  }
+  return SkImage::MakeRasterCopy(bitmap_.pixmap());
+}
+
+}  // namespace flutter
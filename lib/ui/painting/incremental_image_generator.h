@@ -0,0 +1,115 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_GENERATOR_H_
+#define FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_GENERATOR_H_
+
+#include <memory>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Decodes an image while its encoded bytes are still arriving.
+///
+///             Chunks of encoded bytes are appended with `AddChunk` as they
+///             arrive. Each call to `Decode` then decodes as much of the image
+///             as the bytes so far allow using
+///             `SkCodec::startIncrementalDecode`, and `MakeImage` returns the
+///             rows decoded so far. Rows not decoded yet are transparent.
+///
+///             Once the codec has started decoding incrementally, bytes are
+///             dropped as soon as it has consumed them, so the encoded image
+///             does not stay resident alongside the decoded one.
+///
+///             Codecs without incremental decoding support (e.g., JPEG) keep
+///             all of the bytes and decode the whole image in one go once the
+///             last chunk was added.
+///
+///             `AddChunk` and `Finish` may be called from any thread.
+///             `Decode` and `MakeImage` must not be called concurrently with
+///             each other.
+///
+class IncrementalImageGenerator {
+ public:
+  enum class Status {
+    // Not enough bytes to decode any part of the image yet.
+    kNeedsMoreData,
+    // Some, but not all, rows of the image have been decoded.
+    kPartial,
+    // The image was decoded as far as the bytes allowed and no more bytes
+    // are coming.
+    kComplete,
+    // The bytes could not be decoded.
+    kError,
+  };
+
+  IncrementalImageGenerator();
+
+  ~IncrementalImageGenerator();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Appends the next chunk of encoded bytes.
+  ///
+  void AddChunk(sk_sp<SkData> chunk);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Marks the end of the encoded bytes. No more chunks may be
+  ///             added.
+  ///
+  void Finish();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Decodes as much of the image as the bytes added so far allow.
+  ///
+  Status Decode();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Returns an image of the rows decoded so far, or nullptr if no
+  ///             rows have been decoded since the last image was made. Partial
+  ///             images are copies since the decoder keeps writing to its own
+  ///             pixels. Once the image is complete, the final image is made
+  ///             once more, even if no rows were decoded since the last one.
+  ///
+  sk_sp<SkImage> MakeImage();
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of encoded bytes currently held, for tests.
+  ///
+  size_t GetBufferedBytes() const;
+
+ private:
+  class ChunkBuffer;
+  class ChunkStream;
+
+  std::shared_ptr<ChunkBuffer> buffer_;
+  std::unique_ptr<SkCodec> codec_;
+  SkBitmap bitmap_;
+  bool incremental_decode_started_ = false;
+  // Set when the codec turned out not to support incremental decoding.
+  bool decode_all_at_once_ = false;
+  int rows_decoded_ = 0;
+  bool has_pixels_ = false;
+  // Whether rows were decoded since the last call to |MakeImage|.
+  bool has_new_pixels_ = false;
+  bool all_bytes_added_ = false;
+  Status status_ = Status::kNeedsMoreData;
+
+  bool CreateCodec();
+
+  Status DecodeAllAtOnce();
+
+  Status DecodeIncrementally();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IncrementalImageGenerator);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_GENERATOR_H_
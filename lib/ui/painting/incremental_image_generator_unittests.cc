@@ -0,0 +1,159 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_image_generator.h"
+
+#include <algorithm>
+
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+using Status = IncrementalImageGenerator::Status;
+
+sk_sp<SkData> OpenFixtureAsSkData(const char* name) {
+  auto mapping = OpenFixtureAsMapping(name);
+  if (!mapping) {
+    return nullptr;
+  }
+  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+}
+
+// Adds the data to the generator in chunks of the given size, decoding after
+// each one, and returns the status after each decode.
+std::vector<Status> DecodeInChunks(IncrementalImageGenerator& generator,
+                                   const sk_sp<SkData>& data,
+                                   size_t chunk_size) {
+  std::vector<Status> statuses;
+  for (size_t offset = 0; offset < data->size(); offset += chunk_size) {
+    const size_t length = std::min(chunk_size, data->size() - offset);
+    generator.AddChunk(SkData::MakeWithCopy(data->bytes() + offset, length));
+    if (offset + length == data->size()) {
+      generator.Finish();
+    }
+    statuses.push_back(generator.Decode());
+  }
+  return statuses;
+}
+
+bool HaveSamePixels(const sk_sp<SkImage>& a, const sk_sp<SkImage>& b) {
+  SkBitmap a_bitmap;
+  SkBitmap b_bitmap;
+  const auto info = a->imageInfo().makeColorType(kN32_SkColorType);
+  if (!a_bitmap.tryAllocPixels(info) || !b_bitmap.tryAllocPixels(info) ||
+      !a->readPixels(a_bitmap.pixmap(), 0, 0) ||
+      !b->readPixels(b_bitmap.pixmap(), 0, 0)) {
+    return false;
+  }
+  return a_bitmap.computeByteSize() == b_bitmap.computeByteSize() &&
+         memcmp(a_bitmap.getPixels(), b_bitmap.getPixels(),
+                a_bitmap.computeByteSize()) == 0;
+}
+
+}  // namespace
+
+TEST(IncrementalImageGeneratorTest, DecodesPNGProgressively) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data);
+  const size_t chunk_size = data->size() / 8 + 1;
+
+  IncrementalImageGenerator generator;
+  const auto statuses = DecodeInChunks(generator, data, chunk_size);
+
+  ASSERT_EQ(statuses.back(), Status::kComplete);
+  ASSERT_NE(std::find(statuses.begin(), statuses.end(), Status::kPartial),
+            statuses.end());
+
+  auto image = generator.MakeImage();
+  ASSERT_TRUE(image);
+  ASSERT_TRUE(HaveSamePixels(image, SkImage::MakeFromEncoded(data)));
+  // No rows were decoded since.
+  ASSERT_FALSE(generator.MakeImage());
+
+  // Bytes are dropped once decoded.
+  ASSERT_LT(generator.GetBufferedBytes(), chunk_size);
+}
+
+TEST(IncrementalImageGeneratorTest, OnlyMakesImagesOfNewRows) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data);
+  const size_t chunk_size = data->size() / 8 + 1;
+
+  IncrementalImageGenerator generator;
+  size_t offset = 0;
+  Status status = Status::kNeedsMoreData;
+  while (status != Status::kPartial) {
+    ASSERT_LT(offset + chunk_size, data->size());
+    generator.AddChunk(
+        SkData::MakeWithCopy(data->bytes() + offset, chunk_size));
+    offset += chunk_size;
+    status = generator.Decode();
+  }
+  ASSERT_TRUE(generator.MakeImage());
+  ASSERT_FALSE(generator.MakeImage());
+
+  // A decode without new bytes doesn't decode new rows.
+  ASSERT_EQ(generator.Decode(), Status::kPartial);
+  ASSERT_FALSE(generator.MakeImage());
+
+  generator.AddChunk(SkData::MakeWithCopy(data->bytes() + offset,
+                                          data->size() - offset));
+  generator.Finish();
+  ASSERT_EQ(generator.Decode(), Status::kComplete);
+  ASSERT_TRUE(generator.MakeImage());
+}
+
+TEST(IncrementalImageGeneratorTest, NeedsMoreDataBeforeTheHeaderArrives) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data);
+
+  IncrementalImageGenerator generator;
+  generator.AddChunk(SkData::MakeWithCopy(data->bytes(), 8));
+  ASSERT_EQ(generator.Decode(), Status::kNeedsMoreData);
+  ASSERT_FALSE(generator.MakeImage());
+  ASSERT_EQ(generator.GetBufferedBytes(), 8u);
+}
+
+TEST(IncrementalImageGeneratorTest, DecodesJPEGOnceAllBytesArrived) {
+  auto data = OpenFixtureAsSkData("Horizontal.jpg");
+  ASSERT_TRUE(data);
+
+  IncrementalImageGenerator generator;
+  const auto statuses = DecodeInChunks(generator, data, data->size() / 4 + 1);
+
+  ASSERT_EQ(statuses.back(), Status::kComplete);
+  for (size_t i = 0; i + 1 < statuses.size(); i++) {
+    ASSERT_EQ(statuses[i], Status::kNeedsMoreData);
+  }
+  auto image = generator.MakeImage();
+  ASSERT_TRUE(image);
+  ASSERT_TRUE(HaveSamePixels(image, SkImage::MakeFromEncoded(data)));
+  ASSERT_EQ(generator.GetBufferedBytes(), 0u);
+}
+
+TEST(IncrementalImageGeneratorTest, ShowsTruncatedImages) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data);
+
+  IncrementalImageGenerator generator;
+  generator.AddChunk(SkData::MakeWithCopy(data->bytes(), data->size() / 2));
+  generator.Finish();
+  ASSERT_EQ(generator.Decode(), Status::kComplete);
+  ASSERT_TRUE(generator.MakeImage());
+}
+
+TEST(IncrementalImageGeneratorTest, ReportsInvalidData) {
+  IncrementalImageGenerator generator;
+  generator.AddChunk(SkData::MakeWithCString("definitely not an image"));
+  generator.Finish();
+  ASSERT_EQ(generator.Decode(), Status::kError);
+  ASSERT_FALSE(generator.MakeImage());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -5,6 +5,7 @@
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
@@ -12,19 +13,48 @@
 
 namespace flutter {
 
-MultiFrameCodec::MultiFrameCodec(std::shared_ptr<ImageGenerator> generator)
-    : state_(new State(std::move(generator))) {}
+MultiFrameCodec::MultiFrameCodec(
+    std::shared_ptr<ImageGenerator> generator,
+    sk_sp<SkData> data,
+    std::shared_ptr<DecodedImageCache> frame_cache,
+    std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner)
+    : state_(new State(std::move(generator),
+                       std::move(data),
+                       std::move(frame_cache),
+                       std::move(look_ahead_task_runner))) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::shared_ptr<ImageGenerator> generator)
+MultiFrameCodec::State::State(
+    std::shared_ptr<ImageGenerator> generator,
+    sk_sp<SkData> data,
+    std::shared_ptr<DecodedImageCache> frame_cache,
+    std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner)
     : generator_(std::move(generator)),
       frameCount_(generator_->GetFrameCount()),
       repetitionCount_(generator_->GetPlayCount() ==
                                ImageGenerator::kInfinitePlayCount
                            ? -1
                            : generator_->GetPlayCount() - 1),
-      nextFrameIndex_(0) {}
+      data_(std::move(data)),
+      frame_cache_(std::move(frame_cache)),
+      look_ahead_task_runner_(std::move(look_ahead_task_runner)),
+      nextFrameIndex_(0) {
+  if (data_ && frame_cache_ && frameCount_ > 0) {
+    // The frames share the data they were decoded from, which the cache counts
+    // once. The frame decoded ahead of time is held on top of them.
+    const size_t frame_bytes = GetFrameImageInfo().computeMinByteSize();
+    const size_t look_ahead_bytes = look_ahead_task_runner_ ? frame_bytes : 0;
+    const size_t animation_bytes =
+        data_->size() + frameCount_ * frame_bytes + look_ahead_bytes;
+    cachingFrames_ =
+        animation_bytes <= frame_cache_->GetMaxBytes() / kMaxFrameCacheShare;
+    frameCachePurgeCount_ = frame_cache_->GetPurgeCount();
+    if (cachingFrames_) {
+      lookAheadFrameBytes_ = look_ahead_bytes;
+    }
+  }
+}
 
 static void InvokeNextFrameCallback(
     fml::RefPtr<CanvasImage> image,
@@ -75,55 +105,101 @@ static bool CopyToBitmap(SkBitmap* dst,
   return true;
 }
 
-sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
-    fml::WeakPtr<GrDirectContext> resourceContext,
-    const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch) {
-  SkBitmap bitmap = SkBitmap();
+SkImageInfo MultiFrameCodec::State::GetFrameImageInfo() const {
   SkImageInfo info = generator_->GetInfo().makeColorType(kN32_SkColorType);
   if (info.alphaType() == kUnpremul_SkAlphaType) {
     SkImageInfo updated = info.makeAlphaType(kPremul_SkAlphaType);
     info = updated;
   }
-  bitmap.allocPixels(info);
+  return info;
+}
+
+bool MultiFrameCodec::State::DecodeFrame(int frameIndex, SkBitmap* bitmap) {
+  const SkImageInfo info = GetFrameImageInfo();
+  bitmap->allocPixels(info);
 
-  ImageGenerator::FrameInfo frameInfo =
-      generator_->GetFrameInfo(nextFrameIndex_);
+  ImageGenerator::FrameInfo frameInfo = generator_->GetFrameInfo(frameIndex);
 
   const int requiredFrameIndex =
       frameInfo.required_frame.value_or(SkCodec::kNoFrame);
   std::optional<unsigned int> prior_frame_index = std::nullopt;
 
   if (requiredFrameIndex != SkCodec::kNoFrame) {
-    if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
-                     << requiredFrameIndex
-                     << " and no required frames are cached.";
-      return nullptr;
-    } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
+    // Frames served from the frame cache are not decoded, so the required
+    // frame may not be the last one that was. In that case the generator
+    // decodes the required frames first.
+    if (lastRequiredFrame_ == nullptr ||
+        lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
-                     << " is not cached. Using " << lastRequiredFrameIndex_
-                     << " instead";
-    }
-
-    if (lastRequiredFrame_->getPixels() &&
-        CopyToBitmap(&bitmap, lastRequiredFrame_->colorType(),
-                     *lastRequiredFrame_)) {
+                     << " is not cached. Decoding it first.";
+    } else if (lastRequiredFrame_->getPixels() &&
+               CopyToBitmap(bitmap, lastRequiredFrame_->colorType(),
+                            *lastRequiredFrame_)) {
       prior_frame_index = requiredFrameIndex;
     }
   }
 
-  if (!generator_->GetPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
-                             nextFrameIndex_, requiredFrameIndex)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+  if (!generator_->GetPixels(info, bitmap->getPixels(), bitmap->rowBytes(),
+                             frameIndex, prior_frame_index)) {
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frameIndex;
+    return false;
   }
 
   // Hold onto this if we need it to decode future frames.
   if (frameInfo.disposal_method == SkCodecAnimation::DisposalMethod::kKeep) {
-    lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
+    lastRequiredFrame_ = std::make_unique<SkBitmap>(*bitmap);
+    lastRequiredFrameIndex_ = frameIndex;
+  }
+  return true;
+}
+
+bool MultiFrameCodec::State::IsCachingFrames() {
+  if (cachingFrames_ &&
+      frame_cache_->GetPurgeCount() != frameCachePurgeCount_) {
+    // The cache was purged due to memory pressure. Go back to decoding frames
+    // on demand instead of filling it up again.
+    cachingFrames_ = false;
+    std::scoped_lock decoder_lock(decoder_mutex_);
+    lookAheadFrame_.reset();
+    lookAheadFrameIndex_ = -1;
   }
+  return cachingFrames_;
+}
+
+sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
+    fml::WeakPtr<GrDirectContext> resourceContext,
+    const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch,
+    const fml::RefPtr<flutter::SkiaUnrefQueue>& unref_queue) {
+  const bool cachingFrames = IsCachingFrames();
+  if (cachingFrames) {
+    if (!frameCacheKey_) {
+      frameCacheKey_ = DecodedImageCache::MakeFrameKey(
+          data_, GetFrameImageInfo(), nextFrameIndex_);
+    }
+    frameCacheKey_->frame_index = nextFrameIndex_;
+    auto cached = frame_cache_->Get(*frameCacheKey_, data_);
+    if (cached.skia_object()) {
+      return cached.skia_object();
+    }
+  }
+
+  SkBitmap bitmap = SkBitmap();
+  {
+    // Waits for a look-ahead decode in progress, which may be of this frame.
+    std::scoped_lock decoder_lock(decoder_mutex_);
+    if (lookAheadFrame_ && lookAheadFrameIndex_ == nextFrameIndex_) {
+      bitmap = *lookAheadFrame_;
+      lookAheadFrame_.reset();
+      lookAheadFrameIndex_ = -1;
+    } else if (!DecodeFrame(nextFrameIndex_, &bitmap)) {
+      return nullptr;
+    }
+  }
+
   sk_sp<SkImage> result;
+  // Raster images made while the GPU is disabled stand in for textures until
+  // it is enabled again, so they are not cached.
+  bool cacheable = false;
 
   gpu_disable_sync_switch->Execute(
       fml::SyncSwitch::Handlers()
@@ -133,7 +209,8 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
             // background on iOS.
             result = SkImage::MakeFromBitmap(bitmap);
           })
-          .SetIfFalse([&result, &resourceContext, &bitmap] {
+          .SetIfFalse([&result, &cacheable, &resourceContext, &bitmap] {
+            cacheable = true;
             if (resourceContext) {
               SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
                               bitmap.pixelRef()->rowBytes());
@@ -146,9 +223,34 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
               result = SkImage::MakeFromBitmap(bitmap);
             }
           }));
+
+  if (cachingFrames && cacheable && result) {
+    frame_cache_->Put(*frameCacheKey_, data_, result, unref_queue);
+  }
   return result;
 }
 
+void MultiFrameCodec::State::DecodeFrameAhead(int frameIndex) {
+  TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeFrameAhead");
+  std::unique_lock lock(mutex_);
+  // Skip the frame if it has been requested in the meantime.
+  if (nextFrameIndex_ == frameIndex && IsCachingFrames()) {
+    // The IO thread only locks the decoder mutex while holding `mutex_`, and
+    // there is no other look-ahead decode, so this does not block.
+    std::scoped_lock decoder_lock(decoder_mutex_);
+    lock.unlock();
+    auto bitmap = std::make_unique<SkBitmap>();
+    if (DecodeFrame(frameIndex, bitmap.get())) {
+      lookAheadFrame_ = std::move(bitmap);
+      lookAheadFrameIndex_ = frameIndex;
+    }
+  }
+  if (!lock.owns_lock()) {
+    lock.lock();
+  }
+  lookAheadPending_ = false;
+}
+
 void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
@@ -158,16 +260,43 @@ void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     size_t trace_id) {
   fml::RefPtr<CanvasImage> image = nullptr;
   int duration = 0;
-  sk_sp<SkImage> skImage =
-      GetNextFrameImage(resourceContext, gpu_disable_sync_switch);
-  if (skImage) {
-    image = CanvasImage::Create();
-    image->set_image({skImage, std::move(unref_queue)});
-    ImageGenerator::FrameInfo frameInfo =
-        generator_->GetFrameInfo(nextFrameIndex_);
-    duration = frameInfo.duration;
+  std::optional<int> lookAheadFrameIndex;
+  {
+    std::scoped_lock lock(mutex_);
+    sk_sp<SkImage> skImage = GetNextFrameImage(
+        resourceContext, gpu_disable_sync_switch, unref_queue);
+    if (skImage) {
+      image = CanvasImage::Create();
+      image->set_image({skImage, std::move(unref_queue)});
+      ImageGenerator::FrameInfo frameInfo =
+          generator_->GetFrameInfo(nextFrameIndex_);
+      duration = frameInfo.duration;
+    }
+    nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+
+    // Decode the next frame while this one is shown, unless it is cached
+    // already.
+    if (look_ahead_task_runner_ && !lookAheadPending_ && IsCachingFrames() &&
+        frameCacheKey_) {
+      frameCacheKey_->frame_index = nextFrameIndex_;
+      if (!frame_cache_->Get(*frameCacheKey_, data_).skia_object()) {
+        lookAheadPending_ = true;
+        lookAheadFrameIndex = nextFrameIndex_;
+      }
+    }
+  }
+
+  // Posted without holding the mutex since the task runs on this thread if the
+  // look-ahead task runner is gone.
+  if (lookAheadFrameIndex) {
+    look_ahead_task_runner_->PostTask(
+        [weak_state = weak_from_this(), frameIndex = *lookAheadFrameIndex]() {
+          if (auto state = weak_state.lock()) {
+            state->DecodeFrameAhead(frameIndex);
+          }
+        },
+        fml::ConcurrentTaskPriority::kBackground);
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable([callback = std::move(callback),
                                               image = std::move(image),
@@ -229,4 +358,8 @@ int MultiFrameCodec::repetitionCount() const {
   return state_->repetitionCount_;
 }
 
+size_t MultiFrameCodec::GetAllocationSize() const {
+  return sizeof(*this) + state_->lookAheadFrameBytes_;
+}
+
 }  // namespace flutter
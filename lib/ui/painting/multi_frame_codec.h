@@ -5,15 +5,39 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <mutex>
+#include <optional>
+
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/lib/ui/painting/codec.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_generator.h"
 
 namespace flutter {
 
 class MultiFrameCodec : public Codec {
  public:
-  explicit MultiFrameCodec(std::shared_ptr<ImageGenerator> generator);
+  // Animations take at most this share of the frame cache so that a single
+  // animation cannot evict everything else.
+  static constexpr size_t kMaxFrameCacheShare = 4;
+
+  // If a `frame_cache` is given and all frames of the animation fit in its
+  // share of the cache, decoded frames are cached so that looping animations
+  // are only decoded once. The `data` the generator decodes is needed to key
+  // the frames. While frames are being cached, the frame after the one being
+  // shown is decoded ahead of time on the `look_ahead_task_runner`, if any,
+  // as background work. That frame counts towards the share of the cache and
+  // the allocation size of the codec.
+  //
+  // Once the cache is purged due to memory pressure, this codec stops caching
+  // and decodes every frame on demand.
+  explicit MultiFrameCodec(
+      std::shared_ptr<ImageGenerator> generator,
+      sk_sp<SkData> data = nullptr,
+      std::shared_ptr<DecodedImageCache> frame_cache = nullptr,
+      std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner =
+          nullptr);
 
   ~MultiFrameCodec() override;
 
@@ -26,6 +50,9 @@ class MultiFrameCodec : public Codec {
   // |Codec|
   Dart_Handle getNextFrame(Dart_Handle args) override;
 
+  // |DartWrappable|
+  size_t GetAllocationSize() const override;
+
  private:
   // Captures the state shared between the IO and UI task runners.
   //
@@ -36,26 +63,68 @@ class MultiFrameCodec : public Codec {
   // Instead, the MultiFrameCodec creates this object when it is constructed,
   // shares it with the IO task runner's decoding work, and sets the live_
   // member to false when it is destructed.
-  struct State {
-    explicit State(std::shared_ptr<ImageGenerator> generator);
+  struct State : public std::enable_shared_from_this<State> {
+    State(std::shared_ptr<ImageGenerator> generator,
+          sk_sp<SkData> data,
+          std::shared_ptr<DecodedImageCache> frame_cache,
+          std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner);
 
     const std::shared_ptr<ImageGenerator> generator_;
     const int frameCount_;
     const int repetitionCount_;
+    const sk_sp<SkData> data_;
+    const std::shared_ptr<DecodedImageCache> frame_cache_;
+    const std::shared_ptr<fml::ConcurrentTaskRunner> look_ahead_task_runner_;
+    // The size of the frame decoded ahead of time, if frames are decoded
+    // ahead. Only set on construction.
+    size_t lookAheadFrameBytes_ = 0;
 
     // The non-const members and functions below here are only read or written
-    // to on the IO thread. They are not safe to access or write on the UI
-    // thread.
-    int nextFrameIndex_;
+    // to on the IO thread or by look-ahead decodes while holding this mutex.
+    // They are not safe to access or write on the UI thread.
+    std::mutex mutex_;
+
+    // Guards the generator and the decoded frames below. Look-ahead decodes
+    // hold only this mutex while decoding so that cached frames can still be
+    // served. It may be locked while holding `mutex_`, but not the other way
+    // around.
+    std::mutex decoder_mutex_;
+
     // The last decoded frame that's required to decode any subsequent frames.
     std::unique_ptr<SkBitmap> lastRequiredFrame_;
 
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
 
+    // The frame decoded ahead of time, if any.
+    std::unique_ptr<SkBitmap> lookAheadFrame_;
+    int lookAheadFrameIndex_ = -1;
+
+    int nextFrameIndex_;
+
+    // Whether decoded frames are put in the frame cache.
+    bool cachingFrames_ = false;
+    // The purge count of the frame cache when caching started.
+    size_t frameCachePurgeCount_ = 0;
+    // Computed on first use since it hashes all of the data.
+    std::optional<DecodedImageCache::Key> frameCacheKey_;
+
+    // Whether a look-ahead decode is posted or running. There is at most one
+    // at a time.
+    bool lookAheadPending_ = false;
+
+    SkImageInfo GetFrameImageInfo() const;
+
+    bool DecodeFrame(int frameIndex, SkBitmap* bitmap);
+
     sk_sp<SkImage> GetNextFrameImage(
         fml::WeakPtr<GrDirectContext> resourceContext,
-        const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch);
+        const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch,
+        const fml::RefPtr<flutter::SkiaUnrefQueue>& unref_queue);
+
+    bool IsCachingFrames();
+
+    void DecodeFrameAhead(int frameIndex);
 
     void GetNextFrameAndInvokeCallback(
         std::unique_ptr<DartPersistentValue> callback,
@@ -0,0 +1,468 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/parallel_png_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/zlib/zlib.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint8_t kPngSignature[] = {0x89, 0x50, 0x4E, 0x47,
+                                     0x0D, 0x0A, 0x1A, 0x0A};
+constexpr size_t kChunkOverhead = 12;
+constexpr uint8_t kColorTypeRGB = 2;
+constexpr uint8_t kColorTypeRGBA = 6;
+
+// Bands smaller than this are not worth a thread of their own.
+constexpr size_t kMinBytesPerBand = 512 * 1024;
+constexpr int kMaxBandCount = 8;
+
+void WriteUint32(uint8_t* out, uint32_t value) {
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+// Appends the length and type of a chunk whose data is appended next, and
+// returns where the chunk starts.
+size_t BeginChunk(std::vector<uint8_t>& out, const char (&type)[5]) {
+  const size_t offset = out.size();
+  out.resize(offset + 8);
+  memcpy(&out[offset + 4], type, 4);
+  return offset;
+}
+
+// Fills in the length of the chunk that starts at `offset` and ends at the end
+// of `out`, and appends its checksum.
+void EndChunk(std::vector<uint8_t>& out, size_t offset) {
+  const size_t size = out.size() - offset - 8;
+  WriteUint32(&out[offset], size);
+  const uint32_t crc = crc32(0, &out[offset + 4], static_cast<uInt>(size + 4));
+  out.resize(out.size() + 4);
+  WriteUint32(&out[out.size() - 4], crc);
+}
+
+void AppendChunk(std::vector<uint8_t>& out,
+                 const char (&type)[5],
+                 const uint8_t* data,
+                 size_t size) {
+  const size_t offset = BeginChunk(out, type);
+  out.insert(out.end(), data, data + size);
+  EndChunk(out, offset);
+}
+
+uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+// Writes the filter type followed by the filtered `row` to `out`. The first
+// `bpp` bytes have no left neighbor.
+void ApplyFilter(ParallelPngEncoder::Filter filter,
+                 const uint8_t* row,
+                 const uint8_t* previous_row,
+                 size_t size,
+                 size_t bpp,
+                 uint8_t* out) {
+  *out++ = static_cast<uint8_t>(filter);
+  switch (filter) {
+    case ParallelPngEncoder::Filter::kNone:
+      memcpy(out, row, size);
+      break;
+    case ParallelPngEncoder::Filter::kSub:
+      memcpy(out, row, bpp);
+      for (size_t i = bpp; i < size; i++) {
+        out[i] = row[i] - row[i - bpp];
+      }
+      break;
+    case ParallelPngEncoder::Filter::kUp:
+      for (size_t i = 0; i < size; i++) {
+        out[i] = row[i] - previous_row[i];
+      }
+      break;
+    case ParallelPngEncoder::Filter::kAverage:
+      for (size_t i = 0; i < bpp; i++) {
+        out[i] = row[i] - (previous_row[i] >> 1);
+      }
+      for (size_t i = bpp; i < size; i++) {
+        out[i] = row[i] - ((row[i - bpp] + previous_row[i]) >> 1);
+      }
+      break;
+    case ParallelPngEncoder::Filter::kPaeth:
+      for (size_t i = 0; i < bpp; i++) {
+        out[i] = row[i] - previous_row[i];
+      }
+      for (size_t i = bpp; i < size; i++) {
+        out[i] = row[i] - Paeth(row[i - bpp], previous_row[i],
+                                previous_row[i - bpp]);
+      }
+      break;
+    case ParallelPngEncoder::Filter::kAdaptive:
+      FML_DCHECK(false);
+      break;
+  }
+}
+
+// The sum of the filtered bytes taken as signed values, which libpng uses to
+// guess which filter compresses best.
+size_t FilteredRowCost(const uint8_t* filtered, size_t size) {
+  size_t cost = 0;
+  for (size_t i = 0; i < size; i++) {
+    cost += std::abs(static_cast<int8_t>(filtered[i]));
+  }
+  return cost;
+}
+
+// Filters and deflates a band of rows into a single IDAT chunk.
+class BandEncoder {
+ public:
+  BandEncoder(const SkPixmap& pixmap,
+              const ParallelPngEncoder::Options& options,
+              size_t bpp)
+      : pixmap_(pixmap),
+        options_(options),
+        bpp_(bpp),
+        row_size_(pixmap.width() * bpp),
+        previous_row_(row_size_),
+        current_row_(row_size_),
+        filtered_row_(row_size_ + 1),
+        best_filtered_row_(row_size_ + 1) {}
+
+  ~BandEncoder() {
+    if (initialized_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  // Appends an IDAT chunk with the deflated rows to `out`. The zlib header is
+  // written before the first band and the deflate stream is only finished
+  // after the last band.
+  bool Encode(int first_row,
+              int row_count,
+              bool is_first_band,
+              bool is_last_band,
+              std::vector<uint8_t>& out) {
+    const int strategy = options_.filter == ParallelPngEncoder::Filter::kNone
+                             ? Z_DEFAULT_STRATEGY
+                             : Z_FILTERED;
+    // Negative window bits write raw deflate data without a zlib wrapper, so
+    // that the bands can be joined.
+    if (deflateInit2(&stream_, options_.compression_level, Z_DEFLATED, -15, 8,
+                     strategy) != Z_OK) {
+      return false;
+    }
+    initialized_ = true;
+
+    const size_t band_size = static_cast<size_t>(row_count) * (row_size_ + 1);
+    const size_t chunk_offset = BeginChunk(out, "IDAT");
+    if (is_first_band) {
+      const uint8_t header[2] = {0x78, ZlibHeaderFlags()};
+      out.insert(out.end(), header, header + 2);
+    }
+    out_size_ = out.size();
+    out.resize(out_size_ + deflateBound(&stream_, band_size));
+
+    // The row above the image is taken to be all zeros.
+    const uint8_t* previous_row = previous_row_.data();
+    if (first_row > 0) {
+      previous_row = GetRow(first_row - 1, previous_row_);
+    }
+    for (int y = first_row; y < first_row + row_count; y++) {
+      const bool is_last_row = y == first_row + row_count - 1;
+      const uint8_t* row = GetRow(y, current_row_);
+      const uint8_t* filtered = FilterRow(row, previous_row);
+      adler_ = adler32(adler_, filtered, static_cast<uInt>(row_size_ + 1));
+      int flush = Z_NO_FLUSH;
+      if (is_last_row) {
+        flush = is_last_band ? Z_FINISH : Z_SYNC_FLUSH;
+      }
+      if (!Deflate(filtered, row_size_ + 1, flush, out)) {
+        return false;
+      }
+      // Rows that were packed into `current_row_` are needed as the previous
+      // row of the next one.
+      if (row == current_row_.data()) {
+        std::swap(previous_row_, current_row_);
+        row = previous_row_.data();
+      }
+      previous_row = row;
+    }
+
+    out.resize(out_size_);
+    EndChunk(out, chunk_offset);
+    filtered_size_ = band_size;
+    return true;
+  }
+
+  uLong adler() const { return adler_; }
+
+  size_t filtered_size() const { return filtered_size_; }
+
+ private:
+  const SkPixmap pixmap_;
+  const ParallelPngEncoder::Options options_;
+  const size_t bpp_;
+  const size_t row_size_;
+  std::vector<uint8_t> previous_row_;
+  std::vector<uint8_t> current_row_;
+  std::vector<uint8_t> filtered_row_;
+  std::vector<uint8_t> best_filtered_row_;
+  z_stream stream_ = {};
+  bool initialized_ = false;
+  size_t out_size_ = 0;
+  uLong adler_ = adler32(0, nullptr, 0);
+  size_t filtered_size_ = 0;
+
+  uint8_t ZlibHeaderFlags() const {
+    int level = 0;
+    if (options_.compression_level >= 7) {
+      level = 3;
+    } else if (options_.compression_level == 6) {
+      level = 2;
+    } else if (options_.compression_level >= 2) {
+      level = 1;
+    }
+    const int flags = level << 6;
+    // The header, read as a big endian number, must be a multiple of 31.
+    return flags + (31 - (0x78 * 256 + flags) % 31) % 31;
+  }
+
+  // Returns the pixels of row `y` without alpha for opaque images, packing
+  // them into `scratch` if necessary.
+  const uint8_t* GetRow(int y, std::vector<uint8_t>& scratch) const {
+    const auto* pixels = static_cast<const uint8_t*>(pixmap_.addr(0, y));
+    if (bpp_ == 4) {
+      return pixels;
+    }
+    for (int x = 0; x < pixmap_.width(); x++) {
+      memcpy(&scratch[x * 3], &pixels[x * 4], 3);
+    }
+    return scratch.data();
+  }
+
+  const uint8_t* FilterRow(const uint8_t* row, const uint8_t* previous_row) {
+    if (options_.filter != ParallelPngEncoder::Filter::kAdaptive) {
+      ApplyFilter(options_.filter, row, previous_row, row_size_, bpp_,
+                  filtered_row_.data());
+      return filtered_row_.data();
+    }
+    size_t best_cost = std::numeric_limits<size_t>::max();
+    for (auto filter :
+         {ParallelPngEncoder::Filter::kNone, ParallelPngEncoder::Filter::kSub,
+          ParallelPngEncoder::Filter::kUp, ParallelPngEncoder::Filter::kAverage,
+          ParallelPngEncoder::Filter::kPaeth}) {
+      ApplyFilter(filter, row, previous_row, row_size_, bpp_,
+                  filtered_row_.data());
+      const size_t cost = FilteredRowCost(filtered_row_.data() + 1, row_size_);
+      if (cost < best_cost) {
+        best_cost = cost;
+        std::swap(filtered_row_, best_filtered_row_);
+      }
+    }
+    return best_filtered_row_.data();
+  }
+
+  // Deflates `data` into `out`, of which only the first `out_size_` bytes
+  // are used.
+  bool Deflate(const uint8_t* data,
+               size_t size,
+               int flush,
+               std::vector<uint8_t>& out) {
+    stream_.next_in = const_cast<Bytef*>(data);
+    stream_.avail_in = static_cast<uInt>(size);
+    while (true) {
+      if (out_size_ == out.size()) {
+        out.resize(out.size() + std::max<size_t>(64 * 1024, out.size() / 2));
+      }
+      stream_.next_out = &out[out_size_];
+      stream_.avail_out = static_cast<uInt>(out.size() - out_size_);
+      const int result = deflate(&stream_, flush);
+      out_size_ = out.size() - stream_.avail_out;
+      if (result == Z_STREAM_ERROR) {
+        return false;
+      }
+      const bool done = flush == Z_FINISH ? result == Z_STREAM_END
+                                          : stream_.avail_out != 0;
+      if (done) {
+        return true;
+      }
+    }
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(BandEncoder);
+};
+
+// Hands out bands to the threads that encode them. The calling thread encodes
+// bands as well, so that it only ever waits for bands that another thread is
+// already working on.
+class BandEncode {
+ public:
+  using EncodeBand = std::function<bool(int band)>;
+
+  BandEncode(int band_count, EncodeBand encode_band)
+      : band_count_(band_count),
+        encode_band_(std::move(encode_band)),
+        bands_done_(band_count) {}
+
+  // Encodes bands until none are left to claim.
+  void EncodeRemainingBands() {
+    for (int band = next_band_++; band < band_count_; band = next_band_++) {
+      if (!encode_band_(band)) {
+        failed_ = true;
+      }
+      bands_done_.CountDown();
+    }
+  }
+
+  // Waits for bands claimed by other threads to finish. Only valid after a
+  // call to `EncodeRemainingBands` returned.
+  bool Wait() {
+    bands_done_.Wait();
+    return !failed_;
+  }
+
+ private:
+  const int band_count_;
+  const EncodeBand encode_band_;
+  std::atomic_int next_band_ = 0;
+  std::atomic_bool failed_ = false;
+  fml::CountDownLatch bands_done_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(BandEncode);
+};
+
+}  // namespace
+
+bool ParallelPngEncoder::CanEncode(const SkPixmap& pixmap) {
+  return pixmap.addr() != nullptr && CanEncode(pixmap.info());
+}
+
+bool ParallelPngEncoder::CanEncode(const SkImageInfo& info) {
+  return !info.dimensions().isEmpty() &&
+         info.colorType() == kRGBA_8888_SkColorType &&
+         (info.alphaType() == kUnpremul_SkAlphaType ||
+          info.alphaType() == kOpaque_SkAlphaType) &&
+         (!info.colorSpace() || info.colorSpace()->isSRGB());
+}
+
+sk_sp<SkData> ParallelPngEncoder::Encode(
+    const SkPixmap& pixmap,
+    const Options& options,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  TRACE_EVENT0("flutter", "ParallelPngEncoder::Encode");
+  if (!CanEncode(pixmap) || options.compression_level < 0 ||
+      options.compression_level > 9) {
+    return nullptr;
+  }
+
+  const bool is_opaque = pixmap.alphaType() == kOpaque_SkAlphaType;
+  const size_t bpp = is_opaque ? 3 : 4;
+  const int height = pixmap.height();
+  const size_t row_size = pixmap.width() * bpp;
+
+  int band_count = 1;
+  if (concurrent_task_runner) {
+    // The calling thread encodes bands as well.
+    const int max_band_count = std::clamp(
+        static_cast<int>(concurrent_task_runner->GetWorkerCount()) + 1, 1,
+        kMaxBandCount);
+    band_count = std::clamp(
+        static_cast<int>(row_size * height / kMinBytesPerBand), 1,
+        std::min(max_band_count, height));
+  }
+  const int rows_per_band = (height + band_count - 1) / band_count;
+  band_count = (height + rows_per_band - 1) / rows_per_band;
+
+  std::vector<std::vector<uint8_t>> idat_chunks(band_count);
+  std::vector<uLong> adlers(band_count);
+  std::vector<size_t> filtered_sizes(band_count);
+  // Tasks that start after every band was claimed only touch the shared
+  // state, never the pixmap or the outputs, which may be gone by then.
+  auto encode = std::make_shared<BandEncode>(
+      band_count, [&pixmap, &options, &idat_chunks, &adlers, &filtered_sizes,
+                   bpp, rows_per_band, height, band_count](int band) {
+        TRACE_EVENT0("flutter", "EncodePNGBand");
+        const int first_row = band * rows_per_band;
+        BandEncoder encoder(pixmap, options, bpp);
+        if (!encoder.Encode(first_row,
+                            std::min(rows_per_band, height - first_row),
+                            band == 0, band == band_count - 1,
+                            idat_chunks[band])) {
+          return false;
+        }
+        adlers[band] = encoder.adler();
+        filtered_sizes[band] = encoder.filtered_size();
+        return true;
+      });
+  for (int i = 1; i < band_count; i++) {
+    concurrent_task_runner->PostTask(
+        [encode] { encode->EncodeRemainingBands(); });
+  }
+  encode->EncodeRemainingBands();
+  if (!encode->Wait()) {
+    FML_LOG(ERROR) << "Could not deflate all bands of the image.";
+    return nullptr;
+  }
+
+  std::vector<uint8_t> header(kPngSignature,
+                              kPngSignature + sizeof(kPngSignature));
+  uint8_t ihdr[13] = {};
+  WriteUint32(&ihdr[0], pixmap.width());
+  WriteUint32(&ihdr[4], height);
+  ihdr[8] = 8;  // Bit depth.
+  ihdr[9] = is_opaque ? kColorTypeRGB : kColorTypeRGBA;
+  AppendChunk(header, "IHDR", ihdr, sizeof(ihdr));
+  if (pixmap.colorSpace()) {
+    const uint8_t perceptual_intent = 0;
+    AppendChunk(header, "sRGB", &perceptual_intent, 1);
+  }
+
+  // The checksum of the whole zlib stream follows the last band.
+  std::vector<uint8_t> trailer;
+  uLong adler = adlers[0];
+  for (int band = 1; band < band_count; band++) {
+    adler = adler32_combine(adler, adlers[band],
+                            static_cast<z_off_t>(filtered_sizes[band]));
+  }
+  uint8_t adler_bytes[4];
+  WriteUint32(adler_bytes, adler);
+  AppendChunk(trailer, "IDAT", adler_bytes, sizeof(adler_bytes));
+  AppendChunk(trailer, "IEND", nullptr, 0);
+
+  size_t size = header.size() + trailer.size();
+  for (const auto& chunk : idat_chunks) {
+    size += chunk.size();
+  }
+  auto data = SkData::MakeUninitialized(size);
+  auto* out = static_cast<uint8_t*>(data->writable_data());
+  out = std::copy(header.begin(), header.end(), out);
+  for (const auto& chunk : idat_chunks) {
+    out = std::copy(chunk.begin(), chunk.end(), out);
+  }
+  std::copy(trailer.begin(), trailer.end(), out);
+  return data;
+}
+
+}  // namespace flutter
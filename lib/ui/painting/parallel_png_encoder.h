@@ -0,0 +1,86 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PARALLEL_PNG_ENCODER_H_
+#define FLUTTER_LIB_UI_PAINTING_PARALLEL_PNG_ENCODER_H_
+
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Encodes RGBA 8888 images as PNGs, deflating bands of rows on
+///             multiple threads.
+///
+///             Each band is filtered and deflated on its own, with the zlib
+///             stream flushed to a byte boundary at the end of every band but
+///             the last. The bands are then joined into a single zlib stream
+///             whose checksum is combined from the checksums of the bands.
+///             Since a band cannot refer back to the bytes of the band before
+///             it, the output is slightly larger than that of a serial
+///             encoder.
+///
+class ParallelPngEncoder {
+ public:
+  // This must be kept in sync with the enum in painting.dart. The values other
+  // than kAdaptive are the filter types of the PNG specification.
+  enum class Filter {
+    kNone,
+    kSub,
+    kUp,
+    kAverage,
+    kPaeth,
+    // Picks the filter that is likely to compress best for each row.
+    kAdaptive,
+  };
+
+  struct Options {
+    // The zlib compression level, from 0 (no compression) to 9 (smallest).
+    int compression_level = 6;
+    Filter filter = Filter::kAdaptive;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether `pixmap` can be encoded by this class. Only
+  ///             unpremultiplied or opaque RGBA 8888 pixels without a color
+  ///             space or in sRGB are supported.
+  ///
+  static bool CanEncode(const SkPixmap& pixmap);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether pixels described by `info` can be encoded by this
+  ///             class, so that callers can check before allocating them.
+  ///
+  static bool CanEncode(const SkImageInfo& info);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Encodes `pixmap`, which `CanEncode` must be true for.
+  ///             Opaque pixmaps are encoded without an alpha channel.
+  ///
+  /// @param[in]  pixmap                  The pixels to encode.
+  /// @param[in]  options                 The compression settings.
+  /// @param[in]  concurrent_task_runner  Runs the bands other than those
+  ///                                     the calling thread encodes. If null,
+  ///                                     all bands are encoded on the calling
+  ///                                     thread.
+  ///
+  /// @return     The PNG file, or null if the pixels could not be encoded.
+  ///
+  static sk_sp<SkData> Encode(
+      const SkPixmap& pixmap,
+      const Options& options,
+      const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner);
+
+ private:
+  FML_DISALLOW_IMPLICIT_CONSTRUCTORS(ParallelPngEncoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PARALLEL_PNG_ENCODER_H_
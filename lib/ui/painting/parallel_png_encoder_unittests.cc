@@ -0,0 +1,112 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/parallel_png_encoder.h"
+
+#include <cstring>
+
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// The offset of the color type in the IHDR chunk of a PNG file.
+constexpr size_t kColorTypeOffset = 25;
+constexpr uint8_t kColorTypeRGB = 2;
+constexpr uint8_t kColorTypeRGBA = 6;
+
+SkBitmap MakeGradient(int width, int height, SkAlphaType alpha_type) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
+                                       alpha_type));
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      uint8_t* pixel = static_cast<uint8_t*>(bitmap.getAddr(x, y));
+      pixel[0] = x * 255 / width;
+      pixel[1] = y * 255 / height;
+      pixel[2] = (x * y) % 251;
+      pixel[3] = alpha_type == kOpaque_SkAlphaType ? 255 : (x + y) % 256;
+    }
+  }
+  return bitmap;
+}
+
+void ExpectDecodesTo(const sk_sp<SkData>& png, const SkBitmap& expected) {
+  ASSERT_TRUE(png);
+  auto codec = SkCodec::MakeFromData(png);
+  ASSERT_TRUE(codec);
+  ASSERT_EQ(codec->dimensions(), expected.dimensions());
+
+  SkBitmap actual;
+  actual.allocPixels(expected.info());
+  ASSERT_EQ(codec->getPixels(actual.pixmap()), SkCodec::kSuccess);
+  for (int y = 0; y < expected.height(); y++) {
+    ASSERT_EQ(memcmp(actual.getAddr(0, y), expected.getAddr(0, y),
+                     expected.width() * 4),
+              0)
+        << "Row " << y << " differs.";
+  }
+}
+
+}  // namespace
+
+TEST(ParallelPngEncoderTest, RoundTripsEveryFilter) {
+  const auto bitmap = MakeGradient(67, 45, kUnpremul_SkAlphaType);
+  for (int filter = 0;
+       filter <= static_cast<int>(ParallelPngEncoder::Filter::kAdaptive);
+       filter++) {
+    auto png = ParallelPngEncoder::Encode(
+        bitmap.pixmap(),
+        {.filter = static_cast<ParallelPngEncoder::Filter>(filter)}, nullptr);
+    ExpectDecodesTo(png, bitmap);
+    ASSERT_EQ(png->bytes()[kColorTypeOffset], kColorTypeRGBA);
+  }
+}
+
+TEST(ParallelPngEncoderTest, EncodesOpaqueImagesWithoutAlpha) {
+  const auto bitmap = MakeGradient(31, 17, kOpaque_SkAlphaType);
+  auto png = ParallelPngEncoder::Encode(bitmap.pixmap(), {}, nullptr);
+  ExpectDecodesTo(png, bitmap);
+  ASSERT_EQ(png->bytes()[kColorTypeOffset], kColorTypeRGB);
+}
+
+TEST(ParallelPngEncoderTest, JoinsBandsEncodedOnWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  // Large enough to be split into bands on machines with several cores.
+  const auto bitmap = MakeGradient(1024, 1000, kUnpremul_SkAlphaType);
+  for (int level : {0, 1, 6, 9}) {
+    ExpectDecodesTo(ParallelPngEncoder::Encode(bitmap.pixmap(),
+                                               {.compression_level = level},
+                                               loop->GetTaskRunner()),
+                    bitmap);
+  }
+  loop->Terminate();
+}
+
+TEST(ParallelPngEncoderTest, RejectsUnsupportedPixels) {
+  ASSERT_FALSE(ParallelPngEncoder::CanEncode(
+      MakeGradient(4, 4, kPremul_SkAlphaType).pixmap()));
+  ASSERT_FALSE(ParallelPngEncoder::Encode(
+      MakeGradient(4, 4, kPremul_SkAlphaType).pixmap(), {}, nullptr));
+
+  SkBitmap bgra;
+  bgra.allocPixels(SkImageInfo::Make(4, 4, kBGRA_8888_SkColorType,
+                                     kUnpremul_SkAlphaType));
+  ASSERT_FALSE(ParallelPngEncoder::CanEncode(bgra.pixmap()));
+  ASSERT_FALSE(ParallelPngEncoder::CanEncode(bgra.info()));
+  ASSERT_FALSE(ParallelPngEncoder::CanEncode(
+      SkImageInfo::Make(0, 4, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType)));
+
+  const auto bitmap = MakeGradient(4, 4, kUnpremul_SkAlphaType);
+  ASSERT_TRUE(ParallelPngEncoder::CanEncode(bitmap.pixmap()));
+  ASSERT_FALSE(ParallelPngEncoder::Encode(bitmap.pixmap(),
+                                          {.compression_level = 10}, nullptr));
+}
+
+}  // namespace testing
+}  // namespace flutter
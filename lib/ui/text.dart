@@ -3228,10 +3228,11 @@ class Paragraph extends NativeFieldWrapperClass1 {
 
   /// Returns the text position closest to the given offset.
   TextPosition getPositionForOffset(Offset offset) {
-    final List<int> encoded = _getPositionForOffset(offset.dx, offset.dy);
+    final Int32List encoded = _getPositionForOffset(offset.dx, offset.dy);
     return TextPosition(offset: encoded[0], affinity: TextAffinity.values[encoded[1]]);
   }
-  List<int> _getPositionForOffset(double dx, double dy) native 'Paragraph_getPositionForOffset';
+  // See paragraph.cc for the layout of this return value.
+  Int32List _getPositionForOffset(double dx, double dy) native 'Paragraph_getPositionForOffset';
 
   /// Returns the [TextRange] of the word at the given [TextPosition].
   ///
@@ -3240,10 +3241,11 @@ class Paragraph extends NativeFieldWrapperClass1 {
   /// [offset, offset+1]. Word boundaries are defined more precisely in Unicode
   /// Standard Annex #29 http://www.unicode.org/reports/tr29/#Word_Boundaries
   TextRange getWordBoundary(TextPosition position) {
-    final List<int> boundary = _getWordBoundary(position.offset);
+    final Int32List boundary = _getWordBoundary(position.offset);
     return TextRange(start: boundary[0], end: boundary[1]);
   }
-  List<int> _getWordBoundary(int offset) native 'Paragraph_getWordBoundary';
+  // See paragraph.cc for the layout of this return value.
+  Int32List _getWordBoundary(int offset) native 'Paragraph_getWordBoundary';
 
   /// Returns the [TextRange] of the line at the given [TextPosition].
   ///
@@ -3254,28 +3256,26 @@ class Paragraph extends NativeFieldWrapperClass1 {
   /// This can potentially be expensive, since it needs to compute the line
   /// metrics, so use it sparingly.
   TextRange getLineBoundary(TextPosition position) {
-    final List<int> boundary = _getLineBoundary(position.offset);
-    final TextRange line = TextRange(start: boundary[0], end: boundary[1]);
-
-    final List<int> nextBoundary = _getLineBoundary(position.offset + 1);
-    final TextRange nextLine = TextRange(start: nextBoundary[0], end: nextBoundary[1]);
+    final Int32List boundaries = _getLineBoundary(position.offset);
+    final TextRange line = TextRange(start: boundaries[0], end: boundaries[1]);
+    final TextRange nextLine = TextRange(start: boundaries[2], end: boundaries[3]);
     // If there is no next line, because we're at the end of the field, return
     // line.
     if (!nextLine.isValid) {
       return line;
     }
 
-    // _getLineBoundary only considers the offset and assumes that the
-    // TextAffinity is upstream. In the case that TextPosition is just after a
-    // wordwrap (downstream), we need to return the line for the next offset.
+    // The line of the offset assumes that the TextAffinity is upstream. In the
+    // case that TextPosition is just after a wordwrap (downstream), we need to
+    // return the line for the next offset.
     if (position.affinity == TextAffinity.downstream && line != nextLine
         && position.offset == line.end && line.end == nextLine.start) {
-      final List<int> nextBoundary = _getLineBoundary(position.offset + 1);
-      return TextRange(start: nextBoundary[0], end: nextBoundary[1]);
+      return nextLine;
     }
     return line;
   }
-  List<int> _getLineBoundary(int offset) native 'Paragraph_getLineBoundary';
+  // See paragraph.cc for the layout of this return value.
+  Int32List _getLineBoundary(int offset) native 'Paragraph_getLineBoundary';
 
   // Redirecting the paint function in this way solves some dependency problems
   // in the C++ code. If we straighten out the C++ dependencies, we can remove
@@ -5,6 +5,7 @@
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 
 #include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkStream.h"
 #include "third_party/skia/include/core/SkString.h"
@@ -18,11 +19,80 @@ void MappingReleaseProc(const void* ptr, void* context) {
   delete reinterpret_cast<fml::Mapping*>(context);
 }
 
+uint16_t ReadU16(const uint8_t* bytes) {
+  return bytes[0] << 8 | bytes[1];
+}
+
+uint32_t ReadU32(const uint8_t* bytes) {
+  return static_cast<uint32_t>(ReadU16(bytes)) << 16 | ReadU16(bytes + 2);
+}
+
+// Reads the weight, width and slant of the first font in `data` from its OS/2
+// table, which is much cheaper than creating a typeface for it. Returns false
+// for fonts without usable values, which need a typeface instead.
+bool ReadFontStyle(const SkData& data, SkFontStyle* style) {
+  const uint8_t* bytes = data.bytes();
+  const size_t size = data.size();
+  constexpr uint32_t kCollectionTag = 0x74746366;  // "ttcf"
+  constexpr uint32_t kOS2Tag = 0x4F532F32;         // "OS/2"
+  constexpr size_t kOffsetTableSize = 12;
+  constexpr size_t kTableRecordSize = 16;
+  // The size of version 0 of the OS/2 table, which ends after fsSelection.
+  constexpr size_t kOS2MinSize = 64;
+
+  size_t font_offset = 0;
+  if (size >= 16 && ReadU32(bytes) == kCollectionTag) {
+    font_offset = ReadU32(bytes + 12);
+  }
+  if (font_offset > size || size - font_offset < kOffsetTableSize) {
+    return false;
+  }
+  const uint8_t* font = bytes + font_offset;
+  const size_t table_count = ReadU16(font + 4);
+  if ((size - font_offset - kOffsetTableSize) / kTableRecordSize <
+      table_count) {
+    return false;
+  }
+
+  for (size_t i = 0; i < table_count; i++) {
+    const uint8_t* record = font + kOffsetTableSize + i * kTableRecordSize;
+    if (ReadU32(record) != kOS2Tag) {
+      continue;
+    }
+    const size_t offset = ReadU32(record + 8);
+    if (ReadU32(record + 12) < kOS2MinSize || offset > size ||
+        size - offset < kOS2MinSize) {
+      return false;
+    }
+    const uint8_t* os2 = bytes + offset;
+    const int weight = ReadU16(os2 + 4);
+    const int width = ReadU16(os2 + 6);
+    const uint16_t selection = ReadU16(os2 + 62);
+    if (weight < SkFontStyle::kThin_Weight ||
+        weight > SkFontStyle::kExtraBlack_Weight ||
+        width < SkFontStyle::kUltraCondensed_Width ||
+        width > SkFontStyle::kUltraExpanded_Width) {
+      return false;
+    }
+    SkFontStyle::Slant slant = SkFontStyle::kUpright_Slant;
+    if (selection & (1 << 9)) {
+      slant = SkFontStyle::kOblique_Slant;
+    } else if (selection & 1) {
+      slant = SkFontStyle::kItalic_Slant;
+    }
+    *style = SkFontStyle(weight, width, slant);
+    return true;
+  }
+  return false;
+}
+
 }  // anonymous namespace
 
 AssetManagerFontProvider::AssetManagerFontProvider(
-    std::shared_ptr<AssetManager> asset_manager)
-    : asset_manager_(asset_manager) {}
+    std::shared_ptr<AssetManager> asset_manager,
+    std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner)
+    : asset_manager_(asset_manager),
+      preload_task_runner_(std::move(preload_task_runner)) {}
 
 AssetManagerFontProvider::~AssetManagerFontProvider() = default;
 
@@ -57,7 +127,8 @@ void AssetManagerFontProvider::RegisterAsset(std::string family_name,
     family_names_.push_back(family_name);
     auto value = std::make_pair(
         canonical_name,
-        sk_make_sp<AssetManagerFontStyleSet>(asset_manager_, family_name));
+        sk_make_sp<AssetManagerFontStyleSet>(asset_manager_, family_name,
+                                             preload_task_runner_));
     family_it = registered_families_.emplace(value).first;
   }
 
@@ -66,26 +137,65 @@ void AssetManagerFontProvider::RegisterAsset(std::string family_name,
 
 AssetManagerFontStyleSet::AssetManagerFontStyleSet(
     std::shared_ptr<AssetManager> asset_manager,
-    std::string family_name)
-    : asset_manager_(asset_manager), family_name_(family_name) {}
+    std::string family_name,
+    std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner)
+    : asset_manager_(asset_manager),
+      family_name_(family_name),
+      preload_task_runner_(std::move(preload_task_runner)) {}
 
 AssetManagerFontStyleSet::~AssetManagerFontStyleSet() = default;
 
 void AssetManagerFontStyleSet::registerAsset(std::string asset) {
+  std::scoped_lock lock(mutex_);
   assets_.emplace_back(asset);
 }
 
+void AssetManagerFontStyleSet::loadTypefaces() {
+  TRACE_EVENT1("flutter", "AssetManagerFontStyleSet::loadTypefaces",
+               "family_name", family_name_.c_str());
+  // The lock is taken for each asset in turn, so that text using the family
+  // meanwhile does not wait for all of the typefaces.
+  for (int i = 0; i < count(); i++) {
+    std::scoped_lock lock(mutex_);
+    createTypefaceLocked(assets_[i]);
+  }
+}
+
+void AssetManagerFontStyleSet::preloadTypefaces() {
+  if (!preload_task_runner_ || preload_posted_.exchange(true)) {
+    return;
+  }
+  preload_task_runner_->PostTask(
+      [font_style_set = sk_ref_sp(this)]() { font_style_set->loadTypefaces(); },
+      fml::ConcurrentTaskPriority::kBackground);
+}
+
 int AssetManagerFontStyleSet::count() {
+  std::scoped_lock lock(mutex_);
   return assets_.size();
 }
 
 void AssetManagerFontStyleSet::getStyle(int index,
                                         SkFontStyle* style,
                                         SkString* name) {
+  std::scoped_lock lock(mutex_);
   FML_DCHECK(index < static_cast<int>(assets_.size()));
-  if (style) {
-    sk_sp<SkTypeface> typeface(createTypeface(index));
-    if (typeface) {
+  if (style && static_cast<size_t>(index) < assets_.size()) {
+    TypefaceAsset& asset = assets_[index];
+    // Matching a style asks for the styles of all of the assets of the
+    // family, but only needs the typeface of one of them.
+    if (!asset.typeface && !asset.style) {
+      sk_sp<SkData> data = getDataLocked(asset);
+      SkFontStyle font_style;
+      if (data && ReadFontStyle(*data, &font_style)) {
+        asset.style = font_style;
+      }
+    }
+    if (asset.typeface) {
+      *style = asset.typeface->fontStyle();
+    } else if (asset.style) {
+      *style = *asset.style;
+    } else if (sk_sp<SkTypeface> typeface = createTypefaceLocked(asset)) {
       *style = typeface->fontStyle();
     }
   }
@@ -95,13 +205,16 @@ void AssetManagerFontStyleSet::getStyle(int index,
 }
 
 SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
+  std::scoped_lock lock(mutex_);
   size_t index = i;
   if (index >= assets_.size()) {
     return nullptr;
   }
+  return createTypefaceLocked(assets_[index]).release();
+}
 
-  TypefaceAsset& asset = assets_[index];
-  if (!asset.typeface) {
+sk_sp<SkData> AssetManagerFontStyleSet::getDataLocked(TypefaceAsset& asset) {
+  if (!asset.data) {
     std::unique_ptr<fml::Mapping> asset_mapping =
         asset_manager_->GetAsMapping(asset.asset);
     if (asset_mapping == nullptr) {
@@ -109,9 +222,21 @@ SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
     }
 
     fml::Mapping* asset_mapping_ptr = asset_mapping.release();
-    sk_sp<SkData> asset_data = SkData::MakeWithProc(
+    asset.data = SkData::MakeWithProc(
         asset_mapping_ptr->GetMapping(), asset_mapping_ptr->GetSize(),
         MappingReleaseProc, asset_mapping_ptr);
+  }
+  return asset.data;
+}
+
+sk_sp<SkTypeface> AssetManagerFontStyleSet::createTypefaceLocked(
+    TypefaceAsset& asset) {
+  if (!asset.typeface) {
+    TRACE_EVENT0("flutter", "AssetManagerFontStyleSet::createTypeface");
+    sk_sp<SkData> asset_data = getDataLocked(asset);
+    if (asset_data == nullptr) {
+      return nullptr;
+    }
     std::unique_ptr<SkMemoryStream> stream = SkMemoryStream::Make(asset_data);
 
     // Ownership of the stream is transferred.
@@ -121,13 +246,17 @@ SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
                       << family_name_;
       return nullptr;
     }
+    // The typeface keeps its own reference to the data.
+    asset.data = nullptr;
   }
 
-  return SkRef(asset.typeface.get());
+  return asset.typeface;
 }
 
 SkTypeface* AssetManagerFontStyleSet::matchStyle(const SkFontStyle& pattern) {
-  return matchStyleCSS3(pattern);
+  SkTypeface* typeface = matchStyleCSS3(pattern);
+  preloadTypefaces();
+  return typeface;
 }
 
 AssetManagerFontStyleSet::TypefaceAsset::TypefaceAsset(std::string a)
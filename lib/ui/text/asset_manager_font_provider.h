@@ -5,13 +5,18 @@
 #ifndef FLUTTER_LIB_UI_TEXT_ASSET_MANAGER_FONT_PROVIDER_H_
 #define FLUTTER_LIB_UI_TEXT_ASSET_MANAGER_FONT_PROVIDER_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "flutter/assets/asset_manager.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkTypeface.h"
 #include "txt/font_asset_provider.h"
@@ -20,13 +25,19 @@ namespace flutter {
 
 class AssetManagerFontStyleSet : public SkFontStyleSet {
  public:
-  AssetManagerFontStyleSet(std::shared_ptr<AssetManager> asset_manager,
-                           std::string family_name);
+  AssetManagerFontStyleSet(
+      std::shared_ptr<AssetManager> asset_manager,
+      std::string family_name,
+      std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner);
 
   ~AssetManagerFontStyleSet() override;
 
   void registerAsset(std::string asset);
 
+  // Creates the typefaces of all of the assets, so that later calls to
+  // createTypeface do not have to.
+  void loadTypefaces();
+
   // |SkFontStyleSet|
   int count() override;
 
@@ -42,6 +53,8 @@ class AssetManagerFontStyleSet : public SkFontStyleSet {
  private:
   std::shared_ptr<AssetManager> asset_manager_;
   std::string family_name_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner_;
+  std::atomic_bool preload_posted_ = false;
 
   struct TypefaceAsset {
     explicit TypefaceAsset(std::string a);
@@ -51,17 +64,45 @@ class AssetManagerFontStyleSet : public SkFontStyleSet {
     ~TypefaceAsset();
 
     std::string asset;
+    // The contents of the asset, once it has been read.
+    sk_sp<SkData> data;
+    // The style read from the font tables of the asset, before its typeface
+    // is created.
+    std::optional<SkFontStyle> style;
     sk_sp<SkTypeface> typeface;
   };
+  // Guards the assets, as their typefaces may be created on a worker thread.
+  std::mutex mutex_;
   std::vector<TypefaceAsset> assets_;
 
+  sk_sp<SkData> getDataLocked(TypefaceAsset& asset);
+
+  sk_sp<SkTypeface> createTypefaceLocked(TypefaceAsset& asset);
+
+  // Posts a task creating the typefaces of all of the assets to
+  // preload_task_runner_, the first time it is called.
+  void preloadTypefaces();
+
   FML_DISALLOW_COPY_AND_ASSIGN(AssetManagerFontStyleSet);
 };
 
 class AssetManagerFontProvider : public txt::FontAssetProvider {
  public:
-  explicit AssetManagerFontProvider(
-      std::shared_ptr<AssetManager> asset_manager);
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a provider for the font assets of `asset_manager`.
+  ///
+  ///             The typefaces of a family are created when text first uses
+  ///             the family, which is usually on the UI thread while the
+  ///             first frame is laid out. Only the typeface of the matched
+  ///             style is created there. If `preload_task_runner` is not null,
+  ///             the typefaces of the other styles of the family are then
+  ///             created on its workers, as text that uses a family often uses
+  ///             its other styles soon after. Families that are never used are
+  ///             never read.
+  ///
+  AssetManagerFontProvider(
+      std::shared_ptr<AssetManager> asset_manager,
+      std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner);
 
   ~AssetManagerFontProvider() override;
 
@@ -78,6 +119,7 @@ class AssetManagerFontProvider : public txt::FontAssetProvider {
 
  private:
   std::shared_ptr<AssetManager> asset_manager_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner_;
   std::unordered_map<std::string, sk_sp<AssetManagerFontStyleSet>>
       registered_families_;
   std::vector<std::string> family_names_;
@@ -0,0 +1,81 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/text/asset_manager_font_provider.h"
+
+#include <memory>
+
+#include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+std::unique_ptr<AssetManagerFontProvider> CreateRobotoProvider(
+    std::shared_ptr<fml::ConcurrentTaskRunner> preload_task_runner) {
+  auto asset_manager = std::make_shared<AssetManager>();
+  asset_manager->PushBack(std::make_unique<DirectoryAssetBundle>(
+      OpenFixturesDirectory(), false));
+  auto provider = std::make_unique<AssetManagerFontProvider>(
+      asset_manager, std::move(preload_task_runner));
+  provider->RegisterAsset("Roboto", "Roboto-Regular.ttf");
+  provider->RegisterAsset("Roboto", "Roboto-Bold.ttf");
+  provider->RegisterAsset("Roboto", "Roboto-Italic.ttf");
+  return provider;
+}
+
+}  // namespace
+
+TEST(AssetManagerFontProviderTest, StylesMatchTheirTypefaces) {
+  auto provider = CreateRobotoProvider(nullptr);
+  sk_sp<SkFontStyleSet> font_style_set(provider->MatchFamily("Roboto"));
+  ASSERT_TRUE(font_style_set);
+  ASSERT_EQ(font_style_set->count(), 3);
+
+  // The styles are read from the font tables before any typeface exists.
+  std::vector<SkFontStyle> styles(font_style_set->count());
+  for (int i = 0; i < font_style_set->count(); i++) {
+    font_style_set->getStyle(i, &styles[i], nullptr);
+  }
+  EXPECT_EQ(styles[0], SkFontStyle::Normal());
+  EXPECT_EQ(styles[1], SkFontStyle::Bold());
+  EXPECT_EQ(styles[2], SkFontStyle::Italic());
+
+  sk_sp<SkTypeface> bold(font_style_set->matchStyle(SkFontStyle::Bold()));
+  ASSERT_TRUE(bold);
+  EXPECT_EQ(bold->fontStyle(), SkFontStyle::Bold());
+
+  for (int i = 0; i < font_style_set->count(); i++) {
+    sk_sp<SkTypeface> typeface(font_style_set->createTypeface(i));
+    ASSERT_TRUE(typeface);
+    EXPECT_EQ(typeface->fontStyle(), styles[i]);
+  }
+}
+
+TEST(AssetManagerFontProviderTest, PreloadsOtherStylesOfMatchedFamilies) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto provider = CreateRobotoProvider(loop->GetTaskRunner());
+  sk_sp<SkFontStyleSet> font_style_set(provider->MatchFamily("Roboto"));
+  ASSERT_TRUE(font_style_set);
+
+  // Text may use the family while its other typefaces are being loaded.
+  sk_sp<SkTypeface> italic(font_style_set->matchStyle(SkFontStyle::Italic()));
+  ASSERT_TRUE(italic);
+  EXPECT_EQ(italic->fontStyle(), SkFontStyle::Italic());
+  sk_sp<SkTypeface> bold(font_style_set->matchStyle(SkFontStyle::Bold()));
+  ASSERT_TRUE(bold);
+  EXPECT_EQ(bold->fontStyle(), SkFontStyle::Bold());
+  loop.reset();
+
+  for (int i = 0; i < font_style_set->count(); i++) {
+    sk_sp<SkTypeface> typeface(font_style_set->createTypeface(i));
+    ASSERT_TRUE(typeface);
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -74,7 +74,8 @@ void FontCollection::SetupDefaultFontManager(
 }
 
 void FontCollection::RegisterFonts(
-    std::shared_ptr<AssetManager> asset_manager) {
+    std::shared_ptr<AssetManager> asset_manager,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
   std::unique_ptr<fml::Mapping> manifest_mapping =
       asset_manager->GetAsMapping("FontManifest.json");
   if (manifest_mapping == nullptr) {
@@ -100,7 +101,7 @@ void FontCollection::RegisterFonts(
   }
 
   auto font_provider =
-      std::make_unique<AssetManagerFontProvider>(asset_manager);
+      std::make_unique<AssetManagerFontProvider>(asset_manager, task_runner);
 
   for (const auto& family : document.GetArray()) {
     auto family_name = family.FindMember("family");
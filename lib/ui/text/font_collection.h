@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "flutter/assets/asset_manager.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "txt/font_collection.h"
@@ -31,7 +32,16 @@ class FontCollection {
 
   void SetupDefaultFontManager(uint32_t font_initialization_data);
 
-  void RegisterFonts(std::shared_ptr<AssetManager> asset_manager);
+  //----------------------------------------------------------------------------
+  /// @brief      Registers the fonts listed in the font manifest of
+  ///             `asset_manager`. Only the manifest is read here. The font
+  ///             assets of a family are read, and their typefaces created,
+  ///             when text first uses the family. The typefaces of the styles
+  ///             it did not use are then created on the workers of
+  ///             `task_runner`, if it is not null.
+  ///
+  void RegisterFonts(std::shared_ptr<AssetManager> asset_manager,
+                     std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
 
   void RegisterTestFonts();
 
@@ -88,6 +88,11 @@ void Paragraph::layout(double width) {
 }
 
 void Paragraph::paint(Canvas* canvas, double x, double y) {
+  DisplayListBuilder* builder = canvas->display_list_builder();
+  if (builder && m_paragraph->CanPaintToDisplayList()) {
+    m_paragraph->Paint(builder, x, y);
+    return;
+  }
   SkCanvas* sk_canvas = canvas->canvas();
   if (!sk_canvas) {
     return;
@@ -131,39 +136,61 @@ tonic::Float32List Paragraph::getRectsForPlaceholders() {
   return EncodeTextBoxes(boxes);
 }
 
-Dart_Handle Paragraph::getPositionForOffset(double dx, double dy) {
+tonic::Int32List Paragraph::getPositionForOffset(double dx, double dy) {
   txt::Paragraph::PositionWithAffinity pos =
       m_paragraph->GetGlyphPositionAtCoordinate(dx, dy);
-  std::vector<size_t> result = {
-      pos.position,                      // size_t already
-      static_cast<size_t>(pos.affinity)  // affinity (enum)
-  };
-  return tonic::DartConverter<decltype(result)>::ToDart(result);
+  // Layout:
+  // The position, then the index of the affinity.
+  tonic::Int32List result(Dart_NewTypedData(Dart_TypedData_kInt32, 2));
+  result[0] = pos.position;
+  result[1] = static_cast<int32_t>(pos.affinity);
+  return result;
 }
 
-Dart_Handle Paragraph::getWordBoundary(unsigned offset) {
+tonic::Int32List Paragraph::getWordBoundary(unsigned offset) {
   txt::Paragraph::Range<size_t> point = m_paragraph->GetWordBoundary(offset);
-  std::vector<size_t> result = {point.start, point.end};
-  return tonic::DartConverter<decltype(result)>::ToDart(result);
+  // Layout:
+  // The start and the end of the word.
+  tonic::Int32List result(Dart_NewTypedData(Dart_TypedData_kInt32, 2));
+  result[0] = point.start;
+  result[1] = point.end;
+  return result;
 }
 
-Dart_Handle Paragraph::getLineBoundary(unsigned offset) {
-  std::vector<txt::LineMetrics> metrics = m_paragraph->GetLineMetrics();
-  int line_start = -1;
-  int line_end = -1;
-  for (txt::LineMetrics& line : metrics) {
+// Finds the first line that contains |offset|, and writes its start and end
+// to |result| at |position|, or -1 for both if there is none.
+static void EncodeLineBoundary(const std::vector<txt::LineMetrics>& metrics,
+                               size_t offset,
+                               tonic::Int32List& result,
+                               size_t position) {
+  int32_t line_start = -1;
+  int32_t line_end = -1;
+  for (const txt::LineMetrics& line : metrics) {
     if (offset >= line.start_index && offset <= line.end_index) {
       line_start = line.start_index;
       line_end = line.end_index;
       break;
     }
   }
-  std::vector<int> result = {line_start, line_end};
-  return tonic::DartConverter<decltype(result)>::ToDart(result);
+  result[position] = line_start;
+  result[position + 1] = line_end;
+}
+
+tonic::Int32List Paragraph::getLineBoundary(unsigned offset) {
+  const std::vector<txt::LineMetrics>& metrics = m_paragraph->GetLineMetrics();
+
+  // Layout:
+  // The start and the end of the line that contains |offset|, then those of
+  // the line that contains |offset| + 1, so that the caller can account for
+  // the affinity without a second call.
+  tonic::Int32List result(Dart_NewTypedData(Dart_TypedData_kInt32, 4));
+  EncodeLineBoundary(metrics, offset, result, 0);
+  EncodeLineBoundary(metrics, static_cast<size_t>(offset) + 1, result, 2);
+  return result;
 }
 
 tonic::Float64List Paragraph::computeLineMetrics() {
-  std::vector<txt::LineMetrics> metrics = m_paragraph->GetLineMetrics();
+  const std::vector<txt::LineMetrics>& metrics = m_paragraph->GetLineMetrics();
 
   // Layout:
   // boxes.size() groups of 9 which are the line metrics
@@ -48,9 +48,9 @@ class Paragraph : public RefCountedDartWrappable<Paragraph> {
                                       unsigned boxHeightStyle,
                                       unsigned boxWidthStyle);
   tonic::Float32List getRectsForPlaceholders();
-  Dart_Handle getPositionForOffset(double dx, double dy);
-  Dart_Handle getWordBoundary(unsigned offset);
-  Dart_Handle getLineBoundary(unsigned offset);
+  tonic::Int32List getPositionForOffset(double dx, double dy);
+  tonic::Int32List getWordBoundary(unsigned offset);
+  tonic::Int32List getLineBoundary(unsigned offset);
   tonic::Float64List computeLineMetrics();
 
   size_t GetAllocationSize() const override;
@@ -4,6 +4,10 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/common/settings.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/painting/image_downscaler.h"
+#include "flutter/lib/ui/painting/image_generator_registry.h"
+#include "flutter/lib/ui/painting/parallel_png_encoder.h"
 #include "flutter/lib/ui/volatile_path_tracker.h"
 #include "flutter/lib/ui/window/platform_message_response_dart.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
@@ -112,9 +116,151 @@ static void BM_PathVolatilityTracker(benchmark::State& state) {
   }
 }
 
+// A 12MP bitmap with the sizes of a typical phone camera photo. It has some
+// structure in it so that it does not compress unrealistically well.
+static const SkBitmap& GetPhotoBitmap() {
+  static const SkBitmap bitmap = [] {
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(4032, 3024));
+    for (int y = 0; y < bitmap.height(); y++) {
+      for (int x = 0; x < bitmap.width(); x++) {
+        *bitmap.getAddr32(x, y) =
+            SkColorSetARGB(255, x * 255 / bitmap.width(),
+                           y * 255 / bitmap.height(), (x * y) % 251);
+      }
+    }
+    bitmap.setImmutable();
+    return bitmap;
+  }();
+  return bitmap;
+}
+
+static const SkISize kThumbnailSize = SkISize::Make(256, 192);
+
+static void BM_DownscalePhotoWithScalePixels(benchmark::State& state) {
+  auto image = SkImage::MakeFromBitmap(GetPhotoBitmap());
+  SkBitmap thumbnail;
+  thumbnail.allocPixels(image->imageInfo().makeDimensions(kThumbnailSize));
+  while (state.KeepRunning()) {
+    FML_CHECK(image->scalePixels(
+        thumbnail.pixmap(),
+        SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone),
+        SkImage::kDisallow_CachingHint));
+  }
+}
+
+static void BM_DownscalePhotoWithImageDownscaler(benchmark::State& state) {
+  const auto& bitmap = GetPhotoBitmap();
+  while (state.KeepRunning()) {
+    FML_CHECK(ImageDownscaler::Downscale(bitmap.pixmap(), kThumbnailSize));
+  }
+}
+
+static sk_sp<SkData> GetPhotoJpeg() {
+  static const sk_sp<SkData> jpeg =
+      SkImage::MakeFromBitmap(GetPhotoBitmap())
+          ->encodeToData(SkEncodedImageFormat::kJPEG, 90);
+  FML_CHECK(jpeg);
+  return jpeg;
+}
+
+static std::shared_ptr<ImageGenerator> MakePhotoJpegGenerator() {
+  ImageGeneratorRegistry registry;
+  auto generator = registry.CreateCompatibleGenerator(GetPhotoJpeg());
+  FML_CHECK(generator);
+  return generator;
+}
+
+// How the decoder resized photos before: decode at full size, then scale.
+static void BM_DecodePhotoThumbnailWithScalePixels(benchmark::State& state) {
+  auto generator = MakePhotoJpegGenerator();
+  const auto info = generator->GetInfo();
+  while (state.KeepRunning()) {
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    FML_CHECK(generator->GetPixels(info, bitmap.getPixels(),
+                                   bitmap.rowBytes()));
+    SkBitmap thumbnail;
+    thumbnail.allocPixels(info.makeDimensions(kThumbnailSize));
+    FML_CHECK(bitmap.pixmap().scalePixels(
+        thumbnail.pixmap(),
+        SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone)));
+  }
+}
+
+// Shrinks rows as they are decoded, never allocating the full size bitmap.
+static void BM_DecodePhotoThumbnailWithScanlines(benchmark::State& state) {
+  auto generator = MakePhotoJpegGenerator();
+  const auto info = generator->GetInfo().makeAlphaType(kPremul_SkAlphaType);
+  while (state.KeepRunning()) {
+    ImageDownscaler downscaler(info, kThumbnailSize);
+    FML_CHECK(generator->GetScanlines(
+        info, [&downscaler](const void* row) { downscaler.AddRow(row); }));
+    FML_CHECK(downscaler.MakeImage());
+  }
+}
+
+// The latency of decoding a full size photo, with and without splitting it
+// into bands decoded by the workers of a concurrent message loop.
+static void BM_DecodeFullSizePhoto(benchmark::State& state) {
+  const bool in_bands = state.range(0);
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+      GetPhotoJpeg(), MakePhotoJpegGenerator());
+  const auto& info = descriptor->image_info();
+  while (state.KeepRunning()) {
+    FML_CHECK(ImageFromCompressedData(
+        descriptor.get(), info.width(), info.height(),
+        fml::tracing::TraceFlow(""),
+        in_bands ? loop->GetTaskRunner() : nullptr));
+  }
+  loop->Terminate();
+}
+
+// Encoding a photo as a PNG with Skia's encoder, and in bands deflated by the
+// workers of a concurrent message loop.
+static void BM_EncodePhotoAsPNG(benchmark::State& state) {
+  const bool in_bands = state.range(0);
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  SkBitmap bitmap;
+  bitmap.allocPixels(GetPhotoBitmap().info().makeColorType(
+      kRGBA_8888_SkColorType));
+  FML_CHECK(GetPhotoBitmap().readPixels(bitmap.pixmap()));
+  auto image = SkImage::MakeFromBitmap(bitmap);
+  while (state.KeepRunning()) {
+    if (in_bands) {
+      FML_CHECK(ParallelPngEncoder::Encode(bitmap.pixmap(), {},
+                                           loop->GetTaskRunner()));
+    } else {
+      FML_CHECK(image->encodeToData(SkEncodedImageFormat::kPNG, 100));
+    }
+  }
+  loop->Terminate();
+}
+
 BENCHMARK(BM_PlatformMessageResponseDartComplete)
     ->Unit(benchmark::kMicrosecond);
 
 BENCHMARK(BM_PathVolatilityTracker)->Unit(benchmark::kMillisecond);
 
+BENCHMARK(BM_DownscalePhotoWithScalePixels)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DownscalePhotoWithImageDownscaler)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodePhotoThumbnailWithScalePixels)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodePhotoThumbnailWithScanlines)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodeFullSizePhoto)
+    ->ArgName("in_bands")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_EncodePhotoAsPNG)
+    ->ArgName("in_bands")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 }  // namespace flutter
@@ -285,16 +285,21 @@ class CkImage implements ui.Image, StackTraceDebugger {
   @override
   Future<ByteData> toByteData({
     ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    ui.ImageEncodingOptions options = const ui.ImageEncodingOptions(),
   }) {
     assert(_debugCheckIsNotDisposed());
-    if (videoFrame != null) {
+    // Video frames can only be encoded as PNG, so JPEG and WebP images are
+    // encoded by CanvasKit.
+    final bool isCanvasKitFormat = format == ui.ImageByteFormat.jpeg ||
+        format == ui.ImageByteFormat.webp;
+    if (videoFrame != null && !isCanvasKitFormat) {
       return readPixelsFromVideoFrame(videoFrame!, format);
     } else {
-      return _readPixelsFromSkImage(format);
+      return _readPixelsFromSkImage(format, options.quality);
     }
   }
 
-  Future<ByteData> _readPixelsFromSkImage(ui.ImageByteFormat format) {
+  Future<ByteData> _readPixelsFromSkImage(ui.ImageByteFormat format, int quality) {
     final SkAlphaType alphaType = format == ui.ImageByteFormat.rawStraightRgba ? canvasKit.AlphaType.Unpremul : canvasKit.AlphaType.Premul;
     final ByteData? data = _encodeImage(
       skImage: skImage,
@@ -302,6 +307,7 @@ class CkImage implements ui.Image, StackTraceDebugger {
       alphaType: alphaType,
       colorType: canvasKit.ColorType.RGBA_8888,
       colorSpace: SkColorSpaceSRGB,
+      quality: quality,
     );
     if (data == null) {
       return Future<ByteData>.error('Failed to encode the image into bytes.');
@@ -316,6 +322,7 @@ class CkImage implements ui.Image, StackTraceDebugger {
     required SkAlphaType alphaType,
     required SkColorType colorType,
     required ColorSpace colorSpace,
+    int quality = 100,
   }) {
     Uint8List? bytes;
 
@@ -328,6 +335,10 @@ class CkImage implements ui.Image, StackTraceDebugger {
         height: skImage.height(),
       );
       bytes = skImage.readPixels(0, 0, imageInfo);
+    } else if (format == ui.ImageByteFormat.jpeg) {
+      bytes = skImage.encodeToBytes(canvasKit.ImageFormat.JPEG, quality);
+    } else if (format == ui.ImageByteFormat.webp) {
+      bytes = skImage.encodeToBytes(canvasKit.ImageFormat.WEBP, quality);
     } else {
       bytes = skImage.encodeToBytes(); // defaults to PNG 100%
     }
@@ -171,7 +171,10 @@ class HtmlImage implements ui.Image {
   final int height;
 
   @override
-  Future<ByteData?> toByteData({ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba}) {
+  Future<ByteData?> toByteData({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    ui.ImageEncodingOptions options = const ui.ImageEncodingOptions(),
+  }) {
     switch (format) {
       // TODO(ColdPaleLight): https://github.com/flutter/flutter/issues/89128
       // The format rawRgba always returns straight rather than premul currently.
@@ -184,6 +187,9 @@ class HtmlImage implements ui.Image {
         ctx.drawImage(imgElement, 0, 0);
         final html.ImageData imageData = ctx.getImageData(0, 0, width, height);
         return Future<ByteData?>.value(imageData.data.buffer.asByteData());
+      case ui.ImageByteFormat.jpeg:
+      case ui.ImageByteFormat.webp:
+        return Future<ByteData?>.error(UnsupportedError('$format is not supported on the web.'));
       default:
         if (imgElement.src?.startsWith('data:') == true) {
           final UriData data = UriData.fromUri(Uri.parse(imgElement.src!));
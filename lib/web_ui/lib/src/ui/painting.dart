@@ -333,7 +333,10 @@ abstract class Gradient extends Shader {
 abstract class Image {
   int get width;
   int get height;
-  Future<ByteData?> toByteData({ImageByteFormat format = ImageByteFormat.rawRgba});
+  Future<ByteData?> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    ImageEncodingOptions options = const ImageEncodingOptions(),
+  });
   void dispose();
   bool get debugDisposed;
 
@@ -428,6 +431,30 @@ enum ImageByteFormat {
   rawStraightRgba,
   rawUnmodified,
   png,
+  jpeg,
+  webp,
+}
+
+enum PngFilter {
+  none,
+  sub,
+  up,
+  average,
+  paeth,
+  adaptive,
+}
+
+class ImageEncodingOptions {
+  const ImageEncodingOptions({
+    this.quality = 90,
+    this.compressionLevel = 6,
+    this.pngFilter = PngFilter.adaptive,
+  }) : assert(quality >= 0 && quality <= 100),
+       assert(compressionLevel >= 0 && compressionLevel <= 9);
+
+  final int quality;
+  final int compressionLevel;
+  final PngFilter pngFilter;
 }
 
 enum PixelFormat {
@@ -800,6 +827,43 @@ class ImageDescriptor {
   }
 }
 
+// The browser decodes images itself, so the chunks are collected and decoded
+// once the last one has been added.
+class IncrementalImageDecoder {
+  IncrementalImageDecoder();
+
+  List<Uint8List>? _chunks = <Uint8List>[];
+
+  Future<Image?> addChunk(Uint8List chunk, {bool isLast = false}) async {
+    final List<Uint8List>? chunks = _chunks;
+    if (chunks == null) {
+      throw StateError('Object is disposed');
+    }
+    chunks.add(chunk);
+    if (!isLast) {
+      return null;
+    }
+    _chunks = null;
+
+    int length = 0;
+    for (final Uint8List chunk in chunks) {
+      length += chunk.length;
+    }
+    final Uint8List bytes = Uint8List(length);
+    int offset = 0;
+    for (final Uint8List chunk in chunks) {
+      bytes.setAll(offset, chunk);
+      offset += chunk.length;
+    }
+    final Codec codec = await instantiateImageCodec(bytes);
+    final FrameInfo frame = await codec.getNextFrame();
+    codec.dispose();
+    return frame.image;
+  }
+
+  void dispose() => _chunks = null;
+}
+
 class FragmentProgram {
   static Future<FragmentProgram> compile({
     required ByteBuffer spirv,
@@ -1322,6 +1322,14 @@ void _canvasTests() {
     final ByteData pngData =
         await image.toByteData(format: ui.ImageByteFormat.png);
     expect(pngData.lengthInBytes, greaterThan(0));
+    final ByteData jpegData =
+        await image.toByteData(format: ui.ImageByteFormat.jpeg);
+    // JPEG files start with an SOI marker.
+    expect(jpegData.getUint16(0), 0xFFD8);
+    final ByteData webpData =
+        await image.toByteData(format: ui.ImageByteFormat.webp);
+    // WebP files are RIFF containers.
+    expect(webpData.getUint32(0), 0x52494646);
   });
 }
 
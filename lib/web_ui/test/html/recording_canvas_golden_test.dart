@@ -712,8 +712,10 @@ class TestImage implements Image {
   int get height => 10;
 
   @override
-  Future<ByteData> toByteData(
-      {ImageByteFormat format = ImageByteFormat.rawRgba}) async {
+  Future<ByteData> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    ImageEncodingOptions options = const ImageEncodingOptions(),
+  }) async {
     throw UnsupportedError('Cannot encode test image');
   }
 
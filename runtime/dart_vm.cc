@@ -278,7 +278,11 @@ DartVM::DartVM(std::shared_ptr<const DartVMData> vm_data,
       concurrent_message_loop_(fml::ConcurrentMessageLoop::Create()),
       skia_concurrent_executor_(
           [runner = concurrent_message_loop_->GetTaskRunner()](
-              fml::closure work) { runner->PostTask(work); }),
+              fml::closure work) {
+            // Skia hands the executor shader compilation and other work that
+            // the frame being rasterized is waiting on.
+            runner->PostTask(work, fml::ConcurrentTaskPriority::kUserBlocking);
+          }),
       vm_data_(vm_data),
       isolate_name_server_(std::move(isolate_name_server)),
       service_protocol_(std::make_shared<ServiceProtocol>()) {
@@ -34,6 +34,10 @@ const std::string_view ServiceProtocol::kGetDisplayRefreshRateExtensionName =
     "_flutter.getDisplayRefreshRate";
 const std::string_view ServiceProtocol::kGetSkSLsExtensionName =
     "_flutter.getSkSLs";
+const std::string_view ServiceProtocol::kGetShaderUsageExtensionName =
+    "_flutter.getShaderUsage";
+const std::string_view ServiceProtocol::kGetTextLayoutCacheStatsExtensionName =
+    "_flutter.getTextLayoutCacheStats";
 const std::string_view
     ServiceProtocol::kEstimateRasterCacheMemoryExtensionName =
         "_flutter.estimateRasterCacheMemory";
@@ -55,6 +59,8 @@ ServiceProtocol::ServiceProtocol()
           kSetAssetBundlePathExtensionName,
           kGetDisplayRefreshRateExtensionName,
           kGetSkSLsExtensionName,
+          kGetShaderUsageExtensionName,
+          kGetTextLayoutCacheStatsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
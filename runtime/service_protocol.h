@@ -28,6 +28,8 @@ class ServiceProtocol {
   static const std::string_view kSetAssetBundlePathExtensionName;
   static const std::string_view kGetDisplayRefreshRateExtensionName;
   static const std::string_view kGetSkSLsExtensionName;
+  static const std::string_view kGetShaderUsageExtensionName;
+  static const std::string_view kGetTextLayoutCacheStatsExtensionName;
   static const std::string_view kEstimateRasterCacheMemoryExtensionName;
 
   class Handler {
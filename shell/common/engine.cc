@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/common/settings.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
@@ -30,6 +31,9 @@ static constexpr char kLocalizationChannel[] = "flutter/localization";
 static constexpr char kSettingsChannel[] = "flutter/settings";
 static constexpr char kIsolateChannel[] = "flutter/isolate";
 
+// The fallback fonts matched by earlier runs, in the persistent cache.
+static constexpr char kFontFallbackIndexFileName[] = "font_fallback_index";
+
 namespace {
 fml::MallocMapping MakeMapping(const std::string& str) {
   return fml::MallocMapping::Copy(str.c_str(), str.length());
@@ -53,10 +57,16 @@ Engine::Engine(
       activity_running_(true),
       have_surface_(false),
       font_collection_(font_collection),
-      image_decoder_(task_runners, image_decoder_task_runner, io_manager),
+      concurrent_task_runner_(image_decoder_task_runner),
+      image_decoder_(task_runners,
+                     image_decoder_task_runner,
+                     io_manager,
+                     settings_.decoded_image_cache_max_bytes),
       task_runners_(std::move(task_runners)),
       weak_factory_(this) {
   pointer_data_dispatcher_ = dispatcher_maker(*this);
+  txt::FontCollection::SetLayoutCacheCapacity(
+      settings_.text_layout_cache_max_bytes);
 }
 
 Engine::Engine(Delegate& delegate,
@@ -171,12 +181,16 @@ bool Engine::UpdateAssetManager(
   }
 
   // Using libTXT as the text engine.
-  font_collection_->RegisterFonts(asset_manager_);
+  font_collection_->RegisterFonts(asset_manager_, concurrent_task_runner_);
 
   if (settings_.use_test_fonts) {
     font_collection_->RegisterTestFonts();
   }
 
+  font_collection_->GetFontCollection()->LoadFallbackIndex(
+      PersistentCache::GetCacheForProcess()->LoadDataFile(
+          kFontFallbackIndexFileName));
+
   return true;
 }
 
@@ -245,6 +259,21 @@ Engine::RunStatus Engine::Run(RunConfiguration configuration) {
 void Engine::BeginFrame(fml::TimePoint frame_time, uint64_t frame_number) {
   TRACE_EVENT0("flutter", "Engine::BeginFrame");
   runtime_controller_->BeginFrame(frame_time, frame_number);
+  TraceTextLayoutCacheStats();
+}
+
+void Engine::TraceTextLayoutCacheStats() {
+  const minikin::LayoutCacheStats stats =
+      txt::FontCollection::GetLayoutCacheStats();
+  const uint64_t lookups = stats.hitCount + stats.missCount;
+  if (lookups == traced_text_layout_lookups_) {
+    return;
+  }
+  traced_text_layout_lookups_ = lookups;
+  FML_TRACE_COUNTER("flutter", "TextLayoutCache",
+                    reinterpret_cast<int64_t>(this),  // Trace Counter ID
+                    "Hits", stats.hitCount, "Misses", stats.missCount,
+                    "Evictions", stats.evictionCount, "Bytes", stats.sizeBytes);
 }
 
 void Engine::ReportTimings(std::vector<int64_t> timings) {
@@ -257,6 +286,18 @@ void Engine::NotifyIdle(int64_t deadline) {
   TRACE_EVENT1("flutter", "Engine::NotifyIdle", "deadline_now_delta",
                trace_event.c_str());
   runtime_controller_->NotifyIdle(deadline);
+
+  // Keeps the fallback fonts matched so far for the next run.
+  if (auto fallback_index =
+          font_collection_->GetFontCollection()->SerializeFallbackIndex()) {
+    PersistentCache::GetCacheForProcess()->StoreDataFile(
+        kFontFallbackIndexFileName, std::move(fallback_index));
+  }
+}
+
+void Engine::NotifyLowMemoryWarning() {
+  TRACE_EVENT0("flutter", "Engine::NotifyLowMemoryWarning");
+  image_decoder_.PurgeDecodedImageCache();
 }
 
 std::optional<uint32_t> Engine::GetUIIsolateReturnCode() {
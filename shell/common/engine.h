@@ -549,6 +549,13 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   ///
   void NotifyIdle(int64_t deadline);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Notifies the engine that the application is running low on
+  ///             memory. The engine drops the decoded images it caches for
+  ///             reuse.
+  ///
+  void NotifyLowMemoryWarning();
+
   //----------------------------------------------------------------------------
   /// @brief      Dart code cannot fully measure the time it takes for a
   ///             specific frame to be rendered. This is because Dart code only
@@ -950,6 +957,10 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
 
   bool GetAssetAsBuffer(const std::string& name, std::vector<uint8_t>* data);
 
+  // Emits the counters of the text layout cache if words were looked up in it
+  // since they were last emitted.
+  void TraceTextLayoutCacheStats();
+
   friend class testing::ShellTest;
 
   Engine::Delegate& delegate_;
@@ -971,6 +982,10 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   bool activity_running_;
   bool have_surface_;
   std::shared_ptr<FontCollection> font_collection_;
+  // Preloads the typefaces of the font families in use, among other
+  // background work.
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  uint64_t traced_text_layout_lookups_ = 0;
   ImageDecoder image_decoder_;
   ImageGeneratorRegistry image_generator_registry_;
   TaskRunners task_runners_;
@@ -14,6 +14,7 @@
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/log_settings.h"
+#include "flutter/fml/thread.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/switches.h"
@@ -402,5 +403,291 @@ TEST_F(PersistentCacheTest,
   DestroyShell(std::move(shell));
 }
 
+TEST_F(PersistentCacheTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_LoadsSkSLsInFirstUseOrder
+#else
+       LoadsSkSLsInFirstUseOrder
+#endif  // defined(WINUWP)
+) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  auto settings = CreateSettingsForFixture();
+  settings.cache_sksl = true;
+  auto store = [this, &settings](const std::vector<std::string>& keys) {
+    auto config = RunConfiguration::InferFromSettings(settings);
+    std::unique_ptr<Shell> shell = CreateShell(settings);
+    RunEngine(shell.get(), std::move(config));
+    for (const auto& key : keys) {
+      StorePersistentCache(PersistentCache::GetCacheForProcess(),
+                           *SkData::MakeWithCopy(key.data(), key.size()),
+                           *SkData::MakeWithCString("value"));
+    }
+    WaitForIO(shell.get());
+    DestroyShell(std::move(shell));
+  };
+
+  // Shaders that are stored again keep their place.
+  store({"d", "b", "e", "b"});
+  // The order is kept by new instances of the cache.
+  PersistentCache::ResetCacheForProcess();
+  store({"a", "c", "d"});
+
+  auto sksls = PersistentCache::GetCacheForProcess()->LoadSkSLs();
+  const std::vector<std::string> expected_keys = {"d", "b", "e", "a", "c"};
+  ASSERT_EQ(sksls.size(), expected_keys.size());
+  for (size_t i = 0; i < expected_keys.size(); i++) {
+    CheckTextSkData(sksls[i].key, expected_keys[i]);
+  }
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(PersistentCacheTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_RecordsShaderUsage
+#else
+       RecordsShaderUsage
+#endif  // defined(WINUWP)
+) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  auto settings = CreateSettingsForFixture();
+  auto config = RunConfiguration::InferFromSettings(settings);
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  RunEngine(shell.get(), std::move(config));
+
+  sk_sp<SkData> key = SkData::MakeWithCString("key");
+  sk_sp<SkData> other_key = SkData::MakeWithCString("other_key");
+  auto persistent_cache = PersistentCache::GetCacheForProcess();
+  persistent_cache->SetFrameNumber(7);
+  ASSERT_FALSE(persistent_cache->load(*key));
+  StorePersistentCache(persistent_cache, *key,
+                       *SkData::MakeWithCString("value"));
+  WaitForIO(shell.get());
+  persistent_cache->SetFrameNumber(8);
+  ASSERT_TRUE(persistent_cache->load(*key));
+  ASSERT_FALSE(persistent_cache->load(*other_key));
+
+  auto stats = persistent_cache->GetShaderUsageStats();
+  ASSERT_EQ(stats.hit_count, 1u);
+  ASSERT_EQ(stats.miss_count, 2u);
+  // Frame 8 has not ended yet.
+  ASSERT_EQ(stats.frames_with_misses, 1u);
+  ASSERT_EQ(stats.shaders.size(), 2u);
+  ASSERT_EQ(stats.shaders[0].key, std::string("key", 4));
+  ASSERT_EQ(stats.shaders[0].first_use_frame_number, 7u);
+  ASSERT_EQ(stats.shaders[0].hit_count, 1u);
+  ASSERT_EQ(stats.shaders[0].miss_count, 1u);
+  ASSERT_EQ(stats.shaders[1].key, std::string("other_key", 10));
+  ASSERT_EQ(stats.shaders[1].first_use_frame_number, 8u);
+  ASSERT_EQ(stats.shaders[1].hit_count, 0u);
+  ASSERT_EQ(stats.shaders[1].miss_count, 1u);
+  ASSERT_EQ(stats.shaders[1].compile_time, fml::TimeDelta::Zero());
+  ASSERT_EQ(stats.compile_time, stats.shaders[0].compile_time);
+
+  persistent_cache->SetFrameNumber(9);
+  ASSERT_EQ(persistent_cache->GetShaderUsageStats().frames_with_misses, 2u);
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+  DestroyShell(std::move(shell));
+}
+
+static sk_sp<SkData> MakeTextSkData(const std::string& text) {
+  return SkData::MakeWithCopy(text.data(), text.size());
+}
+
+TEST_F(PersistentCacheTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_MovesCacheFilesIntoPackedFile
+#else
+       MovesCacheFilesIntoPackedFile
+#endif  // defined(WINUWP)
+) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  auto sksl_dir = fml::CreateDirectory(
+      base_dir.fd(),
+      {"flutter_engine", GetFlutterEngineVersion(), "skia", GetSkiaVersion(),
+       PersistentCache::kSkSLSubdirName},
+      fml::FilePermission::kReadWrite);
+
+  // Files with an entry each, as written by older engines.
+  auto x_data = PersistentCache::BuildCacheObject(*MakeTextSkData("A"),
+                                                  *MakeTextSkData("x"));
+  auto y_data = PersistentCache::BuildCacheObject(*MakeTextSkData("B"),
+                                                  *MakeTextSkData("y"));
+  ASSERT_TRUE(fml::WriteAtomically(sksl_dir, "x_cache", *x_data));
+  ASSERT_TRUE(fml::WriteAtomically(sksl_dir, "y_cache", *y_data));
+
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+  auto persistent_cache = PersistentCache::GetCacheForProcess();
+
+  // The files are only moved by the first worker, and can be loaded until
+  // then.
+  ASSERT_TRUE(fml::FileExists(sksl_dir, "x_cache"));
+  ASSERT_EQ(persistent_cache->LoadSkSLs().size(), 2u);
+  fml::Thread worker("worker");
+  persistent_cache->AddWorkerTaskRunner(worker.GetTaskRunner());
+  std::promise<bool> moved;
+  worker.GetTaskRunner()->PostTask([&moved]() { moved.set_value(true); });
+  moved.get_future().wait();
+  persistent_cache->RemoveWorkerTaskRunner(worker.GetTaskRunner());
+
+  ASSERT_FALSE(fml::FileExists(sksl_dir, "x_cache"));
+  ASSERT_FALSE(fml::FileExists(sksl_dir, "y_cache"));
+  ASSERT_TRUE(fml::FileExists(sksl_dir, PersistentCache::kPackedCacheFileName));
+
+  // The entries are kept by new instances of the cache.
+  for (int i = 0; i < 2; i++) {
+    auto sksls = PersistentCache::GetCacheForProcess()->LoadSkSLs();
+    ASSERT_EQ(sksls.size(), 2u);
+    // The files were moved in the order the directory listed them.
+    if (sksls[0].key->equals(MakeTextSkData("B").get())) {
+      std::swap(sksls[0], sksls[1]);
+    }
+    CheckTextSkData(sksls[0].key, "A");
+    CheckTextSkData(sksls[0].value, "x");
+    CheckTextSkData(sksls[1].key, "B");
+    CheckTextSkData(sksls[1].value, "y");
+    PersistentCache::ResetCacheForProcess();
+  }
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(PersistentCacheTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_StoresDataFiles
+#else
+       StoresDataFiles
+#endif  // defined(WINUWP)
+) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  auto settings = CreateSettingsForFixture();
+  auto config = RunConfiguration::InferFromSettings(settings);
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  RunEngine(shell.get(), std::move(config));
+
+  auto persistent_cache = PersistentCache::GetCacheForProcess();
+  ASSERT_EQ(persistent_cache->LoadDataFile("data"), nullptr);
+  persistent_cache->StoreDataFile(
+      "data", std::make_unique<fml::DataMapping>(std::string("first")));
+  persistent_cache->StoreDataFile(
+      "data", std::make_unique<fml::DataMapping>(std::string("second")));
+  WaitForIO(shell.get());
+
+  // The data is also found by new instances of the cache.
+  PersistentCache::ResetCacheForProcess();
+  auto data = PersistentCache::GetCacheForProcess()->LoadDataFile("data");
+  ASSERT_NE(data, nullptr);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(data->GetMapping()),
+                        data->GetSize()),
+            "second");
+
+  // The file can be replaced while the loaded data is still in use, as the
+  // font fallback index does when it records new matches.
+  PersistentCache::GetCacheForProcess()->StoreDataFile(
+      "data", std::make_unique<fml::DataMapping>(std::string("third")));
+  WaitForIO(shell.get());
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(data->GetMapping()),
+                        data->GetSize()),
+            "second");
+  auto stored = PersistentCache::GetCacheForProcess()->LoadDataFile("data");
+  ASSERT_NE(stored, nullptr);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(stored->GetMapping()),
+                        stored->GetSize()),
+            "third");
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+  DestroyShell(std::move(shell));
+}
+
+TEST(PackedCacheFileTest, CompactsReplacedEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  constexpr char kFileName[] = "test.pack";
+
+  {
+    PackedCacheFile file(directory, kFileName, false);
+    ASSERT_EQ(file.GetEntryCount(), 0u);
+    ASSERT_TRUE(file.Store({{MakeTextSkData("b"), MakeTextSkData("1")},
+                            {MakeTextSkData("a"), MakeTextSkData("2")}}));
+    const size_t size = file.GetFileSize();
+    // Storing the same value again does not grow the file.
+    ASSERT_TRUE(file.Store({{MakeTextSkData("b"), MakeTextSkData("1")}}));
+    ASSERT_EQ(file.GetFileSize(), size);
+    ASSERT_TRUE(file.Store({{MakeTextSkData("b"), MakeTextSkData("3")}}));
+    ASSERT_GT(file.GetFileSize(), size);
+    CheckTextSkData(file.Load(*MakeTextSkData("b")), "3");
+    ASSERT_FALSE(file.Load(*MakeTextSkData("c")));
+
+    ASSERT_TRUE(file.Compact());
+    ASSERT_EQ(file.GetFileSize(), size);
+  }
+
+  PackedCacheFile file(directory, kFileName, true);
+  auto entries = file.LoadAll();
+  ASSERT_EQ(entries.size(), 2u);
+  CheckTextSkData(entries[0].key, "b");
+  CheckTextSkData(entries[0].value, "3");
+  CheckTextSkData(entries[1].key, "a");
+  CheckTextSkData(entries[1].value, "2");
+  ASSERT_FALSE(file.Store({{MakeTextSkData("c"), MakeTextSkData("4")}}));
+}
+
+TEST(PackedCacheFileTest, IgnoresIncompleteRecords) {
+  fml::ScopedTemporaryDirectory dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  constexpr char kFileName[] = "test.pack";
+
+  size_t size;
+  {
+    PackedCacheFile file(directory, kFileName, false);
+    ASSERT_TRUE(file.Store({{MakeTextSkData("a"), MakeTextSkData("1")}}));
+    size = file.GetFileSize();
+  }
+
+  // A record that was cut short.
+  {
+    auto fd = fml::OpenFile(*directory, kFileName, false,
+                            fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::TruncateFile(fd, size + 5));
+  }
+
+  PackedCacheFile file(directory, kFileName, false);
+  ASSERT_EQ(file.GetEntryCount(), 1u);
+  ASSERT_EQ(file.GetFileSize(), size);
+  // The next record overwrites the incomplete one.
+  ASSERT_TRUE(file.Store({{MakeTextSkData("b"), MakeTextSkData("2")}}));
+  auto entries = PackedCacheFile(directory, kFileName, true).LoadAll();
+  ASSERT_EQ(entries.size(), 2u);
+  CheckTextSkData(entries[1].key, "b");
+  CheckTextSkData(entries[1].value, "2");
+}
+
 }  // namespace testing
 }  // namespace flutter
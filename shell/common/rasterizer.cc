@@ -394,6 +394,7 @@ RasterStatus Rasterizer::DoDraw(
 
   PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
   persistent_cache->ResetStoredNewShaders();
+  persistent_cache->SetFrameNumber(frame_timings_recorder->GetFrameNumber());
 
   RasterStatus raster_status =
       DrawToSurface(*frame_timings_recorder, *layer_tree);
@@ -118,6 +118,8 @@ void PerformInitializationTasks(Settings& settings) {
   });
 
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+  PersistentCache::SetPrecompileInBackground(
+      settings.precompile_sksls_in_background);
 }
 
 }  // namespace
@@ -425,6 +427,15 @@ Shell::Shell(DartVMRef vm,
       task_runners_.GetIOTaskRunner(),
       std::bind(&Shell::OnServiceProtocolGetSkSLs, this, std::placeholders::_1,
                 std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kGetShaderUsageExtensionName] = {
+      task_runners_.GetIOTaskRunner(),
+      std::bind(&Shell::OnServiceProtocolGetShaderUsage, this,
+                std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetTextLayoutCacheStatsExtensionName] = {
+          task_runners_.GetUITaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetTextLayoutCacheStats, this,
+                    std::placeholders::_1, std::placeholders::_2)};
   service_protocol_handlers_
       [ServiceProtocol::kEstimateRasterCacheMemoryExtensionName] = {
           task_runners_.GetRasterTaskRunner(),
@@ -542,6 +553,11 @@ void Shell::NotifyLowMemoryWarning() const {
         TRACE_EVENT_ASYNC_END0("flutter", "Shell::NotifyLowMemoryWarning",
                                trace_id);
       });
+  task_runners_.GetUITaskRunner()->PostTask([engine = weak_engine_]() {
+    if (engine) {
+      engine->NotifyLowMemoryWarning();
+    }
+  });
   // The IO Manager uses resource cache limits of 0, so it is not necessary
   // to purge them.
 }
@@ -662,6 +678,8 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
 
   PersistentCache::GetCacheForProcess()->AddWorkerTaskRunner(
       task_runners_.GetIOTaskRunner());
+  PersistentCache::GetCacheForProcess()->SetBackgroundTaskRunner(
+      vm_->GetConcurrentWorkerTaskRunner());
 
   PersistentCache::GetCacheForProcess()->SetIsDumpingSkp(
       settings_.dump_skp_on_shader_compilation);
@@ -1679,6 +1697,65 @@ bool Shell::OnServiceProtocolGetSkSLs(
   return true;
 }
 
+bool Shell::OnServiceProtocolGetShaderUsage(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "GetShaderUsage", allocator);
+
+  const PersistentCache::ShaderUsageStats stats =
+      PersistentCache::GetCacheForProcess()->GetShaderUsageStats();
+  response->AddMember<uint64_t>("hits", stats.hit_count, allocator);
+  response->AddMember<uint64_t>("misses", stats.miss_count, allocator);
+  response->AddMember<uint64_t>("framesWithMisses", stats.frames_with_misses,
+                                allocator);
+  response->AddMember<int64_t>("compileMicros",
+                               stats.compile_time.ToMicroseconds(), allocator);
+
+  // Keyed like the SkSLs returned by |OnServiceProtocolGetSkSLs|.
+  rapidjson::Value shaders_json(rapidjson::kArrayType);
+  for (const auto& shader : stats.shaders) {
+    auto encode_result = fml::Base32Encode(shader.key);
+    if (!encode_result.first) {
+      continue;
+    }
+    rapidjson::Value shader_json(rapidjson::kObjectType);
+    shader_json.AddMember("key",
+                          rapidjson::Value(encode_result.second, allocator),
+                          allocator);
+    shader_json.AddMember<uint64_t>("firstUseFrame",
+                                    shader.first_use_frame_number, allocator);
+    shader_json.AddMember<uint64_t>("hits", shader.hit_count, allocator);
+    shader_json.AddMember<uint64_t>("misses", shader.miss_count, allocator);
+    shader_json.AddMember<int64_t>(
+        "compileMicros", shader.compile_time.ToMicroseconds(), allocator);
+    shaders_json.PushBack(shader_json, allocator);
+  }
+  response->AddMember("shaders", shaders_json, allocator);
+  return true;
+}
+
+bool Shell::OnServiceProtocolGetTextLayoutCacheStats(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  const minikin::LayoutCacheStats stats =
+      txt::FontCollection::GetLayoutCacheStats();
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "GetTextLayoutCacheStats", allocator);
+  response->AddMember<uint64_t>("hits", stats.hitCount, allocator);
+  response->AddMember<uint64_t>("misses", stats.missCount, allocator);
+  response->AddMember<uint64_t>("evictions", stats.evictionCount, allocator);
+  response->AddMember<uint64_t>("entries", stats.entryCount, allocator);
+  response->AddMember<uint64_t>("bytes", stats.sizeBytes, allocator);
+  response->AddMember<uint64_t>("capacityBytes", stats.capacityBytes,
+                                allocator);
+  return true;
+}
+
 bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
     rapidjson::Document* response) {
@@ -5,11 +5,17 @@
 #include "flutter/shell/common/shell.h"
 
 #include "flutter/benchmarking/benchmarking.h"
+#include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/elf_loader.h"
 #include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
 
 namespace flutter {
 
@@ -120,4 +126,114 @@ static void BM_ShellInitializationAndShutdown(benchmark::State& state) {
 
 BENCHMARK(BM_ShellInitializationAndShutdown);
 
+namespace {
+
+class ShellTestFixture : public testing::ShellTest {
+  void TestBody() override{};
+};
+
+// Draws `count` shapes, each with a combination of shader and blend mode that
+// needs a shader program of its own.
+testing::ShellTest::LayerTreeBuilder MakeShapesBuilder(
+    fml::RefPtr<fml::TaskRunner> unref_task_runner,
+    int count) {
+  return [unref_task_runner, count](std::shared_ptr<ContainerLayer> root) {
+    const SkPoint points[] = {{0, 0}, {40, 40}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(400, 400));
+    for (int i = 0; i < count; i++) {
+      SkPaint paint;
+      paint.setAntiAlias(i % 2 == 0);
+      paint.setBlendMode(static_cast<SkBlendMode>(i % 15));
+      switch ((i / 15) % 3) {
+        case 0:
+          paint.setShader(SkGradientShader::MakeLinear(
+              points, colors, nullptr, 2, SkTileMode::kClamp));
+          break;
+        case 1:
+          paint.setShader(SkGradientShader::MakeRadial(
+              points[1], 40, colors, nullptr, 2, SkTileMode::kMirror));
+          break;
+        default:
+          paint.setShader(
+              SkGradientShader::MakeSweep(20, 20, colors, nullptr, 2));
+          break;
+      }
+      const SkRect rect =
+          SkRect::MakeXYWH((i % 10) * 40, (i / 10) * 40, 40, 40);
+      if (i % 3 == 0) {
+        canvas->drawOval(rect, paint);
+      } else {
+        canvas->drawRRect(SkRRect::MakeRectXY(rect, 8, 8), paint);
+      }
+    }
+    auto queue = fml::MakeRefCounted<SkiaUnrefQueue>(unref_task_runner,
+                                                     fml::TimeDelta::Zero());
+    root->Add(std::make_shared<PictureLayer>(
+        SkPoint::Make(0, 0),
+        SkiaGPUObject<SkPicture>(recorder.finishRecordingAsPicture(), queue),
+        false, false));
+  };
+}
+
+}  // namespace
+
+// The time from the creation of the rendering surface until the first frame
+// is rasterized, with SkSLs for 90 shapes gathered by a previous run. The first
+// frame only draws 10 of them, so precompiling the SkSLs in the background
+// lets it start before all of them are compiled.
+static void BM_ShellTimeToFirstFrame(benchmark::State& state) {
+  ShellTestFixture fixture;
+  fml::ScopedTemporaryDirectory cache_dir;
+  PersistentCache::SetCacheDirectoryPath(cache_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  auto settings = fixture.CreateSettingsForFixture();
+  fml::AutoResetWaitableEvent first_frame_latch;
+  settings.frame_rasterized_callback =
+      [&first_frame_latch](const FrameTiming& timing) {
+        first_frame_latch.Signal();
+      };
+
+  auto run_until_first_frame = [&](int shape_count, bool timed) {
+    std::unique_ptr<Shell> shell;
+    {
+      benchmarking::ScopedPauseTiming pause(state, timed);
+      shell = fixture.CreateShell(settings);
+    }
+    auto config = RunConfiguration::InferFromSettings(settings);
+    config.SetEntrypoint("emptyMain");
+    testing::ShellTest::PlatformViewNotifyCreated(shell.get());
+    testing::ShellTest::RunEngine(shell.get(), std::move(config));
+    testing::ShellTest::PumpOneFrame(
+        shell.get(), 400, 400,
+        MakeShapesBuilder(shell->GetTaskRunners().GetIOTaskRunner(),
+                          shape_count));
+    first_frame_latch.Wait();
+    benchmarking::ScopedPauseTiming pause(state, timed);
+    fixture.DestroyShell(std::move(shell));
+  };
+
+  settings.cache_sksl = true;
+  run_until_first_frame(90, false);
+  PersistentCache::ResetCacheForProcess();
+  settings.cache_sksl = false;
+  settings.precompile_sksls_in_background = state.range(0);
+
+  while (state.KeepRunning()) {
+    run_until_first_frame(10, true);
+  }
+
+  PersistentCache::SetPrecompileInBackground(false);
+  PersistentCache::ResetCacheForProcess();
+}
+
+BENCHMARK(BM_ShellTimeToFirstFrame)
+    ->ArgName("in_background")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 }  // namespace flutter
@@ -262,6 +262,12 @@ void ShellTest::OnServiceProtocol(
           case ServiceProtocolEnum::kGetSkSLs:
             shell->OnServiceProtocolGetSkSLs(params, response);
             break;
+          case ServiceProtocolEnum::kGetShaderUsage:
+            shell->OnServiceProtocolGetShaderUsage(params, response);
+            break;
+          case ServiceProtocolEnum::kGetTextLayoutCacheStats:
+            shell->OnServiceProtocolGetTextLayoutCacheStats(params, response);
+            break;
           case ServiceProtocolEnum::kEstimateRasterCacheMemory:
             shell->OnServiceProtocolEstimateRasterCacheMemory(params, response);
             break;
@@ -103,6 +103,8 @@ class ShellTest : public FixtureTest {
 
   enum ServiceProtocolEnum {
     kGetSkSLs,
+    kGetShaderUsage,
+    kGetTextLayoutCacheStats,
     kEstimateRasterCacheMemory,
     kSetAssetBundlePath,
     kRunInView,
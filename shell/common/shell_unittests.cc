@@ -2155,6 +2155,73 @@ TEST_F(ShellTest,
                                 << expected_json1 << " or " << expected_json2;
 }
 
+TEST_F(ShellTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_OnServiceProtocolGetShaderUsageWorks
+#else
+       OnServiceProtocolGetShaderUsageWorks
+#endif  // defined(WINUWP)
+) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  // "IE" is the base32 encoding of "A".
+  const std::string key_str = "A";
+  auto persistent_cache = PersistentCache::GetCacheForProcess();
+  persistent_cache->SetFrameNumber(3);
+  ASSERT_FALSE(persistent_cache->load(
+      *SkData::MakeWithCopy(key_str.data(), key_str.size())));
+
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kGetShaderUsage,
+                    shell->GetTaskRunners().GetIOTaskRunner(), empty_params,
+                    &document);
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  document.Accept(writer);
+  DestroyShell(std::move(shell));
+
+  const std::string expected_json =
+      "{\"type\":\"GetShaderUsage\",\"hits\":0,\"misses\":1,"
+      "\"framesWithMisses\":0,\"compileMicros\":0,\"shaders\":[{\"key\":"
+      "\"IE\",\"firstUseFrame\":3,\"hits\":0,\"misses\":1,"
+      "\"compileMicros\":0}]}";
+  ASSERT_EQ(buffer.GetString(), expected_json);
+}
+
+TEST_F(ShellTest,
+#if defined(WINUWP)
+       // TODO(cbracken): https://github.com/flutter/flutter/issues/90481
+       DISABLED_OnServiceProtocolGetTextLayoutCacheStatsWorks
+#else
+       OnServiceProtocolGetTextLayoutCacheStatsWorks
+#endif  // defined(WINUWP)
+) {
+  Settings settings = CreateSettingsForFixture();
+  settings.text_layout_cache_max_bytes = 12345;
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kGetTextLayoutCacheStats,
+                    shell->GetTaskRunners().GetUITaskRunner(), empty_params,
+                    &document);
+  DestroyShell(std::move(shell));
+
+  ASSERT_TRUE(document.IsObject());
+  ASSERT_STREQ(document["type"].GetString(), "GetTextLayoutCacheStats");
+  for (const char* member : {"hits", "misses", "evictions", "entries"}) {
+    ASSERT_TRUE(document.HasMember(member)) << member;
+  }
+  ASSERT_LE(document["bytes"].GetUint64(), 12345u);
+  ASSERT_EQ(document["capacityBytes"].GetUint64(), 12345u);
+}
+
 TEST_F(ShellTest, RasterizerScreenshot) {
   Settings settings = CreateSettingsForFixture();
   auto configuration = RunConfiguration::InferFromSettings(settings);
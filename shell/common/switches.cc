@@ -446,6 +446,9 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.cache_sksl =
       command_line.HasOption(FlagForSwitch(Switch::CacheSkSL));
 
+  settings.precompile_sksls_in_background = command_line.HasOption(
+      FlagForSwitch(Switch::PrecompileSkSLsInBackground));
+
   settings.purge_persistent_cache =
       command_line.HasOption(FlagForSwitch(Switch::PurgePersistentCache));
 
@@ -455,6 +458,24 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
                                 &old_gen_heap_size);
     settings.old_gen_heap_size = std::stoi(old_gen_heap_size);
   }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::DecodedImageCacheMaxBytes))) {
+    std::string decoded_image_cache_max_bytes;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::DecodedImageCacheMaxBytes),
+        &decoded_image_cache_max_bytes);
+    settings.decoded_image_cache_max_bytes =
+        std::stoull(decoded_image_cache_max_bytes);
+  }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::TextLayoutCacheMaxBytes))) {
+    std::string text_layout_cache_max_bytes;
+    command_line.GetOptionValue(FlagForSwitch(Switch::TextLayoutCacheMaxBytes),
+                                &text_layout_cache_max_bytes);
+    settings.text_layout_cache_max_bytes =
+        std::stoull(text_layout_cache_max_bytes);
+  }
   return settings;
 }
 
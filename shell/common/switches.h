@@ -156,6 +156,13 @@ DEF_SWITCH(CacheSkSL,
            "should only be used during development phases. The generated SkSLs "
            "can later be used in the release build for shader precompilation "
            "at launch in order to eliminate the shader-compile jank.")
+DEF_SWITCH(PrecompileSkSLsInBackground,
+           "precompile-sksls-in-background",
+           "Precompile the SkSLs packaged with the application and gathered "
+           "during previous runs in between frames, in the order in which "
+           "they were first used, instead of before the first frame. Frames "
+           "that need a shader which has not been precompiled yet compile "
+           "just that shader.")
 DEF_SWITCH(PurgePersistentCache,
            "purge-persistent-cache",
            "Remove all existing persistent cache. This is mainly for debugging "
@@ -211,6 +218,16 @@ DEF_SWITCH(
 DEF_SWITCH(OldGenHeapSize,
            "old-gen-heap-size",
            "The size limit in megabytes for the Dart VM old gen heap space.")
+DEF_SWITCH(DecodedImageCacheMaxBytes,
+           "decoded-image-cache-max-bytes",
+           "The maximum number of bytes of decoded images the engine keeps to "
+           "avoid decoding the same image data at the same size again. The "
+           "cache is disabled by default.")
+DEF_SWITCH(TextLayoutCacheMaxBytes,
+           "text-layout-cache-max-bytes",
+           "The maximum number of bytes of shaped words the text layout engine "
+           "keeps to avoid shaping the same words again. Zero disables the "
+           "cache.")
 DEF_SWITCH(EnableSkParagraph,
            "enable-skparagraph",
            "Selects the SkParagraph implementation of the text layout engine.")
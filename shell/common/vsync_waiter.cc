@@ -100,7 +100,7 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
   FML_DCHECK(fml::TimePoint::Now() >= frame_start_time);
 
   Callback callback;
-  std::vector<fml::closure> secondary_callbacks;
+  std::vector<fml::UniqueClosure> secondary_callbacks;
 
   {
     std::scoped_lock lock(callback_mutex_);
@@ -153,10 +153,8 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
         });
   }
 
-  for (auto& secondary_callback : secondary_callbacks) {
-    task_runners_.GetUITaskRunner()->PostTaskForTime(
-        std::move(secondary_callback), frame_start_time);
-  }
+  task_runners_.GetUITaskRunner()->PostTasksForTime(
+      std::move(secondary_callbacks), frame_start_time);
 }
 
 void VsyncWaiter::PauseDartMicroTasks() {
@@ -7,6 +7,7 @@
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/fml/base32.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/message_loop.h"
 #include "flutter/fml/size.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/common/context_options.h"
@@ -56,7 +57,11 @@ sk_sp<GrDirectContext> GPUSurfaceGL::MakeGLContext(
 
   context->setResourceCacheLimits(kGrCacheMaxCount, kGrCacheMaxByteSize);
 
-  PersistentCache::GetCacheForProcess()->PrecompileKnownSkSLs(context.get());
+  // Otherwise, each surface using the context starts precompiling once it can
+  // make the context current.
+  if (!PersistentCache::precompile_in_background()) {
+    PersistentCache::GetCacheForProcess()->PrecompileKnownSkSLs(context.get());
+  }
 
   return context;
 }
@@ -85,6 +90,23 @@ GPUSurfaceGL::GPUSurfaceGL(sk_sp<GrDirectContext> gr_context,
   delegate_->GLContextClearCurrent();
 
   valid_ = gr_context != nullptr;
+
+  if (valid_ && PersistentCache::precompile_in_background()) {
+    PersistentCache::GetCacheForProcess()->PrecompileKnownSkSLsInBackground(
+        context_.get(), fml::MessageLoop::GetCurrent().GetTaskRunner(),
+        [weak = weak_factory_.GetWeakPtr()](
+            const std::function<void(GrDirectContext*)>& compile) {
+          if (!weak) {
+            return false;
+          }
+          auto context_switch = weak->delegate_->GLContextMakeCurrent();
+          if (!context_switch->GetResult()) {
+            return false;
+          }
+          compile(weak->context_.get());
+          return true;
+        });
+  }
 }
 
 GPUSurfaceGL::~GPUSurfaceGL() {
@@ -7,6 +7,7 @@
 
 #include "flutter/flow/surface.h"
 #include "flutter/fml/macros.h"
+#include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/shell/gpu/gpu_surface_metal_delegate.h"
 #include "third_party/skia/include/gpu/GrDirectContext.h"
 #include "third_party/skia/include/gpu/mtl/GrMtlTypes.h"
@@ -63,6 +64,8 @@ class SK_API_AVAILABLE_CA_METAL_LAYER GPUSurfaceMetal : public Surface {
 
   void PrecompileKnownSkSLsIfNecessary();
 
+  // WeakPtrFactory must be the last member.
+  fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceMetal> weak_factory_;
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceMetal);
 };
 
@@ -9,6 +9,7 @@
 
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/message_loop.h"
 #include "flutter/fml/platform/darwin/cf_utils.h"
 #include "flutter/fml/platform/darwin/scoped_nsobject.h"
 #include "flutter/fml/trace_event.h"
@@ -43,7 +44,8 @@ GPUSurfaceMetal::GPUSurfaceMetal(GPUSurfaceMetalDelegate* delegate,
     : delegate_(delegate),
       render_target_type_(delegate->GetRenderTargetType()),
       context_(std::move(context)),
-      render_to_surface_(render_to_surface) {}
+      render_to_surface_(render_to_surface),
+      weak_factory_(this) {}
 
 GPUSurfaceMetal::~GPUSurfaceMetal() = default;
 
@@ -59,6 +61,19 @@ void GPUSurfaceMetal::PrecompileKnownSkSLsIfNecessary() {
     return;
   }
   precompiled_sksl_context_ = current_context;
+  if (flutter::PersistentCache::precompile_in_background()) {
+    flutter::PersistentCache::GetCacheForProcess()->PrecompileKnownSkSLsInBackground(
+        precompiled_sksl_context_, fml::MessageLoop::GetCurrent().GetTaskRunner(),
+        [weak = weak_factory_.GetWeakPtr()](const std::function<void(GrDirectContext*)>& compile) {
+          if (!weak) {
+            return false;
+          }
+          // Metal contexts do not need to be made current.
+          compile(weak->context_.get());
+          return true;
+        });
+    return;
+  }
   flutter::PersistentCache::GetCacheForProcess()->PrecompileKnownSkSLs(precompiled_sksl_context_);
 }
 
@@ -18,11 +18,21 @@ class MockTaskRunner : public fml::TaskRunner {
   inline static RefPtr<MockTaskRunner> Create() {
     return AdoptRef(new MockTaskRunner());
   }
-  MOCK_METHOD1(PostTask, void(const fml::closure& task));
-  MOCK_METHOD2(PostTaskForTime,
-               void(const fml::closure& task, fml::TimePoint target_time));
-  MOCK_METHOD2(PostDelayedTask,
-               void(const fml::closure& task, fml::TimeDelta delay));
+  // gmock can't mock methods taking move-only arguments by value. Forward them
+  // by reference instead.
+  void PostTask(fml::UniqueClosure task) override { PostTaskRef(task); }
+  void PostTaskForTime(fml::UniqueClosure task,
+                       fml::TimePoint target_time) override {
+    PostTaskForTimeRef(task, target_time);
+  }
+  void PostDelayedTask(fml::UniqueClosure task, fml::TimeDelta delay) override {
+    PostDelayedTaskRef(task, delay);
+  }
+  MOCK_METHOD1(PostTaskRef, void(fml::UniqueClosure& task));
+  MOCK_METHOD2(PostTaskForTimeRef,
+               void(fml::UniqueClosure& task, fml::TimePoint target_time));
+  MOCK_METHOD2(PostDelayedTaskRef,
+               void(fml::UniqueClosure& task, fml::TimeDelta delay));
   MOCK_METHOD0(RunsTasksOnCurrentThread, bool());
   MOCK_METHOD0(GetTaskQueueId, TaskQueueId());
 
@@ -42,11 +52,11 @@ TEST(SamplingProfilerTest, DeleteAfterStart) {
 
   // Ignore calls to PostTask since that would require mocking out calls to
   // Dart.
-  EXPECT_CALL(*task_runner, PostDelayedTask(_, _))
+  EXPECT_CALL(*task_runner, PostDelayedTaskRef(_, _))
       .WillRepeatedly(
-          Invoke([&](const fml::closure& task, fml::TimeDelta delay) {
+          Invoke([&](fml::UniqueClosure& task, fml::TimeDelta delay) {
             invoke_count.fetch_add(1);
-            thread->GetTaskRunner()->PostTask(task);
+            thread->GetTaskRunner()->PostTask(std::move(task));
           }));
 
   {
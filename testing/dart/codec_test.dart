@@ -85,6 +85,40 @@ void main() {
       <int>[0, 240, 246],
     ]));
   });
+
+  test('IncrementalImageDecoder decodes a PNG from chunks', () async {
+    const int size = 64;
+    final ui.PictureRecorder recorder = ui.PictureRecorder();
+    ui.Canvas(recorder).drawPaint(ui.Paint()..color = const ui.Color(0xFF00FF00));
+    final ui.Image source = await recorder.endRecording().toImage(size, size);
+    // Without compression, the rows are spread evenly over the bytes.
+    final Uint8List data = (await source.toByteData(
+      format: ui.ImageByteFormat.png,
+      options: const ui.ImageEncodingOptions(compressionLevel: 0, pngFilter: ui.PngFilter.none),
+    ))!.buffer.asUint8List();
+    final Uint8List expected = (await source.toByteData())!.buffer.asUint8List();
+
+    final ui.IncrementalImageDecoder decoder = ui.IncrementalImageDecoder();
+    // The signature alone does not decode any rows.
+    expect(await decoder.addChunk(Uint8List.sublistView(data, 0, 8)), isNull);
+
+    final ui.Image? partial = await decoder.addChunk(Uint8List.sublistView(data, 8, data.length ~/ 2));
+    expect(partial, isNotNull);
+    expect(partial!.width, size);
+    expect(partial.height, size);
+    final Uint8List partialPixels = (await partial.toByteData())!.buffer.asUint8List();
+    // The first rows are decoded, and the last ones are still transparent.
+    expect(partialPixels.sublist(0, 4), expected.sublist(0, 4));
+    expect(partialPixels.sublist(partialPixels.length - 4), <int>[0, 0, 0, 0]);
+
+    final ui.Image? image = await decoder.addChunk(
+      Uint8List.sublistView(data, data.length ~/ 2),
+      isLast: true,
+    );
+    expect(image, isNotNull);
+    expect((await image!.toByteData())!.buffer.asUint8List(), expected);
+    decoder.dispose();
+  });
 }
 
 /// Returns a File handle to a file in the skia/resources directory.
@@ -67,6 +67,67 @@ void main() {
     final List<int> expected = await readFile('square.png');
     expect(Uint8List.view(data.buffer), expected);
   });
+
+  test('Image.toByteData PNG format works with every filter and level', () async {
+    final Image image = await Square4x4Image.image;
+    for (final PngFilter filter in PngFilter.values) {
+      for (final int level in <int>[0, 9]) {
+        final ByteData data = (await image.toByteData(
+          format: ImageByteFormat.png,
+          options: ImageEncodingOptions(compressionLevel: level, pngFilter: filter),
+        ))!;
+        expect(await decodeToRgba(data), Square4x4Image.bytes);
+      }
+    }
+  });
+
+  test('Image.toByteData JPEG format works with simple image', () async {
+    final Image image = await Square4x4Image.image;
+    final ByteData data = (await image.toByteData(format: ImageByteFormat.jpeg))!;
+    final Uint8List bytes = data.buffer.asUint8List();
+    // The SOI and EOI markers.
+    expect(bytes.sublist(0, 2), <int>[0xFF, 0xD8]);
+    expect(bytes.sublist(bytes.length - 2), <int>[0xFF, 0xD9]);
+    final Image decoded = await decodeToImage(data);
+    expect(decoded.width, _kWidth);
+    expect(decoded.height, _kWidth);
+  });
+
+  test('Image.toByteData WebP format is lossless at quality 100', () async {
+    final Image image = await Square4x4Image.image;
+    final ByteData data = (await image.toByteData(
+      format: ImageByteFormat.webp,
+      options: const ImageEncodingOptions(quality: 100),
+    ))!;
+    final Uint8List bytes = data.buffer.asUint8List();
+    expect(String.fromCharCodes(bytes.sublist(0, 4)), 'RIFF');
+    expect(String.fromCharCodes(bytes.sublist(8, 12)), 'WEBP');
+    expect(await decodeToRgba(data), Square4x4Image.bytes);
+  });
+
+  test('ImageEncodingOptions rejects values out of range', () {
+    int value(int v) => v;
+    expectAssertion(() => ImageEncodingOptions(quality: value(-1)));
+    expectAssertion(() => ImageEncodingOptions(quality: value(101)));
+    expectAssertion(() => ImageEncodingOptions(compressionLevel: value(-1)));
+    expectAssertion(() => ImageEncodingOptions(compressionLevel: value(10)));
+    const ImageEncodingOptions options = ImageEncodingOptions();
+    expect(options.quality, 90);
+    expect(options.compressionLevel, 6);
+    expect(options.pngFilter, PngFilter.adaptive);
+  });
+}
+
+Future<Image> decodeToImage(ByteData data) async {
+  final Codec codec = await instantiateImageCodec(data.buffer.asUint8List());
+  final FrameInfo frame = await codec.getNextFrame();
+  return frame.image;
+}
+
+Future<List<int>> decodeToRgba(ByteData data) async {
+  final Image image = await decodeToImage(data);
+  final ByteData rgba = (await image.toByteData())!;
+  return Uint8List.view(rgba.buffer);
 }
 
 class Square4x4Image {
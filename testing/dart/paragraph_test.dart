@@ -206,4 +206,32 @@ void main() {
     expect(line.start, 6);
     expect(line.end, 10);
   });
+
+  test('getPositionForOffset and getWordBoundary', () {
+    const double fontSize = 10.0;
+    final ParagraphBuilder builder = ParagraphBuilder(ParagraphStyle(
+      fontFamily: 'Ahem',
+      fontStyle: FontStyle.normal,
+      fontWeight: FontWeight.normal,
+      fontSize: fontSize,
+    ));
+    builder.addText('Test Ahem');
+    final Paragraph paragraph = builder.build();
+    paragraph.layout(const ParagraphConstraints(width: 400.0));
+
+    // Each glyph of Ahem is a square of the font size.
+    final TextPosition position = paragraph.getPositionForOffset(
+      const Offset(fontSize * 1.2, fontSize / 2),
+    );
+    expect(position.offset, 1);
+    expect(position.affinity, TextAffinity.downstream);
+
+    TextRange word = paragraph.getWordBoundary(const TextPosition(offset: 6));
+    expect(word.start, 5);
+    expect(word.end, 9);
+
+    word = paragraph.getWordBoundary(const TextPosition(offset: 4));
+    expect(word.start, 4);
+    expect(word.end, 5);
+  });
 }
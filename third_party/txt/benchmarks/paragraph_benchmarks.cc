@@ -245,6 +245,49 @@ BENCHMARK_REGISTER_F(ParagraphFixture, StylesBigO)
     ->Range(1 << 3, 1 << 12)
     ->Complexity(benchmark::oN);
 
+// Lays out a paragraph at widths from 200 to 600, as when a window is resized.
+// With an argument of 1, the paragraph is marked dirty before each layout, so
+// the text is measured again instead of only being broken into new lines.
+BENCHMARK_DEFINE_F(ParagraphFixture, ResizeSweep)(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  const bool dirty = state.range(0) != 0;
+  double width = 200;
+  while (state.KeepRunning()) {
+    if (dirty) {
+      paragraph->SetDirty();
+    }
+    paragraph->Layout(width);
+    width = width >= 600 ? 200 : width + 1;
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ResizeSweep)->Arg(0)->Arg(1);
+
 BENCHMARK_F(ParagraphFixture, PaintSimple)(benchmark::State& state) {
   const char* text = "Hello world! This is a simple sentence to test drawing.";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -352,6 +395,40 @@ BENCHMARK_F(ParagraphFixture, PaintDecoration)(benchmark::State& state) {
   }
 }
 
+// Paints code with a style per token, in a few colors, as a syntax highlighter
+// would style it.
+BENCHMARK_F(ParagraphFixture, PaintManyStyles)(benchmark::State& state) {
+  const char* tokens[] = {"for", " ", "(", "int", " ", "i", " ", "=",
+                          " ",   "0", ";", " ", "i", " ", "<", " ",
+                          "n",   ";", " ", "++", "i", ")", " ", "{"};
+  const SkColor colors[] = {SK_ColorBLUE, SK_ColorBLACK, SK_ColorBLACK,
+                            SK_ColorBLUE, SK_ColorBLACK, SK_ColorBLACK};
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+  for (int i = 0; i < 500; ++i) {
+    auto icu_text = icu::UnicodeString::fromUTF8(tokens[i % 24]);
+    std::u16string u16_text(icu_text.getBuffer(),
+                            icu_text.getBuffer() + icu_text.length());
+    text_style.color = colors[i % 6];
+    text_style.font_size = 14 + i % 2;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+  }
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+
+  int offset = 0;
+  while (state.KeepRunning()) {
+    paragraph->Paint(canvas_.get(), offset % 700, 10);
+    offset++;
+  }
+}
+
 // -----------------------------------------------------------------------------
 //
 // The following benchmarks break down the layout function and attempts to time
@@ -426,6 +503,43 @@ BENCHMARK_REGISTER_F(ParagraphFixture, AddStyleRun)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+// Breaks measured text into lines with the break strategy of the first
+// argument, justified if the second argument is 1. The widths of the
+// characters are set directly, so only the line breaking is timed.
+BENCHMARK_DEFINE_F(ParagraphFixture, ComputeBreaks)(benchmark::State& state) {
+  std::vector<uint16_t> text;
+  for (uint16_t i = 0; i < 4096; ++i) {
+    text.push_back(i % 5 == 0 ? ' ' : 'a' + i % 26);
+  }
+  const auto strategy = static_cast<minikin::BreakStrategy>(state.range(0));
+  const bool justified = state.range(1) != 0;
+
+  minikin::LineBreaker breaker;
+  breaker.setLocale();
+  while (state.KeepRunning()) {
+    breaker.setLineWidths(300, 0, 300);
+    breaker.setStrategy(strategy);
+    breaker.setJustified(justified);
+    breaker.resize(text.size());
+    memcpy(breaker.buffer(), text.data(), text.size() * sizeof(text[0]));
+    breaker.setText();
+    float* char_widths = breaker.charWidths();
+    for (size_t i = 0; i < text.size(); ++i) {
+      char_widths[i] = text[i] == ' ' ? 4 : 8;
+    }
+    breaker.addStyleRun(nullptr, nullptr, minikin::FontStyle(), 0, text.size(),
+                        false);
+    benchmark::DoNotOptimize(breaker.computeBreaks());
+    breaker.finish();
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ComputeBreaks)
+    ->Args({minikin::kBreakStrategy_Greedy, 0})
+    ->Args({minikin::kBreakStrategy_Greedy, 1})
+    ->Args({minikin::kBreakStrategy_HighQuality, 0})
+    ->Args({minikin::kBreakStrategy_HighQuality, 1})
+    ->Args({minikin::kBreakStrategy_Balanced, 1});
+
 BENCHMARK_DEFINE_F(ParagraphFixture, SkTextBlobAlloc)(benchmark::State& state) {
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -0,0 +1,191 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/Layout.h"
+#include "third_party/benchmark/include/benchmark/benchmark.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "txt/font_collection.h"
+#include "txt/paragraph_builder_txt.h"
+#include "txt/paragraph_txt.h"
+
+// Variants of the layout benchmarks in paragraph_benchmarks.cc that lay out
+// paragraphs on several threads at once. All threads share one font
+// collection, and with it the caches of minikin, so the time per iteration
+// should stay flat as threads are added if layout scales. The batch benchmarks
+// compare laying out a list of paragraphs in turn with Paragraph::LayoutBatch.
+
+namespace txt {
+
+namespace {
+
+const char* kLongText =
+    "This is a very long sentence to test if the text will properly wrap "
+    "around and go to the next line. Sometimes, short sentence. Longer "
+    "sentences are okay too because they are necessary. Very short. "
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+    "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+    "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+    "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+    "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+    "mollit anim id est laborum.";
+
+std::shared_ptr<FontCollection> GetSharedFontCollection() {
+  static std::shared_ptr<FontCollection> collection = GetTestFontCollection();
+  return collection;
+}
+
+std::unique_ptr<ParagraphTxt> BuildLongParagraph(double font_size) {
+  auto icu_text = icu::UnicodeString::fromUTF8(kLongText);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = font_size;
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetSharedFontCollection());
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  return BuildParagraph(builder);
+}
+
+// Paragraphs of a list of text cells, in several scripts and of several
+// lengths.
+const std::vector<const char*> kMixedScriptTexts = {
+    "Hello World",
+    "This is a very long sentence to test if the text will properly wrap "
+    "around and go to the next line. Sometimes, short sentence.",
+    "مرحبا بالعالم، هذا نص عربي طويل بما يكفي ليلتف على عدة أسطر",
+    "日本語のテキストも同じように複数の行に折り返されます。",
+    "Mixed English, العربية and 日本語 in one paragraph.",
+    "ភាសាខ្មែរ គឺជាភាសាកំណើតរបស់ជនជាតិខ្មែរ",
+};
+
+std::vector<std::unique_ptr<ParagraphTxt>> BuildMixedScriptParagraphs(
+    size_t count) {
+  std::vector<std::unique_ptr<ParagraphTxt>> paragraphs;
+  for (size_t i = 0; i < count; i++) {
+    auto icu_text = icu::UnicodeString::fromUTF8(
+        kMixedScriptTexts[i % kMixedScriptTexts.size()]);
+    std::u16string u16_text(icu_text.getBuffer(),
+                            icu_text.getBuffer() + icu_text.length());
+
+    txt::ParagraphStyle paragraph_style;
+
+    txt::TextStyle text_style;
+    text_style.font_families = {"Roboto", "Noto Naskh Arabic",
+                                "Noto Sans CJK JP", "Noto Sans Khmer"};
+    text_style.font_size = 12 + i % 5;
+    text_style.color = SK_ColorBLACK;
+
+    txt::ParagraphBuilderTxt builder(paragraph_style,
+                                     GetSharedFontCollection());
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    paragraphs.push_back(BuildParagraph(builder));
+  }
+  return paragraphs;
+}
+
+}  // namespace
+
+// All threads lay out the same text, so they mostly read the same entries of
+// the layout cache.
+static void BM_ParagraphSharedLayoutOnThreads(benchmark::State& state) {
+  auto paragraph = BuildLongParagraph(14);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK(BM_ParagraphSharedLayoutOnThreads)->ThreadRange(1, 8)->UseRealTime();
+
+// Each thread uses a font size of its own, so the threads shape their words
+// separately and add different entries to the caches.
+static void BM_ParagraphDistinctLayoutOnThreads(benchmark::State& state) {
+  static std::atomic<int> next_font_size(10);
+  auto paragraph = BuildLongParagraph(next_font_size++);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK(BM_ParagraphDistinctLayoutOnThreads)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Shapes text without the line breaking of a paragraph, on every thread.
+static void BM_MinikinDoLayoutOnThreads(benchmark::State& state) {
+  std::vector<uint16_t> text;
+  for (uint16_t i = 0; i < 4096; ++i) {
+    text.push_back(i % 5 == 0 ? ' ' : 'a' + i % 26);
+  }
+  minikin::FontStyle font(4, false);
+  minikin::MinikinPaint paint;
+  paint.size = 14;
+
+  auto collection = GetSharedFontCollection()
+                        ->GetMinikinFontCollectionForFamilies(
+                            std::vector<std::string>(1, "Roboto"), "en-US");
+
+  while (state.KeepRunning()) {
+    minikin::Layout layout;
+    layout.doLayout(text.data(), 0, text.size(), text.size(), false, font,
+                    paint, collection);
+  }
+}
+BENCHMARK(BM_MinikinDoLayoutOnThreads)->ThreadRange(1, 8)->UseRealTime();
+
+// Lays out 200 paragraphs one after the other, as the framework does for the
+// cells of a list.
+static void BM_ParagraphLayoutSequential(benchmark::State& state) {
+  auto paragraphs = BuildMixedScriptParagraphs(200);
+  while (state.KeepRunning()) {
+    for (auto& paragraph : paragraphs) {
+      paragraph->SetDirty();
+      paragraph->Layout(300);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * paragraphs.size());
+}
+BENCHMARK(BM_ParagraphLayoutSequential)->UseRealTime();
+
+// Lays out the same 200 paragraphs with Paragraph::LayoutBatch, on as many
+// workers as the argument.
+static void BM_ParagraphLayoutBatch(benchmark::State& state) {
+  auto paragraphs = BuildMixedScriptParagraphs(200);
+  std::vector<Paragraph*> batch;
+  for (auto& paragraph : paragraphs) {
+    batch.push_back(paragraph.get());
+  }
+  const std::vector<double> widths(batch.size(), 300);
+  auto loop = fml::ConcurrentMessageLoop::Create(state.range(0));
+  while (state.KeepRunning()) {
+    for (auto& paragraph : paragraphs) {
+      paragraph->SetDirty();
+    }
+    Paragraph::LayoutBatch(batch, widths, loop->GetTaskRunner());
+  }
+  loop->Terminate();
+  state.SetItemsProcessed(state.iterations() * paragraphs.size());
+}
+BENCHMARK(BM_ParagraphLayoutBatch)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+}  // namespace txt
@@ -22,6 +22,8 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -99,6 +101,11 @@ class LayoutCacheKey {
     mChars = NULL;
   }
 
+  // The cached key holds a copy of the whole text, not just of the word.
+  size_t getMemoryUsage() const {
+    return sizeof(LayoutCacheKey) + mNchars * sizeof(uint16_t);
+  }
+
   void doLayout(Layout* layout,
                 LayoutContext* ctx,
                 const std::shared_ptr<FontCollection>& collection) const {
@@ -129,56 +136,125 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+class LayoutCache
+    : private android::OnEntryRemoved<LayoutCacheKey, std::shared_ptr<Layout>> {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
+  LayoutCache()
+      : mCache(android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>>::
+                   kUnlimitedCapacity) {
     mCache.setOnEntryRemovedListener(this);
   }
 
-  void clear() { mCache.clear(); }
-
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+  void clear() {
+    std::scoped_lock lock(mMutex);
+    mCache.clear();
+  }
+
+  void setCapacity(size_t bytes) {
+    std::scoped_lock lock(mMutex);
+    mCapacity = bytes;
+    evictLocked();
+  }
+
+  LayoutCacheStats getStats() {
+    std::scoped_lock lock(mMutex);
+    return {
+        .hitCount = mHitCount,
+        .missCount = mMissCount,
+        .evictionCount = mEvictionCount,
+        .entryCount = mCache.size(),
+        .sizeBytes = mSize,
+        .capacityBytes = mCapacity,
+    };
+  }
+
+  // The returned layout stays valid after it is evicted from the cache.
+  std::shared_ptr<Layout> get(
+      LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    {
+      std::scoped_lock lock(mMutex);
+      std::shared_ptr<Layout> layout = mCache.get(key);
+      if (layout) {
+        mHitCount++;
+        return layout;
+      }
+      mMissCount++;
+    }
+
+    // Shape the text without holding the lock, so that other threads can use
+    // the cache in the meantime.
+    auto layout = std::make_shared<Layout>();
+    key.doLayout(layout.get(), ctx, collection);
+
+    std::scoped_lock lock(mMutex);
+    // An entry larger than the whole cache would evict all of the others and
+    // then itself. Each entry is charged for all of the text of its paragraph.
+    const size_t entry_size = key.getMemoryUsage() + layout->getMemoryUsage();
+    if (entry_size > mCapacity) {
+      return layout;
     }
+    // Another thread may have cached the same text first.
+    std::shared_ptr<Layout> cached = mCache.get(key);
+    if (cached) {
+      return cached;
+    }
+    key.copyText();
+    mCache.put(key, layout);
+    mSize += entry_size;
+    evictLocked();
     return layout;
   }
 
  private:
   // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
+  void operator()(LayoutCacheKey& key, std::shared_ptr<Layout>& value) {
+    mSize -= key.getMemoryUsage() + value->getMemoryUsage();
     key.freeText();
-    delete value;
+    value.reset();
   }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
-
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+  void evictLocked() {
+    while (mSize > mCapacity && mCache.removeOldest()) {
+      mEvictionCount++;
+    }
+  }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+  std::mutex mMutex;
+  android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>> mCache;
+  size_t mCapacity = kDefaultCapacity;
+  size_t mSize = 0;
+  uint64_t mHitCount = 0;
+  uint64_t mMissCount = 0;
+  uint64_t mEvictionCount = 0;
+
+  // Roughly the size of the 5000 entries that used to be the limit, for words
+  // in paragraphs of a few hundred characters.
+  static const size_t kDefaultCapacity = 4 * 1024 * 1024;
 };
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
+    hb_unicode_funcs_make_immutable(unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
+  // Each thread shapes text in a buffer of its own.
+  hb_buffer_t* getHbBuffer() {
+    thread_local std::unique_ptr<hb_buffer_t, decltype(&hb_buffer_destroy)>
+        buffer(nullptr, &hb_buffer_destroy);
+    if (!buffer) {
+      buffer.reset(hb_buffer_create());
+      hb_buffer_set_unicode_funcs(buffer.get(), unicodeFunctions);
+    }
+    return buffer.get();
+  }
+
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
@@ -254,34 +330,31 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(true);
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(false);
+  return forColorBitmapFont ? hbFuncsForColorBitmap : hbFuncs;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -316,7 +389,11 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    // The cached font is shared between threads, so the paint and the scale
+    // of this layout are set on a sub font of it instead.
+    hb_font_t* parent = getHbFont(face.font);
+    hb_font_t* font = hb_font_create_sub_font(parent);
+    hb_font_destroy(parent);
     hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
                       &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
@@ -325,10 +402,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +662,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -612,8 +684,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -720,9 +790,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<Layout> layoutForWord = cache.get(key, ctx, collection);
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -748,7 +818,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,7 +989,7 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getInstance().getHbBuffer();
   std::vector<FontCollection::Run> items;
   collection->itemize(buf + start, count, ctx->style, &items);
 
@@ -1192,11 +1262,24 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
 void Layout::purgeCaches() {
-  std::scoped_lock _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
   layoutCache.clear();
-  purgeHbFontCacheLocked();
+  purgeHbFontCache();
+}
+
+void Layout::setCacheCapacity(size_t bytes) {
+  LayoutEngine::getInstance().layoutCache.setCapacity(bytes);
+}
+
+LayoutCacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
 }
 
 }  // namespace minikin
@@ -57,6 +57,16 @@ enum {
   kBidi_Mask = 0x7
 };
 
+// libtxt extension: counters of the cache of word layouts
+struct LayoutCacheStats {
+  uint64_t hitCount;
+  uint64_t missCount;
+  uint64_t evictionCount;
+  size_t entryCount;
+  size_t sizeBytes;
+  size_t capacityBytes;
+};
+
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
 // may not mutate it at the same time.
@@ -114,9 +124,21 @@ class Layout {
 
   void getBounds(MinikinRect* rect) const;
 
+  // libtxt extension: the number of bytes used by this layout
+  size_t getMemoryUsage() const;
+
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // libtxt extension: sets the maximum number of bytes of word layouts, and of
+  // the text they were shaped in, that are cached. Evicts the least recently
+  // used words if the cache is larger. Words whose layout and text alone are
+  // larger are not cached. Zero disables the cache.
+  static void setCacheCapacity(size_t bytes);
+
+  // libtxt extension
+  static LayoutCacheStats getCacheStats();
+
  private:
   friend class LayoutCacheKey;
 
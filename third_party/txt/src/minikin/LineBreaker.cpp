@@ -128,13 +128,24 @@ float LineBreaker::addStyleRun(MinikinPaint* paint,
                                size_t end,
                                bool isRtl) {
   float width = 0.0f;
-
-  float hyphenPenalty = 0.0;
   if (paint != nullptr) {
     width = Layout::measureText(mTextBuf.data(), start, end - start,
                                 mTextBuf.size(), isRtl, style, *paint, typeface,
                                 mCharWidths.data() + start);
+  }
+  addMeasuredStyleRun(paint, typeface, style, start, end, isRtl);
+  return width;
+}
 
+void LineBreaker::addMeasuredStyleRun(
+    MinikinPaint* paint,
+    const std::shared_ptr<FontCollection>& typeface,
+    FontStyle style,
+    size_t start,
+    size_t end,
+    bool isRtl) {
+  float hyphenPenalty = 0.0;
+  if (paint != nullptr) {
     // a heuristic that seems to perform well
     hyphenPenalty =
         0.5 * paint->size * paint->scaleX * mLineWidths.getLineWidth(0);
@@ -228,8 +239,6 @@ float LineBreaker::addStyleRun(MinikinPaint* paint,
       current = (size_t)mWordBreaker.next();
     }
   }
-
-  return width;
 }
 
 // add a word break (possibly for a hyphenated fragment), and add desperate
@@ -519,11 +528,114 @@ void LineBreaker::computeBreaksOptimal(bool isRectangle) {
   finishBreaksOptimal();
 }
 
+// Same as computeBreaksOptimal(true), in two passes per candidate. The first
+// pass computes the width score of the line from every candidate in the
+// window [active, i) to candidate i. It has no branches and reads contiguous
+// arrays, so the compiler can vectorize it. The second pass finds the best
+// previous break, visiting and pruning candidates exactly as
+// computeBreaksOptimal does, so both find the same breaks.
+void LineBreaker::computeBreaksOptimalRectangle() {
+  const size_t nCand = mCandidates.size();
+  const float width = mLineWidths.getLineWidth(0);
+  const float shortLineFactor = mJustified ? 0.75f : 0.5f;
+  const float maxShrink = mJustified ? SHRINKABILITY * getSpaceWidth() : 0.0f;
+  const bool penalizeLastLine = mStrategy != kBreakStrategy_Balanced;
+
+  mOptimalPreBreaks.resize(nCand);
+  mOptimalPreSpaceCounts.resize(nCand);
+  mOptimalPenalties.resize(nCand);
+  mOptimalScores.resize(nCand);
+  mOptimalWidthScores.resize(nCand);
+  for (size_t i = 0; i < nCand; i++) {
+    mOptimalPreBreaks[i] = mCandidates[i].preBreak;
+    mOptimalPreSpaceCounts[i] = mCandidates[i].preSpaceCount;
+    mOptimalPenalties[i] = mCandidates[i].penalty;
+  }
+  mOptimalScores[0] = mCandidates[0].score;
+  const ParaWidth* preBreaks = mOptimalPreBreaks.data();
+  const float* preSpaceCounts = mOptimalPreSpaceCounts.data();
+  const float* penalties = mOptimalPenalties.data();
+  float* scores = mOptimalScores.data();
+  float* widthScores = mOptimalWidthScores.data();
+
+  size_t active = 0;
+  // "i" iterates through candidates for the end of the line.
+  for (size_t i = 1; i < nCand; i++) {
+    const bool atEnd = i == nCand - 1;
+    const ParaWidth leftEdge = mCandidates[i].postBreak - width;
+    const size_t start = active;
+
+    if (!atEnd) {
+      const float postSpaceCount = mCandidates[i].postSpaceCount;
+      for (size_t j = start; j < i; j++) {
+        const float delta = preBreaks[j] - leftEdge;
+        const float squared = delta * delta;
+        // The line can only shrink if the text is justified, since maxShrink
+        // is zero otherwise.
+        const bool canShrink =
+            -delta < maxShrink * (postSpaceCount - preSpaceCounts[j]);
+        const float shrunk =
+            canShrink ? squared * SHRINK_PENALTY_MULTIPLIER : SCORE_OVERFULL;
+        widthScores[j] = delta < 0 ? shrunk : squared;
+      }
+    } else if (penalizeLastLine) {
+      for (size_t j = start; j < i; j++) {
+        const float delta = preBreaks[j] - leftEdge;
+        // Penalize very short (< 1 - shortLineFactor of total width) lines.
+        const float underfill = delta - shortLineFactor * width;
+        const float underfillScore = underfill > 0 ? underfill * underfill : 0;
+        widthScores[j] = delta < 0 ? SCORE_OVERFULL : underfillScore;
+      }
+    } else {
+      for (size_t j = start; j < i; j++) {
+        const float delta = preBreaks[j] - leftEdge;
+        widthScores[j] = delta < 0 ? SCORE_OVERFULL : delta * delta;
+      }
+    }
+
+    float best = SCORE_INFTY;
+    size_t bestPrev = 0;
+    float bestHope = 0;
+    // "j" iterates through candidates for the beginning of the line.
+    for (size_t j = start; j < i; j++) {
+      const float jScore = scores[j];
+      if (jScore + bestHope >= best)
+        continue;
+      const float delta = preBreaks[j] - leftEdge;
+      const float widthScore = widthScores[j];
+      // increase penalty for hyphen on last line
+      const float additionalPenalty =
+          atEnd && penalizeLastLine && delta >= 0
+              ? LAST_LINE_PENALTY_MULTIPLIER * penalties[j]
+              : 0.0f;
+
+      if (delta < 0) {
+        active = j + 1;
+      } else {
+        bestHope = widthScore;
+      }
+
+      const float score = jScore + widthScore + additionalPenalty;
+      if (score <= best) {
+        best = score;
+        bestPrev = j;
+      }
+    }
+    scores[i] = best + penalties[i] + mLinePenalty;
+    mCandidates[i].score = scores[i];
+    mCandidates[i].prev = bestPrev;
+    mCandidates[i].lineNumber = mCandidates[bestPrev].lineNumber + 1;
+  }
+  finishBreaksOptimal();
+}
+
 size_t LineBreaker::computeBreaks() {
   if (mStrategy == kBreakStrategy_Greedy) {
     computeBreaksGreedy();
+  } else if (mLineWidths.isConstant()) {
+    computeBreaksOptimalRectangle();
   } else {
-    computeBreaksOptimal(mLineWidths.isConstant());
+    computeBreaksOptimal(false);
   }
   return mBreaks.size();
 }
@@ -547,6 +659,16 @@ void LineBreaker::finish() {
     mBreaks.shrink_to_fit();
     mWidths.shrink_to_fit();
     mFlags.shrink_to_fit();
+    mOptimalPreBreaks.clear();
+    mOptimalPreBreaks.shrink_to_fit();
+    mOptimalPreSpaceCounts.clear();
+    mOptimalPreSpaceCounts.shrink_to_fit();
+    mOptimalPenalties.clear();
+    mOptimalPenalties.shrink_to_fit();
+    mOptimalScores.clear();
+    mOptimalScores.shrink_to_fit();
+    mOptimalWidthScores.clear();
+    mOptimalWidthScores.shrink_to_fit();
   }
   mStrategy = kBreakStrategy_Greedy;
   mHyphenationFrequency = kHyphenationFrequency_Normal;
@@ -148,6 +148,17 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt extension: like addStyleRun, but does not measure the text. The
+  // caller must already have stored the widths of the characters in the run
+  // in charWidths(), for example from an earlier addStyleRun call with the
+  // same text and paint. Used to break the text again at another width.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -213,6 +224,10 @@ class LineBreaker {
 
   void computeBreaksOptimal(bool isRectangular);
 
+  // libtxt extension: computeBreaksOptimal for lines of a single width, which
+  // is all libtxt uses. Finds the same breaks with faster inner loops.
+  void computeBreaksOptimalRectangle();
+
   void finishBreaksOptimal();
 
   WordBreaker mWordBreaker;
@@ -247,6 +262,15 @@ class LineBreaker {
   uint32_t mLastHyphenation;  // hyphen edit of last break kept for next line
   int mFirstTabIndex;
   size_t mSpaceCount;
+
+  // libtxt extension: the fields of the candidates that are read by the inner
+  // loop of computeBreaksOptimalRectangle, stored contiguously so that the
+  // loop can be vectorized. Kept between paragraphs to avoid allocations.
+  std::vector<ParaWidth> mOptimalPreBreaks;
+  std::vector<float> mOptimalPreSpaceCounts;
+  std::vector<float> mOptimalPenalties;
+  std::vector<float> mOptimalScores;
+  std::vector<float> mOptimalWidthScores;
 };
 
 }  // namespace minikin
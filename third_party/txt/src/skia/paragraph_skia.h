@@ -54,6 +54,9 @@ class ParagraphSkia : public Paragraph {
 
   void Paint(SkCanvas* canvas, double x, double y) override;
 
+  // SkParagraph can only paint into an SkCanvas.
+  using Paragraph::Paint;
+
   std::vector<TextBox> GetRectsForRange(
       size_t start,
       size_t end,
@@ -37,6 +37,15 @@ namespace {
 
 const std::shared_ptr<minikin::FontFamily> g_null_family;
 
+// The FNV-1a hash of |size| bytes, continuing from |hash|.
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
 }  // anonymous namespace
 
 FontCollection::FamilyKey::FamilyKey(const std::vector<std::string>& families,
@@ -100,10 +109,12 @@ size_t FontCollection::GetFontManagersCount() const {
 void FontCollection::SetupDefaultFontManager(
     uint32_t font_initialization_data) {
   default_font_manager_ = GetDefaultFontManager(font_initialization_data);
+  fallback_fonts_fingerprint_.reset();
 }
 
 void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
   default_font_manager_ = font_manager;
+  fallback_fonts_fingerprint_.reset();
 
 #if FLUTTER_ENABLE_SKSHAPER
   skt_collection_.reset();
@@ -112,6 +123,7 @@ void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
 
 void FontCollection::SetAssetFontManager(sk_sp<SkFontMgr> font_manager) {
   asset_font_manager_ = font_manager;
+  fallback_fonts_fingerprint_.reset();
 
 #if FLUTTER_ENABLE_SKSHAPER
   skt_collection_.reset();
@@ -128,6 +140,7 @@ void FontCollection::SetDynamicFontManager(sk_sp<SkFontMgr> font_manager) {
 
 void FontCollection::SetTestFontManager(sk_sp<SkFontMgr> font_manager) {
   test_font_manager_ = font_manager;
+  fallback_fonts_fingerprint_.reset();
 
 #if FLUTTER_ENABLE_SKSHAPER
   skt_collection_.reset();
@@ -162,6 +175,7 @@ std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamilies(
     const std::vector<std::string>& font_families,
     const std::string& locale) {
+  std::scoped_lock lock(cache_mutex_);
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
   auto cached = font_collections_cache_.find(family_key);
@@ -318,6 +332,7 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  std::scoped_lock lock(cache_mutex_);
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
@@ -325,12 +340,42 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
   if (lookup != fallback_match_cache_.end()) {
     return *lookup->second;
   }
+  if (fallback_index_.fingerprint() != GetFallbackFontsFingerprint()) {
+    fallback_index_.Reset(GetFallbackFontsFingerprint());
+  }
   const std::shared_ptr<minikin::FontFamily>* match =
-      &DoMatchFallbackFont(ch, locale);
+      &MatchIndexedFallbackFont(ch, locale);
+  if (!*match) {
+    match = &DoMatchFallbackFont(ch, locale);
+  }
   fallback_match_cache_.insert(std::make_pair(ch, match));
   return *match;
 }
 
+const std::shared_ptr<minikin::FontFamily>&
+FontCollection::MatchIndexedFallbackFont(uint32_t ch,
+                                         const std::string& locale) {
+  const FontFallbackIndex::Family* indexed = fallback_index_.Find(ch);
+  if (!indexed) {
+    return g_null_family;
+  }
+  std::vector<sk_sp<SkFontMgr>> managers = GetFallbackIndexManagers();
+  if (indexed->manager < managers.size() && managers[indexed->manager]) {
+    const std::string family_name = indexed->name;
+    const std::shared_ptr<minikin::FontFamily>& family =
+        GetFallbackFontFamily(managers[indexed->manager], family_name);
+    if (family && family->getCoverage().get(ch)) {
+      AddFallbackFontForLocale(locale, family_name);
+      return family;
+    }
+  }
+  // The fonts changed without changing the fingerprint, so none of the
+  // indexed matches can be trusted.
+  FML_DLOG(WARNING) << "Dropping the outdated font fallback index.";
+  fallback_index_.Reset(GetFallbackFontsFingerprint());
+  return g_null_family;
+}
+
 const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
     uint32_t ch,
     std::string locale) {
@@ -347,16 +392,72 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
     typeface->getFamilyName(&sk_family_name);
     std::string family_name(sk_family_name.c_str());
 
-    if (std::find(fallback_fonts_for_locale_[locale].begin(),
-                  fallback_fonts_for_locale_[locale].end(),
-                  family_name) == fallback_fonts_for_locale_[locale].end())
-      fallback_fonts_for_locale_[locale].push_back(family_name);
+    AddFallbackFontForLocale(locale, family_name);
 
-    return GetFallbackFontFamily(manager, family_name);
+    const std::shared_ptr<minikin::FontFamily>& family =
+        GetFallbackFontFamily(manager, family_name);
+    std::vector<sk_sp<SkFontMgr>> managers = GetFallbackIndexManagers();
+    auto indexed_manager = std::find(managers.begin(), managers.end(), manager);
+    if (family && indexed_manager != managers.end()) {
+      fallback_index_.Add(
+          ch, family_name,
+          static_cast<uint32_t>(indexed_manager - managers.begin()));
+    }
+    return family;
   }
   return g_null_family;
 }
 
+void FontCollection::AddFallbackFontForLocale(const std::string& locale,
+                                              const std::string& family_name) {
+  std::vector<std::string>& families = fallback_fonts_for_locale_[locale];
+  if (std::find(families.begin(), families.end(), family_name) ==
+      families.end())
+    families.push_back(family_name);
+}
+
+std::vector<sk_sp<SkFontMgr>> FontCollection::GetFallbackIndexManagers()
+    const {
+  // New managers are added at the end, so that existing indexes remain valid.
+  return {asset_font_manager_, test_font_manager_, default_font_manager_};
+}
+
+uint64_t FontCollection::GetFallbackFontsFingerprint() {
+  if (fallback_fonts_fingerprint_) {
+    return *fallback_fonts_fingerprint_;
+  }
+  TRACE_EVENT0("flutter", "FontCollection::GetFallbackFontsFingerprint");
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const sk_sp<SkFontMgr>& manager : GetFallbackIndexManagers()) {
+    const int family_count = manager ? manager->countFamilies() : -1;
+    hash = HashBytes(hash, &family_count, sizeof(family_count));
+    for (int i = 0; i < family_count; i++) {
+      SkString family_name;
+      manager->getFamilyName(i, &family_name);
+      // Includes the terminating null, which separates the names.
+      hash = HashBytes(hash, family_name.c_str(), family_name.size() + 1);
+    }
+  }
+  fallback_fonts_fingerprint_ = hash;
+  return hash;
+}
+
+void FontCollection::LoadFallbackIndex(std::unique_ptr<fml::Mapping> mapping) {
+  std::scoped_lock lock(cache_mutex_);
+  // The fingerprint lists the families of the system fonts, so the index is
+  // only checked against it by the first MatchFallbackFont, rather than while
+  // the app starts.
+  fallback_index_.Load(std::move(mapping));
+}
+
+std::unique_ptr<fml::Mapping> FontCollection::SerializeFallbackIndex() {
+  std::scoped_lock lock(cache_mutex_);
+  if (!fallback_index_.HasChanges()) {
+    return nullptr;
+  }
+  return fallback_index_.Serialize();
+}
+
 const std::shared_ptr<minikin::FontFamily>&
 FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
                                       const std::string& family_name) {
@@ -382,7 +483,10 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 }
 
 void FontCollection::ClearFontFamilyCache() {
-  font_collections_cache_.clear();
+  {
+    std::scoped_lock lock(cache_mutex_);
+    font_collections_cache_.clear();
+  }
 
 #if FLUTTER_ENABLE_SKSHAPER
   if (skt_collection_) {
@@ -391,6 +495,14 @@ void FontCollection::ClearFontFamilyCache() {
 #endif
 }
 
+void FontCollection::SetLayoutCacheCapacity(size_t bytes) {
+  minikin::Layout::setCacheCapacity(bytes);
+}
+
+minikin::LayoutCacheStats FontCollection::GetLayoutCacheStats() {
+  return minikin::Layout::getCacheStats();
+}
+
 #if FLUTTER_ENABLE_SKSHAPER
 
 sk_sp<skia::textlayout::FontCollection>
@@ -18,17 +18,22 @@
 #define LIB_TXT_SRC_FONT_COLLECTION_H_
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
 
 #include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
 #include "minikin/FontCollection.h"
 #include "minikin/FontFamily.h"
+#include "minikin/Layout.h"
 #include "third_party/googletest/googletest/include/gtest/gtest_prod.h"  // nogncheck
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "txt/asset_font_manager.h"
+#include "txt/font_fallback_index.h"
 #include "txt/text_style.h"
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -68,6 +73,22 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   // Remove all entries in the font family cache.
   void ClearFontFamilyCache();
 
+  // Uses the fallback fonts matched in an earlier run, as serialized by
+  // SerializeFallbackIndex, instead of asking the font managers for them
+  // again. The first fallback match drops the index if the fonts of the font
+  // managers differ from those it was built from.
+  void LoadFallbackIndex(std::unique_ptr<fml::Mapping> mapping);
+
+  // Serializes the fallback fonts matched so far, or returns null if none were
+  // matched since the index was loaded or last serialized.
+  std::unique_ptr<fml::Mapping> SerializeFallbackIndex();
+
+  // Sets the maximum number of bytes of the cache of shaped words. The cache
+  // is shared by all font collections in the process. Zero disables it.
+  static void SetLayoutCacheCapacity(size_t bytes);
+
+  static minikin::LayoutCacheStats GetLayoutCacheStats();
+
 #if FLUTTER_ENABLE_SKSHAPER
 
   // Construct a Skia text layout FontCollection based on this collection.
@@ -94,6 +115,9 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> dynamic_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
+  // Guards the caches below, as paragraphs may be laid out on several threads
+  // at once.
+  std::mutex cache_mutex_;
   std::unordered_map<FamilyKey,
                      std::shared_ptr<minikin::FontCollection>,
                      FamilyKey::Hasher>
@@ -106,6 +130,13 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       fallback_fonts_;
   std::unordered_map<std::string, std::vector<std::string>>
       fallback_fonts_for_locale_;
+  // The fallback fonts matched in this and earlier runs. Unlike
+  // fallback_match_cache_, it leaves out the fonts of the dynamic font
+  // manager, which are only loaded once the app runs.
+  FontFallbackIndex fallback_index_;
+  // A fingerprint of the families of the font managers in fallback_index_,
+  // computed when first needed.
+  std::optional<uint64_t> fallback_fonts_fingerprint_;
   bool enable_font_fallback_;
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -119,6 +150,21 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       uint32_t ch,
       std::string locale);
 
+  // Looks up ch in fallback_index_. Returns the null family, and resets the
+  // index, if the indexed family does not cover ch.
+  const std::shared_ptr<minikin::FontFamily>& MatchIndexedFallbackFont(
+      uint32_t ch,
+      const std::string& locale);
+
+  void AddFallbackFontForLocale(const std::string& locale,
+                                const std::string& family_name);
+
+  // The font managers whose matches are kept in fallback_index_, identified
+  // by their position in this list.
+  std::vector<sk_sp<SkFontMgr>> GetFallbackIndexManagers() const;
+
+  uint64_t GetFallbackFontsFingerprint();
+
   std::vector<sk_sp<SkFontMgr>> GetFontManagerOrder() const;
 
   std::shared_ptr<minikin::FontFamily> FindFontFamilyInManagers(
@@ -0,0 +1,214 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "txt/font_fallback_index.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+namespace {
+
+constexpr uint32_t kSignature = 0x58494646;  // "FFIX"
+constexpr uint32_t kVersion1 = 1;
+
+struct Header {
+  uint32_t signature;
+  uint32_t version;
+  uint64_t fingerprint;
+  uint32_t family_count;
+  uint32_t range_count;
+};
+
+struct FamilyHeader {
+  uint32_t manager;
+  uint32_t name_size;
+};
+
+}  // namespace
+
+FontFallbackIndex::FontFallbackIndex() = default;
+
+FontFallbackIndex::~FontFallbackIndex() = default;
+
+bool FontFallbackIndex::Load(std::unique_ptr<fml::Mapping> mapping) {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Load");
+  // The ranges are read in place, right after the header.
+  static_assert(sizeof(Header) % alignof(Range) == 0);
+
+  if (!mapping || mapping->GetSize() < sizeof(Header)) {
+    return false;
+  }
+  const uint8_t* bytes = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+
+  Header header;
+  memcpy(&header, bytes, sizeof(Header));
+  if (header.signature != kSignature || header.version != kVersion1) {
+    return false;
+  }
+  const uint64_t ranges_size =
+      static_cast<uint64_t>(header.range_count) * sizeof(Range);
+  if (ranges_size > size - sizeof(Header)) {
+    return false;
+  }
+
+  std::vector<Family> families;
+  size_t offset = sizeof(Header) + ranges_size;
+  for (uint32_t i = 0; i < header.family_count; i++) {
+    FamilyHeader family;
+    if (size - offset < sizeof(FamilyHeader)) {
+      return false;
+    }
+    memcpy(&family, bytes + offset, sizeof(FamilyHeader));
+    offset += sizeof(FamilyHeader);
+    if (size - offset < family.name_size) {
+      return false;
+    }
+    families.push_back({
+        .name = std::string(reinterpret_cast<const char*>(bytes + offset),
+                            family.name_size),
+        .manager = family.manager,
+    });
+    offset += family.name_size;
+  }
+
+  const Range* ranges = reinterpret_cast<const Range*>(bytes + sizeof(Header));
+  for (uint32_t i = 0; i < header.range_count; i++) {
+    if (ranges[i].start >= ranges[i].end ||
+        ranges[i].family >= families.size() ||
+        (i > 0 && ranges[i - 1].end > ranges[i].start)) {
+      return false;
+    }
+  }
+
+  fingerprint_ = header.fingerprint;
+  families_ = std::move(families);
+  mapping_ = std::move(mapping);
+  ranges_ = ranges;
+  range_count_ = header.range_count;
+  learned_.clear();
+  has_changes_ = false;
+  return true;
+}
+
+void FontFallbackIndex::Reset(uint64_t fingerprint) {
+  fingerprint_ = fingerprint;
+  families_.clear();
+  mapping_ = nullptr;
+  ranges_ = nullptr;
+  range_count_ = 0;
+  learned_.clear();
+  has_changes_ = false;
+}
+
+const FontFallbackIndex::Family* FontFallbackIndex::Find(uint32_t ch) const {
+  const Range* range = FindRange(ch);
+  if (range) {
+    return &families_[range->family];
+  }
+  auto found = learned_.find(ch);
+  if (found != learned_.end()) {
+    return &families_[found->second];
+  }
+  return nullptr;
+}
+
+void FontFallbackIndex::Add(uint32_t ch,
+                            const std::string& name,
+                            uint32_t manager) {
+  FML_DCHECK(Find(ch) == nullptr);
+  learned_[ch] = GetFamilyIndex(name, manager);
+  has_changes_ = true;
+}
+
+std::unique_ptr<fml::Mapping> FontFallbackIndex::Serialize() {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Serialize");
+  // Merges the loaded ranges with the added code points. They do not overlap,
+  // as code points are only added when they have no match.
+  std::vector<Range> ranges;
+  auto append = [&ranges](uint32_t start, uint32_t end, uint32_t family) {
+    if (!ranges.empty() && ranges.back().end == start &&
+        ranges.back().family == family) {
+      ranges.back().end = end;
+    } else {
+      ranges.push_back({.start = start, .end = end, .family = family});
+    }
+  };
+  size_t range_index = 0;
+  auto learned = learned_.begin();
+  while (range_index < range_count_ || learned != learned_.end()) {
+    if (learned == learned_.end() ||
+        (range_index < range_count_ &&
+         ranges_[range_index].start < learned->first)) {
+      const Range& range = ranges_[range_index++];
+      append(range.start, range.end, range.family);
+    } else {
+      append(learned->first, learned->first + 1, learned->second);
+      ++learned;
+    }
+  }
+
+  size_t size = sizeof(Header) + ranges.size() * sizeof(Range);
+  for (const Family& family : families_) {
+    size += sizeof(FamilyHeader) + family.name.size();
+  }
+  std::vector<uint8_t> bytes(size);
+
+  const Header header = {
+      .signature = kSignature,
+      .version = kVersion1,
+      .fingerprint = fingerprint_,
+      .family_count = static_cast<uint32_t>(families_.size()),
+      .range_count = static_cast<uint32_t>(ranges.size()),
+  };
+  memcpy(bytes.data(), &header, sizeof(Header));
+  size_t offset = sizeof(Header);
+  memcpy(bytes.data() + offset, ranges.data(), ranges.size() * sizeof(Range));
+  offset += ranges.size() * sizeof(Range);
+  for (const Family& family : families_) {
+    const FamilyHeader family_header = {
+        .manager = family.manager,
+        .name_size = static_cast<uint32_t>(family.name.size()),
+    };
+    memcpy(bytes.data() + offset, &family_header, sizeof(FamilyHeader));
+    offset += sizeof(FamilyHeader);
+    memcpy(bytes.data() + offset, family.name.data(), family.name.size());
+    offset += family.name.size();
+  }
+
+  has_changes_ = false;
+  return std::make_unique<fml::DataMapping>(std::move(bytes));
+}
+
+const FontFallbackIndex::Range* FontFallbackIndex::FindRange(
+    uint32_t ch) const {
+  const Range* end = ranges_ + range_count_;
+  // The first range that ends after |ch|.
+  const Range* range =
+      std::upper_bound(ranges_, end, ch, [](uint32_t value, const Range& r) {
+        return value < r.end;
+      });
+  if (range == end || range->start > ch) {
+    return nullptr;
+  }
+  return range;
+}
+
+uint32_t FontFallbackIndex::GetFamilyIndex(const std::string& name,
+                                           uint32_t manager) {
+  for (size_t i = 0; i < families_.size(); i++) {
+    if (families_[i].name == name && families_[i].manager == manager) {
+      return i;
+    }
+  }
+  families_.push_back({.name = name, .manager = manager});
+  return families_.size() - 1;
+}
+
+}  // namespace txt
@@ -0,0 +1,91 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TXT_FONT_FALLBACK_INDEX_H_
+#define TXT_FONT_FALLBACK_INDEX_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+
+namespace txt {
+
+// Maps ranges of code points to the fallback font family that was matched for
+// them, so that the matches of a previous run can be used instead of asking
+// the font managers again.
+//
+// The ranges are read from a serialized index in place, with a binary search,
+// so loading an index from a memory mapped file does not copy them. Matches
+// added afterwards are kept apart until the index is serialized again, when
+// adjacent code points matched to the same family are merged into ranges.
+//
+// The index is tagged with a fingerprint of the fonts it was built from. An
+// index is only useful while the installed fonts still have that fingerprint.
+class FontFallbackIndex {
+ public:
+  struct Family {
+    std::string name;
+    // Identifies the font manager that provides the family.
+    uint32_t manager;
+  };
+
+  FontFallbackIndex();
+
+  ~FontFallbackIndex();
+
+  // Replaces the contents of the index with those serialized in |mapping|.
+  // Returns false, and leaves the index unchanged, if |mapping| is not a valid
+  // serialized index.
+  bool Load(std::unique_ptr<fml::Mapping> mapping);
+
+  // Removes all of the matches and tags the index with |fingerprint|.
+  void Reset(uint64_t fingerprint);
+
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  // Whether matches were added since the index was loaded or serialized.
+  bool HasChanges() const { return has_changes_; }
+
+  // The family matched for |ch|, or null if there is none.
+  const Family* Find(uint32_t ch) const;
+
+  // Records that |ch| is matched to the family |name| of |manager|. |ch| must
+  // not have a match yet.
+  void Add(uint32_t ch, const std::string& name, uint32_t manager);
+
+  // Serializes all of the matches, in the format read by Load.
+  std::unique_ptr<fml::Mapping> Serialize();
+
+ private:
+  // Code points from |start| up to, but not including, |end|.
+  struct Range {
+    uint32_t start;
+    uint32_t end;
+    uint32_t family;
+  };
+
+  uint64_t fingerprint_ = 0;
+  std::vector<Family> families_;
+  std::unique_ptr<fml::Mapping> mapping_;
+  // The ranges in |mapping_|, sorted by code point.
+  const Range* ranges_ = nullptr;
+  size_t range_count_ = 0;
+  // Matches added since the index was loaded, by code point.
+  std::map<uint32_t, uint32_t> learned_;
+  bool has_changes_ = false;
+
+  const Range* FindRange(uint32_t ch) const;
+
+  uint32_t GetFamilyIndex(const std::string& name, uint32_t manager);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FontFallbackIndex);
+};
+
+}  // namespace txt
+
+#endif  // TXT_FONT_FALLBACK_INDEX_H_
@@ -0,0 +1,93 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "paragraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+namespace {
+
+// Hands out paragraphs to the threads that lay them out. The calling thread
+// lays out paragraphs as well, so that it only ever waits for paragraphs that
+// another thread is already laying out.
+class ConcurrentLayout {
+ public:
+  using LayoutParagraph = std::function<void(size_t index)>;
+
+  ConcurrentLayout(size_t paragraph_count, LayoutParagraph layout_paragraph)
+      : paragraph_count_(paragraph_count),
+        layout_paragraph_(std::move(layout_paragraph)),
+        paragraphs_done_(paragraph_count) {}
+
+  // Lays out paragraphs until none are left to claim.
+  void LayoutRemainingParagraphs() {
+    for (size_t index = next_paragraph_++; index < paragraph_count_;
+         index = next_paragraph_++) {
+      layout_paragraph_(index);
+      paragraphs_done_.CountDown();
+    }
+  }
+
+  // Waits for paragraphs claimed by other threads to be laid out. Only valid
+  // after a call to `LayoutRemainingParagraphs` returned.
+  void Wait() { paragraphs_done_.Wait(); }
+
+ private:
+  const size_t paragraph_count_;
+  const LayoutParagraph layout_paragraph_;
+  std::atomic_size_t next_paragraph_ = 0;
+  fml::CountDownLatch paragraphs_done_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentLayout);
+};
+
+}  // namespace
+
+void Paragraph::LayoutBatch(
+    const std::vector<Paragraph*>& paragraphs,
+    const std::vector<double>& widths,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner) {
+  TRACE_EVENT0("flutter", "Paragraph::LayoutBatch");
+  FML_DCHECK(paragraphs.size() == widths.size());
+
+  std::vector<size_t> concurrent;
+  for (size_t i = 0; i < paragraphs.size(); i++) {
+    if (task_runner && paragraphs[i]->CanLayoutConcurrently()) {
+      concurrent.push_back(i);
+    } else {
+      paragraphs[i]->Layout(widths[i]);
+    }
+  }
+  if (concurrent.empty()) {
+    return;
+  }
+
+  // Tasks that start after every paragraph was claimed only touch the shared
+  // state, never the paragraphs, which may be gone by then.
+  auto layout = std::make_shared<ConcurrentLayout>(
+      concurrent.size(), [&paragraphs, &widths, &concurrent](size_t index) {
+        paragraphs[concurrent[index]]->Layout(widths[concurrent[index]]);
+      });
+  const size_t worker_count =
+      std::min(concurrent.size() - 1, task_runner->GetWorkerCount());
+  for (size_t i = 0; i < worker_count; i++) {
+    task_runner->PostTask([layout]() {
+      TRACE_EVENT0("flutter", "Paragraph::LayoutBatchWorker");
+      layout->LayoutRemainingParagraphs();
+    });
+  }
+  layout->LayoutRemainingParagraphs();
+  layout->Wait();
+}
+
+}  // namespace txt
@@ -18,11 +18,19 @@
 #ifndef LIB_TXT_SRC_PARAGRAPH_H_
 #define LIB_TXT_SRC_PARAGRAPH_H_
 
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
 #include "line_metrics.h"
 #include "paragraph_style.h"
 
 class SkCanvas;
 
+namespace flutter {
+class DisplayListBuilder;
+}  // namespace flutter
+
 namespace txt {
 
 // Interface for text layout engines.  The original implementation was based on
@@ -146,6 +154,17 @@ class Paragraph {
   // the origin. Only valid after Layout() is called.
   virtual void Paint(SkCanvas* canvas, double x, double y) = 0;
 
+  // Whether Paint(flutter::DisplayListBuilder*, ...) is supported. Paragraphs
+  // that do not support it must be painted through an SkCanvas.
+  virtual bool CanPaintToDisplayList() const { return false; }
+
+  // Records the laid out text into the supplied DisplayListBuilder at (x, y)
+  // offset from the origin, as Paint(SkCanvas*, ...) would draw it. Only valid
+  // after Layout() is called, and only if CanPaintToDisplayList() is true.
+  virtual void Paint(flutter::DisplayListBuilder* builder,
+                     double x,
+                     double y) {}
+
   // Returns a vector of bounding boxes that enclose all text between start and
   // end glyph indexes, including start and excluding end.
   virtual std::vector<TextBox> GetRectsForRange(
@@ -175,6 +194,23 @@ class Paragraph {
   virtual Range<size_t> GetWordBoundary(size_t offset) = 0;
 
   virtual std::vector<LineMetrics>& GetLineMetrics() = 0;
+
+  // Whether this paragraph can be laid out on another thread while other
+  // paragraphs are laid out. Paragraphs of engines whose font caches are not
+  // thread-safe are always laid out on the calling thread by LayoutBatch.
+  virtual bool CanLayoutConcurrently() const { return false; }
+
+  // Lays out each of the paragraphs at the width with the same index, as if
+  // Layout() was called on each in turn. The paragraphs must be distinct.
+  // Paragraphs that can be laid out concurrently are spread over the workers
+  // of task_runner, with the calling thread laying out paragraphs too. Returns
+  // once all of the paragraphs are laid out.
+  //
+  // A null task_runner lays out all of the paragraphs on the calling thread.
+  static void LayoutBatch(
+      const std::vector<Paragraph*>& paragraphs,
+      const std::vector<double>& widths,
+      const std::shared_ptr<fml::ConcurrentTaskRunner>& task_runner);
 };
 
 }  // namespace txt
@@ -27,6 +27,7 @@
 #include <utility>
 #include <vector>
 
+#include "flutter/display_list/display_list.h"
 #include "flutter/fml/logging.h"
 #include "font_collection.h"
 #include "font_skia.h"
@@ -187,6 +188,85 @@ void FindWords(const std::vector<uint16_t>& text,
     words->emplace_back(word_start, end);
 }
 
+SkPaint GetTextPaint(const TextStyle& style) {
+  if (style.has_foreground) {
+    return style.foreground;
+  }
+  SkPaint paint;
+  paint.setColor(style.color);
+  return paint;
+}
+
+// Whether PaintDecorations draws anything for the record.
+bool HasDecorations(const PaintRecord& record) {
+  return record.style().decoration != TextDecoration::kNone &&
+         !record.isGhost();
+}
+
+// ParagraphTxt paints into either an SkCanvas or a DisplayListBuilder. These
+// give both the same drawing calls.
+void DrawTextBlob(SkCanvas* canvas,
+                  const sk_sp<SkTextBlob>& blob,
+                  SkScalar x,
+                  SkScalar y,
+                  const SkPaint& paint) {
+  canvas->drawTextBlob(blob, x, y, paint);
+}
+
+void DrawTextBlob(flutter::DisplayListBuilder* builder,
+                  const sk_sp<SkTextBlob>& blob,
+                  SkScalar x,
+                  SkScalar y,
+                  const SkPaint& paint) {
+  builder->setAttributesFromPaint(
+      paint, flutter::DisplayListOpFlags::kDrawTextBlobFlags);
+  builder->drawTextBlob(blob, x, y);
+}
+
+void DrawLine(SkCanvas* canvas,
+              SkScalar x0,
+              SkScalar y0,
+              SkScalar x1,
+              SkScalar y1,
+              const SkPaint& paint) {
+  canvas->drawLine(x0, y0, x1, y1, paint);
+}
+
+void DrawLine(flutter::DisplayListBuilder* builder,
+              SkScalar x0,
+              SkScalar y0,
+              SkScalar x1,
+              SkScalar y1,
+              const SkPaint& paint) {
+  builder->setAttributesFromPaint(paint,
+                                  flutter::DisplayListOpFlags::kDrawLineFlags);
+  builder->drawLine(SkPoint::Make(x0, y0), SkPoint::Make(x1, y1));
+}
+
+void DrawPath(SkCanvas* canvas, const SkPath& path, const SkPaint& paint) {
+  canvas->drawPath(path, paint);
+}
+
+void DrawPath(flutter::DisplayListBuilder* builder,
+              const SkPath& path,
+              const SkPaint& paint) {
+  builder->setAttributesFromPaint(paint,
+                                  flutter::DisplayListOpFlags::kDrawPathFlags);
+  builder->drawPath(path);
+}
+
+void DrawRect(SkCanvas* canvas, const SkRect& rect, const SkPaint& paint) {
+  canvas->drawRect(rect, paint);
+}
+
+void DrawRect(flutter::DisplayListBuilder* builder,
+              const SkRect& rect,
+              const SkPaint& paint) {
+  builder->setAttributesFromPaint(paint,
+                                  flutter::DisplayListOpFlags::kDrawRectFlags);
+  builder->drawRect(rect);
+}
+
 }  // namespace
 
 static const float kDoubleDecorationSpacing = 3.0f;
@@ -250,7 +330,7 @@ void ParagraphTxt::SetInlinePlaceholders(
   obj_replacement_char_indexes_ = std::move(obj_replacement_char_indexes);
 }
 
-bool ParagraphTxt::ComputeLineBreaks() {
+bool ParagraphTxt::ComputeLineBreaks(bool reuse_measured_runs) {
   line_metrics_.clear();
   line_widths_.clear();
   max_intrinsic_width_ = 0;
@@ -269,6 +349,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
   // Calculate and add any breaks due to a line being too long.
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
+  size_t measured_run_index = 0;
   for (size_t newline_index = 0; newline_index < newline_positions.size();
        ++newline_index) {
     size_t block_start =
@@ -342,11 +423,26 @@ bool ParagraphTxt::ComputeLineBreaks() {
         breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
                              isRtl);
         inline_placeholder_index++;
+      } else if (reuse_measured_runs) {
+        // Is a regular text run that was measured by an earlier layout.
+        const MeasuredRun& measured_run = measured_runs_[measured_run_index++];
+        std::copy(measured_run.char_widths.begin(),
+                  measured_run.char_widths.end(),
+                  breaker_.charWidths() + run_start);
+        breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                     run_end, isRtl);
+        block_total_width += measured_run.width;
       } else {
         // Is a regular text run.
         double run_width = breaker_.addStyleRun(&paint, collection, font,
                                                 run_start, run_end, isRtl);
         block_total_width += run_width;
+        const float* char_widths = breaker_.charWidths();
+        measured_runs_.push_back({
+            .char_widths = std::vector<float>(char_widths + run_start,
+                                              char_widths + run_end),
+            .width = static_cast<float>(run_width),
+        });
       }
 
       if (run.end > block_end)
@@ -671,11 +767,22 @@ void ParagraphTxt::Layout(double width) {
     return;
   }
 
+  // If only the width changed, the text runs keep their measured widths and
+  // the bidi runs stay the same, so only the line breaks are computed again.
+  const bool reuse_measured_runs = !needs_layout_ && measured_runs_valid_;
+
   width_ = rounded_width;
 
   needs_layout_ = false;
+  measured_runs_valid_ = false;
+  if (!reuse_measured_runs) {
+    measured_runs_.clear();
+    bidi_runs_.clear();
+  }
 
   records_.clear();
+  paint_batches_.clear();
+  paint_batches_built_ = false;
   glyph_lines_.clear();
   code_unit_runs_.clear();
   inline_placeholder_code_unit_runs_.clear();
@@ -683,13 +790,14 @@ void ParagraphTxt::Layout(double width) {
   min_left_ = std::numeric_limits<double>::max();
   final_line_count_ = 0;
 
-  if (!ComputeLineBreaks())
+  if (!ComputeLineBreaks(reuse_measured_runs))
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
+  if (!reuse_measured_runs && !ComputeBidiRuns(&bidi_runs_))
     return;
 
+  measured_runs_valid_ = true;
+
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
   font.setSubpixel(true);
@@ -739,7 +847,7 @@ void ParagraphTxt::Layout(double width) {
 
     // Find the runs comprising this line.
     std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
+    for (const BidiRun& bidi_run : bidi_runs_) {
       // A "ghost" run is a run that does not impact the layout, breaking,
       // alignment, width, etc but is still "visible" through getRectsForRange.
       // For example, trailing whitespace on centered text can be scrolled
@@ -1408,30 +1516,101 @@ sk_sp<SkTypeface> ParagraphTxt::GetDefaultSkiaTypeface(const TextStyle& style) {
 // The x,y coordinates will be the very top left corner of the rendered
 // paragraph.
 void ParagraphTxt::Paint(SkCanvas* canvas, double x, double y) {
+  PaintImpl(canvas, x, y);
+}
+
+void ParagraphTxt::Paint(flutter::DisplayListBuilder* builder,
+                         double x,
+                         double y) {
+  PaintImpl(builder, x, y);
+}
+
+template <typename Canvas>
+void ParagraphTxt::PaintImpl(Canvas* canvas, double x, double y) {
+  if (!paint_batches_built_) {
+    BuildPaintBatches();
+  }
   SkPoint base_offset = SkPoint::Make(x, y);
-  SkPaint paint;
   // Paint the background first before painting any text to prevent
   // potential overlap.
   for (const PaintRecord& record : records_) {
     PaintBackground(canvas, record, base_offset);
   }
-  for (const PaintRecord& record : records_) {
-    if (record.style().has_foreground) {
-      paint = record.style().foreground;
-    } else {
-      paint.reset();
-      paint.setColor(record.style().color);
+  for (const PaintBatch& batch : paint_batches_) {
+    const PaintRecord& first_record = records_[batch.start];
+    if (batch.text) {
+      SkPoint offset = base_offset + first_record.offset();
+      PaintShadow(canvas, first_record, offset);
+      DrawTextBlob(canvas, batch.text, offset.x(), offset.y(), batch.paint);
     }
-    SkPoint offset = base_offset + record.offset();
-    if (record.GetPlaceholderRun() == nullptr) {
-      PaintShadow(canvas, record, offset);
-      canvas->drawTextBlob(record.text(), offset.x(), offset.y(), paint);
+    // Only the last record of a batch can have decorations, so they are still
+    // drawn over the text of their own record and under that of the next.
+    PaintDecorations(canvas, records_[batch.end - 1], base_offset);
+  }
+}
+
+void ParagraphTxt::BuildPaintBatches() {
+  paint_batches_.clear();
+  size_t start = 0;
+  while (start < records_.size()) {
+    const PaintRecord& first_record = records_[start];
+    PaintBatch batch = {
+        .start = start,
+        .end = start + 1,
+        .paint = GetTextPaint(first_record.style()),
+    };
+    if (first_record.GetPlaceholderRun() != nullptr) {
+      paint_batches_.push_back(std::move(batch));
+      start++;
+      continue;
+    }
+    if (first_record.style().text_shadows.empty() &&
+        !HasDecorations(first_record)) {
+      while (batch.end < records_.size()) {
+        const PaintRecord& record = records_[batch.end];
+        if (record.GetPlaceholderRun() != nullptr ||
+            !record.style().text_shadows.empty() ||
+            GetTextPaint(record.style()) != batch.paint) {
+          break;
+        }
+        batch.end++;
+        if (HasDecorations(record)) {
+          break;
+        }
+      }
+    }
+
+    if (batch.end - batch.start == 1) {
+      batch.text = sk_ref_sp(first_record.text());
+    } else {
+      // Copy the glyph runs of all records into one blob, moving them from the
+      // offsets of their records to the offset of the first record.
+      SkTextBlobBuilder builder;
+      for (size_t i = batch.start; i < batch.end; i++) {
+        const PaintRecord& record = records_[i];
+        const SkPoint shift = record.offset() - first_record.offset();
+        SkTextBlob::Iter iter(*record.text());
+        SkTextBlob::Iter::ExperimentalRun run;
+        while (iter.experimentalNext(&run)) {
+          const SkTextBlobBuilder::RunBuffer& buffer =
+              builder.allocRunPos(run.font, run.count);
+          std::copy(run.glyphs, run.glyphs + run.count, buffer.glyphs);
+          SkPoint* positions = reinterpret_cast<SkPoint*>(buffer.pos);
+          for (int j = 0; j < run.count; j++) {
+            positions[j] = run.positions[j] + shift;
+          }
+        }
+      }
+      batch.text = builder.make();
     }
-    PaintDecorations(canvas, record, base_offset);
+    start = batch.end;
+    paint_batches_.push_back(std::move(batch));
   }
+  paint_batches_built_ = true;
 }
 
-void ParagraphTxt::PaintDecorations(SkCanvas* canvas,
+template <typename Canvas>
+void ParagraphTxt::PaintDecorations(Canvas* canvas,
                                     const PaintRecord& record,
                                     SkPoint base_offset) {
   if (record.style().decoration == TextDecoration::kNone)
@@ -1533,11 +1712,11 @@ void ParagraphTxt::PaintDecorations(SkCanvas* canvas,
               ? metrics.fUnderlinePosition
               : underline_thickness;
       if (record.style().decoration_style != TextDecorationStyle::kWavy) {
-        canvas->drawLine(x, y + y_offset, x + width, y + y_offset, paint);
+        DrawLine(canvas, x, y + y_offset, x + width, y + y_offset, paint);
       } else {
         SkPath offsetPath = path;
         offsetPath.offset(0, y_offset);
-        canvas->drawPath(offsetPath, paint);
+        DrawPath(canvas, offsetPath, paint);
       }
       y_offset = y_offset_original;
     }
@@ -1547,11 +1726,11 @@ void ParagraphTxt::PaintDecorations(SkCanvas* canvas,
       // second line to be above, not below the first.
       y_offset -= metrics.fAscent;
       if (record.style().decoration_style != TextDecorationStyle::kWavy) {
-        canvas->drawLine(x, y - y_offset, x + width, y - y_offset, paint);
+        DrawLine(canvas, x, y - y_offset, x + width, y - y_offset, paint);
       } else {
         SkPath offsetPath = path;
         offsetPath.offset(0, -y_offset);
-        canvas->drawPath(offsetPath, paint);
+        DrawPath(canvas, offsetPath, paint);
       }
       y_offset = y_offset_original;
     }
@@ -1572,11 +1751,11 @@ void ParagraphTxt::PaintDecorations(SkCanvas* canvas,
               // available:
               : metrics.fXHeight / -2.0;
       if (record.style().decoration_style != TextDecorationStyle::kWavy) {
-        canvas->drawLine(x, y + y_offset, x + width, y + y_offset, paint);
+        DrawLine(canvas, x, y + y_offset, x + width, y + y_offset, paint);
       } else {
         SkPath offsetPath = path;
         offsetPath.offset(0, y_offset);
-        canvas->drawPath(offsetPath, paint);
+        DrawPath(canvas, offsetPath, paint);
       }
       y_offset = y_offset_original;
     }
@@ -1625,7 +1804,8 @@ void ParagraphTxt::ComputeWavyDecoration(SkPath& path,
   path.rQuadTo(x1, y1, x2, y2);
 }
 
-void ParagraphTxt::PaintBackground(SkCanvas* canvas,
+template <typename Canvas>
+void ParagraphTxt::PaintBackground(Canvas* canvas,
                                    const PaintRecord& record,
                                    SkPoint base_offset) {
   if (!record.style().has_background)
@@ -1635,10 +1815,11 @@ void ParagraphTxt::PaintBackground(SkCanvas* canvas,
   SkRect rect(SkRect::MakeLTRB(record.x_start(), metrics.fAscent,
                                record.x_end(), metrics.fDescent));
   rect.offset(base_offset + record.offset());
-  canvas->drawRect(rect, record.style().background);
+  DrawRect(canvas, rect, record.style().background);
 }
 
-void ParagraphTxt::PaintShadow(SkCanvas* canvas,
+template <typename Canvas>
+void ParagraphTxt::PaintShadow(Canvas* canvas,
                                const PaintRecord& record,
                                SkPoint offset) {
   if (record.style().text_shadows.size() == 0)
@@ -1654,8 +1835,9 @@ void ParagraphTxt::PaintShadow(SkCanvas* canvas,
       paint.setMaskFilter(SkMaskFilter::MakeBlur(
           kNormal_SkBlurStyle, text_shadow.blur_sigma, false));
     }
-    canvas->drawTextBlob(record.text(), offset.x() + text_shadow.offset.x(),
-                         offset.y() + text_shadow.offset.y(), paint);
+    DrawTextBlob(canvas, sk_ref_sp(record.text()),
+                 offset.x() + text_shadow.offset.x(),
+                 offset.y() + text_shadow.offset.y(), paint);
   }
 }
 
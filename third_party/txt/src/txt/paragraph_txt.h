@@ -34,7 +34,9 @@
 #include "styled_runs.h"
 #include "third_party/googletest/googletest/include/gtest/gtest_prod.h"  // nogncheck
 #include "third_party/skia/include/core/SkFontMetrics.h"
+#include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
 #include "utils/LinuxUtils.h"
 #include "utils/MacUtils.h"
 #include "utils/WindowsUtils.h"
@@ -75,6 +77,12 @@ class ParagraphTxt : public Paragraph {
 
   virtual void Paint(SkCanvas* canvas, double x, double y) override;
 
+  bool CanPaintToDisplayList() const override { return true; }
+
+  void Paint(flutter::DisplayListBuilder* builder,
+             double x,
+             double y) override;
+
   // Getter for paragraph_style_.
   const ParagraphStyle& GetParagraphStyle() const;
 
@@ -121,6 +129,9 @@ class ParagraphTxt : public Paragraph {
   // line in the final layout.
   std::vector<LineMetrics>& GetLineMetrics() override;
 
+  // minikin and the font collection synchronize their caches.
+  bool CanLayoutConcurrently() const override { return true; }
+
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
   // be performed when this is set to true. Can also be used to prevent a new
   // Layout from being calculated by setting to false.
@@ -164,6 +175,8 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, PaintBatchesMergeRecordsWithSamePaint);
+  FRIEND_TEST(ParagraphTest, PaintBatchesEndAtDecoratedRecords);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -193,6 +206,23 @@ class ParagraphTxt : public Paragraph {
   // Stores the result of Layout().
   std::vector<PaintRecord> records_;
 
+  // Consecutive records in records_ whose text is drawn with the same paint,
+  // and so can be drawn together. Records that are placeholders or have
+  // shadows are always in a batch of their own, and a record with decorations
+  // is always the last of its batch.
+  struct PaintBatch {
+    size_t start;
+    size_t end;
+    // The glyphs of all records in the batch, positioned relative to the
+    // offset of the first record. Null for placeholders.
+    sk_sp<SkTextBlob> text;
+    SkPaint paint;
+  };
+
+  // Built by the first Paint() after a layout.
+  std::vector<PaintBatch> paint_batches_;
+  bool paint_batches_built_ = false;
+
   bool did_exceed_max_lines_;
 
   // Strut metrics of zero will have no effect on the layout.
@@ -320,6 +350,21 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  // The widths of the characters of a regular text run, as measured by the
+  // line breaker, and the width of the whole run.
+  struct MeasuredRun {
+    std::vector<float> char_widths;
+    float width;
+  };
+
+  // The parts of the layout that do not depend on the width. They are kept
+  // after a layout so that a layout that only changes the width does not
+  // shape the text or resolve its bidi runs again. Any change to the text,
+  // styles or placeholders sets needs_layout_, which discards them.
+  std::vector<MeasuredRun> measured_runs_;
+  std::vector<BidiRun> bidi_runs_;
+  bool measured_runs_valid_ = false;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
@@ -342,8 +387,9 @@ class ParagraphTxt : public Paragraph {
       std::vector<PlaceholderRun> inline_placeholders,
       std::unordered_set<size_t> obj_replacement_char_indexes);
 
-  // Break the text into lines.
-  bool ComputeLineBreaks();
+  // Break the text into lines. If reuse_measured_runs is true, the widths of
+  // the text runs are taken from measured_runs_ instead of being measured.
+  bool ComputeLineBreaks(bool reuse_measured_runs);
 
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
@@ -373,8 +419,16 @@ class ParagraphTxt : public Paragraph {
   // alignment.
   double GetLineXOffset(double line_total_advance, bool justify_line);
 
+  // Paints into an SkCanvas or a DisplayListBuilder.
+  template <typename Canvas>
+  void PaintImpl(Canvas* canvas, double x, double y);
+
+  // Groups the records into paint_batches_.
+  void BuildPaintBatches();
+
   // Creates and draws the decorations onto the canvas.
-  void PaintDecorations(SkCanvas* canvas,
+  template <typename Canvas>
+  void PaintDecorations(Canvas* canvas,
                         const PaintRecord& record,
                         SkPoint base_offset);
 
@@ -387,12 +441,14 @@ class ParagraphTxt : public Paragraph {
                              double thickness);
 
   // Draws the background onto the canvas.
-  void PaintBackground(SkCanvas* canvas,
+  template <typename Canvas>
+  void PaintBackground(Canvas* canvas,
                        const PaintRecord& record,
                        SkPoint base_offset);
 
   // Draws the shadows onto the canvas.
-  void PaintShadow(SkCanvas* canvas, const PaintRecord& record, SkPoint offset);
+  template <typename Canvas>
+  void PaintShadow(Canvas* canvas, const PaintRecord& record, SkPoint offset);
 
   // Obtain a Minikin font collection matching this text style.
   std::shared_ptr<minikin::FontCollection> GetMinikinFontCollectionForStyle(
@@ -0,0 +1,96 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <minikin/LineBreaker.h>
+
+#include <cstring>
+#include <vector>
+
+namespace minikin {
+
+namespace {
+
+struct BreakResult {
+  std::vector<int> breaks;
+  std::vector<float> widths;
+  std::vector<int> flags;
+};
+
+// Words of 1 to 9 letters separated by single spaces, with made up widths for
+// each character.
+std::vector<uint16_t> MakeText(size_t word_count) {
+  std::vector<uint16_t> text;
+  for (size_t i = 0; i < word_count; i++) {
+    if (i > 0) {
+      text.push_back(' ');
+    }
+    const size_t length = 1 + (i * 7) % 9;
+    for (size_t j = 0; j < length; j++) {
+      text.push_back('a' + (i + j) % 26);
+    }
+  }
+  return text;
+}
+
+// Breaks the text into lines of |width|. If |indented| is true, the lines get
+// an indent of zero, which leaves their width unchanged but makes the line
+// breaker treat them as lines of varying widths.
+BreakResult BreakText(const std::vector<uint16_t>& text,
+                      float width,
+                      BreakStrategy strategy,
+                      bool justified,
+                      bool indented) {
+  LineBreaker breaker;
+  breaker.setLocale();
+  breaker.resize(text.size());
+  memcpy(breaker.buffer(), text.data(), text.size() * sizeof(text[0]));
+  breaker.setText();
+  breaker.setLineWidths(width, 0, width);
+  if (indented) {
+    breaker.setIndents({0.0f});
+  }
+  breaker.setStrategy(strategy);
+  breaker.setJustified(justified);
+
+  float* char_widths = breaker.charWidths();
+  for (size_t i = 0; i < text.size(); i++) {
+    char_widths[i] = text[i] == ' ' ? 4.0f : 5.0f + text[i] % 7;
+  }
+  // A null paint makes the breaker use the widths set above.
+  breaker.addStyleRun(nullptr, nullptr, FontStyle(), 0, text.size(), false);
+
+  BreakResult result;
+  const size_t count = breaker.computeBreaks();
+  result.breaks.assign(breaker.getBreaks(), breaker.getBreaks() + count);
+  result.widths.assign(breaker.getWidths(), breaker.getWidths() + count);
+  result.flags.assign(breaker.getFlags(), breaker.getFlags() + count);
+  breaker.finish();
+  return result;
+}
+
+}  // namespace
+
+// Lines of a single width take a faster path through the optimal line
+// breaker, which must find the same breaks as the general one.
+TEST(LineBreakerTest, OptimalBreaksMatchForConstantWidths) {
+  const std::vector<uint16_t> text = MakeText(300);
+  for (BreakStrategy strategy :
+       {kBreakStrategy_HighQuality, kBreakStrategy_Balanced}) {
+    for (bool justified : {false, true}) {
+      for (float width : {30.0f, 75.0f, 150.0f, 333.0f, 1000.0f}) {
+        const BreakResult expected =
+            BreakText(text, width, strategy, justified, true);
+        const BreakResult actual =
+            BreakText(text, width, strategy, justified, false);
+        EXPECT_GT(actual.breaks.size(), 0u);
+        EXPECT_EQ(actual.breaks, expected.breaks);
+        EXPECT_EQ(actual.widths, expected.widths);
+        EXPECT_EQ(actual.flags, expected.flags);
+      }
+    }
+  }
+}
+
+}  // namespace minikin
@@ -138,6 +138,110 @@ TEST(FontCollectionTest, CheckSkTypefacesSorting) {
             SkFontStyle::kExpanded_Width);
 }
 
+TEST(FontCollection, LayoutCacheIsBoundedByBytes) {
+  auto font_collection = GetTestFontCollection();
+  auto minikin_collection =
+      font_collection->GetMinikinFontCollectionForFamilies(
+          std::vector<std::string>(1, "Roboto"), "en-US");
+  ASSERT_NE(minikin_collection, nullptr);
+
+  const std::u16string text = u"shape these words once";
+  auto layout_text = [&text, &minikin_collection]() {
+    minikin::MinikinPaint paint;
+    paint.size = 14;
+    minikin::Layout layout;
+    layout.doLayout(reinterpret_cast<const uint16_t*>(text.data()), 0,
+                    text.size(), text.size(), false, minikin::FontStyle(),
+                    paint, minikin_collection);
+  };
+
+  minikin::Layout::purgeCaches();
+  const minikin::LayoutCacheStats initial =
+      FontCollection::GetLayoutCacheStats();
+  FontCollection::SetLayoutCacheCapacity(1024 * 1024);
+
+  layout_text();
+  const minikin::LayoutCacheStats first = FontCollection::GetLayoutCacheStats();
+  ASSERT_GT(first.missCount, initial.missCount);
+  ASSERT_GT(first.entryCount, 1u);
+  ASSERT_GT(first.sizeBytes, 0u);
+  ASSERT_EQ(first.capacityBytes, 1024u * 1024u);
+
+  layout_text();
+  const minikin::LayoutCacheStats second =
+      FontCollection::GetLayoutCacheStats();
+  ASSERT_EQ(second.missCount, first.missCount);
+  ASSERT_GT(second.hitCount, first.hitCount);
+  ASSERT_EQ(second.sizeBytes, first.sizeBytes);
+
+  // Shrinking the cache evicts the least recently used words.
+  FontCollection::SetLayoutCacheCapacity(first.sizeBytes / 2);
+  const minikin::LayoutCacheStats shrunk =
+      FontCollection::GetLayoutCacheStats();
+  ASSERT_GT(shrunk.evictionCount, second.evictionCount);
+  ASSERT_LT(shrunk.entryCount, second.entryCount);
+  ASSERT_LE(shrunk.sizeBytes, first.sizeBytes / 2);
+
+  FontCollection::SetLayoutCacheCapacity(0);
+  layout_text();
+  const minikin::LayoutCacheStats disabled =
+      FontCollection::GetLayoutCacheStats();
+  ASSERT_EQ(disabled.entryCount, 0u);
+  ASSERT_EQ(disabled.sizeBytes, 0u);
+
+  FontCollection::SetLayoutCacheCapacity(initial.capacityBytes);
+}
+
+TEST(FontCollection, LayoutCacheSkipsEntriesLargerThanItsCapacity) {
+  auto font_collection = GetTestFontCollection();
+  auto minikin_collection =
+      font_collection->GetMinikinFontCollectionForFamilies(
+          std::vector<std::string>(1, "Roboto"), "en-US");
+  ASSERT_NE(minikin_collection, nullptr);
+
+  auto layout_text = [&minikin_collection](const std::u16string& text) {
+    minikin::MinikinPaint paint;
+    paint.size = 14;
+    minikin::Layout layout;
+    layout.doLayout(reinterpret_cast<const uint16_t*>(text.data()), 0,
+                    text.size(), text.size(), false, minikin::FontStyle(),
+                    paint, minikin_collection);
+  };
+  const std::u16string short_text = u"short words";
+  // Each word of a paragraph is charged for the text of the whole paragraph.
+  std::u16string long_text;
+  for (int i = 0; i < 1000; i++) {
+    long_text += u"long ";
+  }
+
+  minikin::Layout::purgeCaches();
+  const minikin::LayoutCacheStats initial =
+      FontCollection::GetLayoutCacheStats();
+  FontCollection::SetLayoutCacheCapacity(1024 * 1024);
+  layout_text(short_text);
+  const minikin::LayoutCacheStats first = FontCollection::GetLayoutCacheStats();
+  ASSERT_GT(first.entryCount, 0u);
+
+  const size_t capacity = first.sizeBytes + 1024;
+  ASSERT_LT(capacity, long_text.size() * sizeof(char16_t));
+  FontCollection::SetLayoutCacheCapacity(capacity);
+  layout_text(long_text);
+  const minikin::LayoutCacheStats second =
+      FontCollection::GetLayoutCacheStats();
+  ASSERT_GT(second.missCount, first.missCount);
+  ASSERT_EQ(second.entryCount, first.entryCount);
+  ASSERT_EQ(second.evictionCount, first.evictionCount);
+  ASSERT_EQ(second.sizeBytes, first.sizeBytes);
+
+  // The words that were cached before are still there.
+  layout_text(short_text);
+  const minikin::LayoutCacheStats third = FontCollection::GetLayoutCacheStats();
+  ASSERT_EQ(third.missCount, second.missCount);
+  ASSERT_GT(third.hitCount, second.hitCount);
+
+  FontCollection::SetLayoutCacheCapacity(initial.capacityBytes);
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
@@ -0,0 +1,111 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "txt/font_fallback_index.h"
+
+namespace txt {
+
+namespace {
+
+void ExpectFamily(const FontFallbackIndex& index,
+                  uint32_t ch,
+                  const std::string& name,
+                  uint32_t manager) {
+  const FontFallbackIndex::Family* family = index.Find(ch);
+  ASSERT_NE(family, nullptr) << ch;
+  EXPECT_EQ(family->name, name) << ch;
+  EXPECT_EQ(family->manager, manager) << ch;
+}
+
+std::unique_ptr<fml::Mapping> Copy(const fml::Mapping& mapping) {
+  return std::make_unique<fml::DataMapping>(std::vector<uint8_t>(
+      mapping.GetMapping(), mapping.GetMapping() + mapping.GetSize()));
+}
+
+}  // namespace
+
+TEST(FontFallbackIndexTest, RoundTripsMatches) {
+  FontFallbackIndex index;
+  index.Reset(42);
+  EXPECT_FALSE(index.HasChanges());
+  EXPECT_EQ(index.Find(0x4E00), nullptr);
+
+  for (uint32_t ch = 0x4E00; ch < 0x4E10; ch++) {
+    index.Add(ch, "Noto Sans CJK JP", 2);
+  }
+  index.Add(0x1F600, "Noto Color Emoji", 2);
+  index.Add(0x0E01, "Noto Sans Thai", 1);
+  EXPECT_TRUE(index.HasChanges());
+  ExpectFamily(index, 0x4E05, "Noto Sans CJK JP", 2);
+
+  std::unique_ptr<fml::Mapping> serialized = index.Serialize();
+  ASSERT_NE(serialized, nullptr);
+  EXPECT_FALSE(index.HasChanges());
+
+  FontFallbackIndex loaded;
+  ASSERT_TRUE(loaded.Load(Copy(*serialized)));
+  EXPECT_EQ(loaded.fingerprint(), 42u);
+  EXPECT_FALSE(loaded.HasChanges());
+  ExpectFamily(loaded, 0x4E00, "Noto Sans CJK JP", 2);
+  ExpectFamily(loaded, 0x4E0F, "Noto Sans CJK JP", 2);
+  ExpectFamily(loaded, 0x1F600, "Noto Color Emoji", 2);
+  ExpectFamily(loaded, 0x0E01, "Noto Sans Thai", 1);
+  EXPECT_EQ(loaded.Find(0x4DFF), nullptr);
+  EXPECT_EQ(loaded.Find(0x4E10), nullptr);
+  EXPECT_EQ(loaded.Find(0x1F601), nullptr);
+
+  // Matches added to a loaded index are merged with its ranges.
+  loaded.Add(0x4E10, "Noto Sans CJK JP", 2);
+  loaded.Add(0x0E00, "Noto Sans Thai", 1);
+  loaded.Add(0x20, "Roboto", 0);
+  std::unique_ptr<fml::Mapping> reserialized = loaded.Serialize();
+
+  FontFallbackIndex reloaded;
+  ASSERT_TRUE(reloaded.Load(Copy(*reserialized)));
+  ExpectFamily(reloaded, 0x20, "Roboto", 0);
+  ExpectFamily(reloaded, 0x0E00, "Noto Sans Thai", 1);
+  ExpectFamily(reloaded, 0x0E01, "Noto Sans Thai", 1);
+  ExpectFamily(reloaded, 0x4E00, "Noto Sans CJK JP", 2);
+  ExpectFamily(reloaded, 0x4E10, "Noto Sans CJK JP", 2);
+  ExpectFamily(reloaded, 0x1F600, "Noto Color Emoji", 2);
+  EXPECT_EQ(reloaded.Find(0x21), nullptr);
+
+  // Adjacent code points of the same family are kept as a single range, so
+  // the index only grows by the new range.
+  EXPECT_EQ(reserialized->GetSize() - serialized->GetSize(),
+            3 * sizeof(uint32_t) + 2 * sizeof(uint32_t) + strlen("Roboto"));
+}
+
+TEST(FontFallbackIndexTest, RejectsInvalidData) {
+  FontFallbackIndex index;
+  index.Reset(7);
+  index.Add(0x4E00, "Noto Sans CJK JP", 2);
+  std::unique_ptr<fml::Mapping> serialized = index.Serialize();
+
+  FontFallbackIndex loaded;
+  EXPECT_FALSE(loaded.Load(nullptr));
+  EXPECT_FALSE(loaded.Load(
+      std::make_unique<fml::DataMapping>(std::string("not an index"))));
+
+  // A file that was cut short is ignored.
+  std::vector<uint8_t> truncated(
+      serialized->GetMapping(),
+      serialized->GetMapping() + serialized->GetSize() - 1);
+  EXPECT_FALSE(loaded.Load(
+      std::make_unique<fml::DataMapping>(std::move(truncated))));
+  EXPECT_EQ(loaded.Find(0x4E00), nullptr);
+
+  ASSERT_TRUE(loaded.Load(Copy(*serialized)));
+  ExpectFamily(loaded, 0x4E00, "Noto Sans CJK JP", 2);
+
+  // Resetting the index drops the loaded matches.
+  loaded.Reset(8);
+  EXPECT_EQ(loaded.fingerprint(), 8u);
+  EXPECT_EQ(loaded.Find(0x4E00), nullptr);
+}
+
+}  // namespace txt
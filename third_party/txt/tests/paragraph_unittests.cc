@@ -17,6 +17,9 @@
 #include <cstring>
 #include <iostream>
 
+#include "flutter/display_list/display_list.h"
+#include "flutter/display_list/display_list_canvas.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
@@ -7111,4 +7114,287 @@ TEST_F(ParagraphTest, MixedTextHeightBehaviorRectsParagraph) {
 
   ASSERT_TRUE(Snapshot());
 }
+
+TEST_F(ParagraphTest, LayoutBatchMatchesSequentialLayout) {
+  const std::vector<const char*> texts = {
+      "Hello World Text Dialog, long enough to wrap onto a few lines.",
+      "مرحبا بالعالم، هذا نص عربي طويل بما يكفي ليلتف على عدة أسطر",
+      "日本語のテキストも同じように複数の行に折り返されます。",
+      "Mixed English, العربية and 日本語 in one paragraph.",
+  };
+  auto build_paragraph = [](const char* text) {
+    auto icu_text = icu::UnicodeString::fromUTF8(text);
+    std::u16string u16_text(icu_text.getBuffer(),
+                            icu_text.getBuffer() + icu_text.length());
+
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+    txt::TextStyle text_style;
+    text_style.font_families = {"Roboto", "Noto Naskh Arabic",
+                                "Noto Sans CJK JP"};
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  std::vector<std::unique_ptr<ParagraphTxt>> sequential;
+  std::vector<std::unique_ptr<ParagraphTxt>> batched;
+  std::vector<Paragraph*> batch;
+  std::vector<double> widths;
+  for (size_t i = 0; i < 40; i++) {
+    const char* text = texts[i % texts.size()];
+    const double width = 100 + 37 * (i % 7);
+    sequential.push_back(build_paragraph(text));
+    sequential.back()->Layout(width);
+    batched.push_back(build_paragraph(text));
+    batch.push_back(batched.back().get());
+    widths.push_back(width);
+  }
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  Paragraph::LayoutBatch(batch, widths, loop->GetTaskRunner());
+  loop->Terminate();
+
+  for (size_t i = 0; i < sequential.size(); i++) {
+    ParagraphTxt& expected = *sequential[i];
+    ParagraphTxt& actual = *batched[i];
+    ASSERT_EQ(actual.GetMaxWidth(), expected.GetMaxWidth());
+    ASSERT_EQ(actual.GetHeight(), expected.GetHeight());
+    ASSERT_EQ(actual.GetLongestLine(), expected.GetLongestLine());
+    ASSERT_EQ(actual.GetMinIntrinsicWidth(), expected.GetMinIntrinsicWidth());
+    ASSERT_EQ(actual.GetMaxIntrinsicWidth(), expected.GetMaxIntrinsicWidth());
+    ASSERT_EQ(actual.GetLineCount(), expected.GetLineCount());
+
+    const auto expected_boxes = expected.GetRectsForRange(
+        0, 100, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    const auto actual_boxes = actual.GetRectsForRange(
+        0, 100, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(actual_boxes.size(), expected_boxes.size());
+    for (size_t j = 0; j < expected_boxes.size(); j++) {
+      ASSERT_EQ(actual_boxes[j].rect, expected_boxes[j].rect);
+      ASSERT_EQ(actual_boxes[j].direction, expected_boxes[j].direction);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, LayoutAtNewWidthMatchesFreshLayout) {
+  auto build_paragraph = []() {
+    const char* text =
+        "Hello World Text Dialog, long enough to wrap onto a few lines.\n"
+        "مرحبا بالعالم، هذا نص عربي طويل بما يكفي ليلتف على عدة أسطر";
+    auto icu_text = icu::UnicodeString::fromUTF8(text);
+    std::u16string u16_text(icu_text.getBuffer(),
+                            icu_text.getBuffer() + icu_text.length());
+
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+    txt::TextStyle text_style;
+    text_style.font_families = {"Roboto", "Noto Naskh Arabic"};
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(0, 20));
+    text_style.font_size = 20;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(20));
+    builder.Pop();
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  // Lays out the same paragraph at each width in turn, without marking it
+  // dirty, and compares it to a paragraph that is only laid out at that width.
+  auto resized = build_paragraph();
+  for (double width : {300.0, 120.0, 500.0, 80.0, 300.0}) {
+    resized->Layout(width);
+    auto expected = build_paragraph();
+    expected->Layout(width);
+
+    ASSERT_EQ(resized->GetHeight(), expected->GetHeight());
+    ASSERT_EQ(resized->GetLongestLine(), expected->GetLongestLine());
+    ASSERT_EQ(resized->GetMinIntrinsicWidth(),
+              expected->GetMinIntrinsicWidth());
+    ASSERT_EQ(resized->GetMaxIntrinsicWidth(),
+              expected->GetMaxIntrinsicWidth());
+    ASSERT_EQ(resized->GetLineCount(), expected->GetLineCount());
+
+    const auto expected_boxes = expected->GetRectsForRange(
+        0, 200, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    const auto resized_boxes = resized->GetRectsForRange(
+        0, 200, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(resized_boxes.size(), expected_boxes.size());
+    for (size_t i = 0; i < expected_boxes.size(); i++) {
+      ASSERT_EQ(resized_boxes[i].rect, expected_boxes[i].rect);
+      ASSERT_EQ(resized_boxes[i].direction, expected_boxes[i].direction);
+    }
+  }
+
+  // Marking the paragraph dirty measures the text again.
+  resized->SetDirty();
+  resized->Layout(300);
+  ASSERT_EQ(resized->GetMaxIntrinsicWidth(),
+            build_paragraph()->GetMaxIntrinsicWidth());
+}
+
+TEST_F(ParagraphTest, PaintBatchesMergeRecordsWithSamePaint) {
+  const char* text = "Syntax highlighted code has many small runs";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  // The first three runs only differ in their weight, so they are drawn with
+  // the same paint. The fourth has another color.
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(0, 7));
+  text_style.font_weight = txt::FontWeight::w700;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(7, 12));
+  text_style.font_weight = txt::FontWeight::w400;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(19, 5));
+  text_style.color = SK_ColorRED;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(24));
+
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(GetTestCanvasWidth());
+  paragraph->Paint(GetCanvas(), 0, 0);
+
+  ASSERT_EQ(paragraph->records_.size(), 4ull);
+  ASSERT_EQ(paragraph->paint_batches_.size(), 2ull);
+  EXPECT_EQ(paragraph->paint_batches_[0].start, 0ull);
+  EXPECT_EQ(paragraph->paint_batches_[0].end, 3ull);
+  EXPECT_EQ(paragraph->paint_batches_[0].paint.getColor(), SK_ColorBLACK);
+  EXPECT_EQ(paragraph->paint_batches_[1].start, 3ull);
+  EXPECT_EQ(paragraph->paint_batches_[1].end, 4ull);
+  EXPECT_EQ(paragraph->paint_batches_[1].paint.getColor(), SK_ColorRED);
+
+  // The merged blob covers the glyphs of all three records.
+  const SkRect bounds = paragraph->paint_batches_[0].text->bounds();
+  EXPECT_LE(bounds.left(), paragraph->records_[0].text()->bounds().left());
+  EXPECT_GE(bounds.right() + paragraph->records_[0].offset().x(),
+            paragraph->records_[2].text()->bounds().right() +
+                paragraph->records_[2].offset().x());
+
+  // A new layout builds the batches again.
+  paragraph->SetDirty();
+  paragraph->Layout(GetTestCanvasWidth());
+  EXPECT_TRUE(paragraph->paint_batches_.empty());
+  paragraph->Paint(GetCanvas(), 0, 0);
+  EXPECT_EQ(paragraph->paint_batches_.size(), 2ull);
+
+  ASSERT_TRUE(Snapshot());
+}
+
+TEST_F(ParagraphTest, PaintBatchesEndAtDecoratedRecords) {
+  const char* text = "Adjacent underlined runs keep their own lines";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 30;
+  text_style.color = SK_ColorBLACK;
+
+  // The runs are all drawn with the same paint. The second and third are
+  // underlined next to each other, the third with a wavy line.
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(0, 9));
+  text_style.decoration = TextDecoration::kUnderline;
+  text_style.decoration_color = SK_ColorRED;
+  text_style.font_weight = txt::FontWeight::w700;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(9, 11));
+  text_style.decoration_style = txt::TextDecorationStyle::kWavy;
+  text_style.font_weight = txt::FontWeight::w400;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(20, 5));
+  text_style.decoration = TextDecoration::kNone;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(25));
+
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(GetTestCanvasWidth());
+  paragraph->Paint(GetCanvas(), 0, 0);
+
+  // Each underlined record ends its batch, so its line is drawn right after
+  // its own text.
+  ASSERT_EQ(paragraph->records_.size(), 4ull);
+  ASSERT_EQ(paragraph->paint_batches_.size(), 3ull);
+  EXPECT_EQ(paragraph->paint_batches_[0].start, 0ull);
+  EXPECT_EQ(paragraph->paint_batches_[0].end, 2ull);
+  EXPECT_EQ(paragraph->paint_batches_[1].start, 2ull);
+  EXPECT_EQ(paragraph->paint_batches_[1].end, 3ull);
+  EXPECT_EQ(paragraph->paint_batches_[2].start, 3ull);
+  EXPECT_EQ(paragraph->paint_batches_[2].end, 4ull);
+
+  ASSERT_TRUE(Snapshot());
+}
+
+TEST_F(ParagraphTest, PaintToDisplayListMatchesPaintToCanvas) {
+  const char* text = "Underlined text with a shadow, a background and colors";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+  text_style.decoration = TextDecoration::kUnderline;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(0, 17));
+  text_style.text_shadows.emplace_back(SK_ColorBLACK, SkPoint::Make(2.0, 2.0),
+                                       1.0);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(17, 14));
+  text_style.text_shadows.clear();
+  text_style.has_background = true;
+  text_style.background.setColor(SK_ColorYELLOW);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(31, 13));
+  text_style.has_background = false;
+  text_style.color = SK_ColorRED;
+  text_style.decoration = TextDecoration::kLineThrough;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text.substr(44));
+
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(200);
+  ASSERT_TRUE(paragraph->CanPaintToDisplayList());
+
+  const SkRect bounds = SkRect::MakeWH(200, 200);
+  flutter::DisplayListCanvasRecorder recorder(bounds);
+  paragraph->Paint(&recorder, 10, 20);
+  sk_sp<flutter::DisplayList> expected = recorder.Build();
+
+  flutter::DisplayListBuilder display_list_builder(bounds);
+  paragraph->Paint(&display_list_builder, 10, 20);
+  sk_sp<flutter::DisplayList> actual = display_list_builder.Build();
+
+  EXPECT_GT(actual->op_count(), 0);
+  EXPECT_EQ(actual->op_count(), expected->op_count());
+  EXPECT_TRUE(actual->Equals(*expected));
+}
+
 }  // namespace txt